@@ -0,0 +1,178 @@
+/**
+ * @file batch.c
+ * @brief Batch fill mode implementation
+ *
+ * batch_update() is the only writer of the phase once a job runs; the web
+ * handlers start a job or request a stop under s_lock. System state changes
+ * (state_set_system) are made outside the lock.
+ */
+
+#include "batch.h"
+#include "config.h"
+#include "system_state.h"
+#include "state_transition.h"
+#include "blog.h"
+#include "freertos/FreeRTOS.h"
+#include <math.h>
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static struct {
+    batch_status_t st;
+    bool stop_requested;
+    uint32_t fill_number_at_start;  // Detects that the current drum was filled
+    int64_t fill_end_us;            // End of the previous drum (changeover time)
+    float ref_weight;               // Stability tracking
+    int64_t stable_since_us;
+} s_batch = {0};
+
+/* =============================================================================
+ * HELPERS
+ * ===========================================================================*/
+
+/**
+ * @brief Track whether the reading has been steady for BATCH_STABLE_MS
+ */
+static bool weight_steady(float weight, int64_t now_us)
+{
+    if (!g_system_state.scale_online || fabsf(weight - s_batch.ref_weight) > BATCH_STABLE_BAND_LBS) {
+        s_batch.ref_weight = weight;
+        s_batch.stable_since_us = now_us;
+        return false;
+    }
+    return now_us - s_batch.stable_since_us >= (int64_t)BATCH_STABLE_MS * 1000;
+}
+
+static void finish_job(bool aborted)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_batch.st.phase = BATCH_OFF;
+    s_batch.st.aborted = aborted;
+    s_batch.stop_requested = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    // Single fills weigh against an empty (zeroed) scale again
+    g_system_state.start_weight_lbs = 0.0f;
+    BLOG3(BLOG_BATCH_END, s_batch.st.done, s_batch.st.drums, aborted ? " (aborted)" : "");
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t batch_start(uint16_t drums, float target_lbs)
+{
+    if (drums == 0 || drums > BATCH_MAX_DRUMS || target_lbs <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_lock);
+    if (s_batch.st.phase != BATCH_OFF || g_system_state.state != STATE_IDLE) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        s_batch.st = (batch_status_t){
+            .phase = BATCH_WAIT_DRUM,
+            .drums = drums,
+            .target_lbs = target_lbs,
+        };
+        s_batch.stop_requested = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
+
+void batch_stop(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    if (s_batch.st.phase != BATCH_OFF) {
+        s_batch.stop_requested = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void batch_update(int64_t now_us)
+{
+    float weight = g_system_state.current_weight_lbs;
+    bool steady = weight_steady(weight, now_us);
+    system_state_enum_t state = g_system_state.state;
+
+    switch (s_batch.st.phase) {
+        case BATCH_OFF:
+            break;
+
+        case BATCH_WAIT_REMOVAL:
+            if (s_batch.stop_requested) {
+                finish_job(false);
+            } else if (state == STATE_IDLE && steady && weight < BATCH_DRUM_PRESENT_LBS) {
+                s_batch.st.phase = BATCH_WAIT_DRUM;
+                BLOG2(BLOG_BATCH_DRUM_REMOVED, s_batch.st.done + 1, s_batch.st.drums);
+            }
+            break;
+
+        case BATCH_WAIT_DRUM:
+            if (s_batch.stop_requested) {
+                finish_job(false);
+            } else if (state == STATE_IDLE && steady &&
+                       weight >= BATCH_DRUM_PRESENT_LBS && weight < BATCH_DRUM_MAX_TARE_LBS) {
+                // Empty drum in place: auto-tare and start at once
+                s_batch.st.tare_lbs = weight;
+                s_batch.st.last_changeover_ms = (s_batch.st.done > 0) ?
+                    (uint32_t)((now_us - s_batch.fill_end_us) / 1000) : 0;
+                s_batch.fill_number_at_start = g_system_state.fill_number;
+                g_system_state.start_weight_lbs = weight;
+                g_system_state.target_weight_lbs = s_batch.st.target_lbs;
+                s_batch.st.phase = BATCH_RUNNING;
+                BLOG3(BLOG_BATCH_DRUM_PLACED, s_batch.st.done + 1, s_batch.st.drums, weight);
+                state_set_system(STATE_SAFETY_CHECK);
+            }
+            break;
+
+        case BATCH_RUNNING:
+            if (state == STATE_CANCELLED || state == STATE_ERROR) {
+                finish_job(true);
+            } else if (state == STATE_IDLE) {
+                if (g_system_state.fill_number == s_batch.fill_number_at_start) {
+                    finish_job(true);   // Back to idle without a completed fill
+                    break;
+                }
+                s_batch.st.done++;
+                s_batch.fill_end_us = now_us;
+                if (s_batch.st.done >= s_batch.st.drums || s_batch.stop_requested) {
+                    finish_job(false);
+                } else {
+                    s_batch.st.phase = BATCH_WAIT_REMOVAL;
+                }
+            }
+            break;
+    }
+}
+
+bool batch_active(void)
+{
+    return s_batch.st.phase != BATCH_OFF;
+}
+
+bool batch_repeat_drum(void)
+{
+    // The first drum of a job gets the full sequence
+    return s_batch.st.phase == BATCH_RUNNING && s_batch.st.done > 0;
+}
+
+void batch_get_status(batch_status_t *status)
+{
+    portENTER_CRITICAL(&s_lock);
+    *status = s_batch.st;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+const char *batch_phase_to_string(batch_phase_t phase)
+{
+    switch (phase) {
+        case BATCH_OFF: return "OFF";
+        case BATCH_WAIT_DRUM: return "WAIT_DRUM";
+        case BATCH_RUNNING: return "RUNNING";
+        case BATCH_WAIT_REMOVAL: return "WAIT_REMOVAL";
+        default: return "UNKNOWN";
+    }
+}
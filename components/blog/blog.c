@@ -0,0 +1,223 @@
+/**
+ * @file blog.c
+ * @brief Binary deferred logger implementation
+ *
+ * Multi-producer / single-consumer ring. Producers reserve a slot by CAS on
+ * the head index, fill it, then publish it by writing the slot sequence
+ * number (head + 1). The drain task consumes slots in order, waiting on any
+ * slot whose sequence has not been published yet.
+ */
+
+#include "blog.h"
+#include "config.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "BLOG";
+
+#define BLOG_RING_MASK (BLOG_RING_SIZE - 1)
+_Static_assert((BLOG_RING_SIZE & BLOG_RING_MASK) == 0, "BLOG_RING_SIZE must be a power of 2");
+
+typedef struct {
+    int64_t timestamp_us;
+    uint16_t id;
+    uint8_t nargs;
+    uint32_t args[BLOG_MAX_ARGS];
+    atomic_uint_fast32_t seq;       // head index + 1 once the record is complete
+} blog_record_t;
+
+typedef struct {
+    esp_log_level_t level;
+    const char *tag;
+    const char *fmt;
+} blog_format_t;
+
+static const blog_format_t s_formats[BLOG_FORMAT_COUNT] = {
+#define BLOG_X_TABLE(id, lvl, tg, f) [id] = {.level = lvl, .tag = tg, .fmt = f},
+    BLOG_FORMATS(BLOG_X_TABLE)
+#undef BLOG_X_TABLE
+};
+
+static blog_record_t s_ring[BLOG_RING_SIZE];
+static atomic_uint_fast32_t s_head = 0;
+static atomic_uint_fast32_t s_tail = 0;
+static atomic_uint_fast32_t s_dropped = 0;
+
+static StaticTask_t s_task_tcb;
+static StackType_t s_task_stack[BLOG_TASK_STACK_SIZE];
+
+/* =============================================================================
+ * PRODUCER (hot path)
+ * ===========================================================================*/
+
+void IRAM_ATTR blog_write(blog_id_t id, uint32_t nargs, const uint32_t *args)
+{
+    uint_fast32_t head = atomic_load_explicit(&s_head, memory_order_relaxed);
+
+    // Reserve a slot, or drop if the consumer is a full ring behind
+    do {
+        uint_fast32_t tail = atomic_load_explicit(&s_tail, memory_order_acquire);
+        if ((uint32_t)(head - tail) >= BLOG_RING_SIZE) {
+            atomic_fetch_add_explicit(&s_dropped, 1, memory_order_relaxed);
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&s_head, &head, head + 1,
+                                                    memory_order_acq_rel,
+                                                    memory_order_relaxed));
+
+    blog_record_t *rec = &s_ring[head & BLOG_RING_MASK];
+    rec->timestamp_us = esp_timer_get_time();
+    rec->id = (uint16_t)id;
+    rec->nargs = (nargs > BLOG_MAX_ARGS) ? BLOG_MAX_ARGS : (uint8_t)nargs;
+    for (uint32_t i = 0; i < rec->nargs; i++) {
+        rec->args[i] = args[i];
+    }
+
+    atomic_store_explicit(&rec->seq, (uint32_t)(head + 1), memory_order_release);
+}
+
+uint32_t blog_dropped(void)
+{
+    return (uint32_t)atomic_load_explicit(&s_dropped, memory_order_relaxed);
+}
+
+/* =============================================================================
+ * CONSUMER (drain task)
+ * ===========================================================================*/
+
+/**
+ * @brief Format one record against its format string
+ *
+ * Walks the format and renders each conversion separately, interpreting the
+ * raw 32-bit argument according to the conversion character.
+ */
+static void decode(const blog_record_t *rec, const char *fmt, char *out, size_t len)
+{
+    size_t pos = 0;
+    uint32_t arg = 0;
+
+    while (*fmt && pos < len - 1) {
+        if (*fmt != '%') {
+            out[pos++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[pos++] = '%';
+            fmt += 2;
+            continue;
+        }
+
+        // Copy one conversion spec, e.g. "%.2f"
+        char spec[16];
+        size_t spec_len = 0;
+        spec[spec_len++] = *fmt++;
+        while (*fmt && strchr("diuxXcsfeEgG", *fmt) == NULL && spec_len < sizeof(spec) - 2) {
+            spec[spec_len++] = *fmt++;
+        }
+        if (*fmt == '\0') {
+            break;
+        }
+        char conv = *fmt++;
+        spec[spec_len++] = conv;
+        spec[spec_len] = '\0';
+
+        uint32_t raw = (arg < rec->nargs) ? rec->args[arg++] : 0;
+        int n;
+        switch (conv) {
+            case 'f': case 'e': case 'E': case 'g': case 'G': {
+                float f;
+                memcpy(&f, &raw, sizeof(f));
+                n = snprintf(out + pos, len - pos, spec, (double)f);
+                break;
+            }
+            case 's':
+                n = snprintf(out + pos, len - pos, spec,
+                             raw ? (const char *)(uintptr_t)raw : "(null)");
+                break;
+            default:
+                n = snprintf(out + pos, len - pos, spec, raw);
+                break;
+        }
+        if (n < 0) {
+            break;
+        }
+        pos += ((size_t)n < len - pos) ? (size_t)n : len - pos - 1;
+    }
+
+    out[pos] = '\0';
+}
+
+static char level_letter(esp_log_level_t level)
+{
+    switch (level) {
+        case ESP_LOG_ERROR: return 'E';
+        case ESP_LOG_WARN: return 'W';
+        case ESP_LOG_INFO: return 'I';
+        case ESP_LOG_DEBUG: return 'D';
+        default: return 'V';
+    }
+}
+
+static void blog_drain(void)
+{
+    uint_fast32_t tail = atomic_load_explicit(&s_tail, memory_order_relaxed);
+    char msg[128];
+
+    while (1) {
+        blog_record_t *slot = &s_ring[tail & BLOG_RING_MASK];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != (uint32_t)(tail + 1)) {
+            break;  // Empty, or the producer is still filling this slot
+        }
+
+        blog_record_t rec;
+        rec.timestamp_us = slot->timestamp_us;
+        rec.id = slot->id;
+        rec.nargs = slot->nargs;
+        memcpy(rec.args, slot->args, sizeof(rec.args));
+
+        // Release the slot before the slow part
+        tail++;
+        atomic_store_explicit(&s_tail, tail, memory_order_release);
+
+        if (rec.id >= BLOG_FORMAT_COUNT) {
+            continue;
+        }
+        const blog_format_t *f = &s_formats[rec.id];
+        decode(&rec, f->fmt, msg, sizeof(msg));
+        esp_log_write(f->level, f->tag, "%c (%lu) %s: %s\n", level_letter(f->level),
+                      (unsigned long)(rec.timestamp_us / 1000), f->tag, msg);
+    }
+}
+
+static void blog_task(void *pvParameters)
+{
+    uint32_t reported_drops = 0;
+
+    while (1) {
+        blog_drain();
+
+        uint32_t dropped = blog_dropped();
+        if (dropped != reported_drops) {
+            ESP_LOGW(TAG, "%lu log records dropped (ring full)",
+                     (unsigned long)(dropped - reported_drops));
+            reported_drops = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(BLOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+esp_err_t blog_init(void)
+{
+    if (xTaskCreateStatic(blog_task, "blog_task", BLOG_TASK_STACK_SIZE, NULL,
+                          BLOG_TASK_PRIORITY, s_task_stack, &s_task_tcb) == NULL) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
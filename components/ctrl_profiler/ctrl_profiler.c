@@ -0,0 +1,139 @@
+/**
+ * @file ctrl_profiler.c
+ * @brief Cycle-accurate control loop profiler implementation
+ *
+ * The control task accumulates per-stage cycles inline (see ctrl_profiler.h)
+ * and commits them once per tick under a spinlock, so readers on the other
+ * core always see a consistent snapshot. A tick is only recorded if the CPU
+ * clock was the same at its start and commit, and is the fastest seen.
+ */
+
+#include "ctrl_profiler.h"
+#include "json_writer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+/* Per-tick accumulators written by the control task only */
+uint32_t g_prof_tick_start = 0;
+uint32_t g_prof_tick_mhz = 0;
+uint32_t g_prof_last_mark = 0;
+uint32_t g_prof_tick_acc[PROF_STAGE_COUNT] = {0};
+uint32_t g_prof_tick_mask = 0;
+
+static prof_snapshot_t s_prof = {0};
+static portMUX_TYPE s_prof_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const s_stage_names[PROF_STAGE_COUNT] = {
+    [PROF_STAGE_SAMPLE] = "sample",
+    [PROF_STAGE_ESTIMATE] = "estimate",
+    [PROF_STAGE_ZONE] = "zone",
+    [PROF_STAGE_PID] = "pid",
+    [PROF_STAGE_DAC] = "dac",
+    [PROF_STAGE_TELEMETRY] = "telemetry",
+    [PROF_STAGE_TICK] = "tick",
+};
+
+/**
+ * @brief log2 histogram bucket for a cycle count
+ */
+static inline uint32_t bucket_for(uint32_t cycles)
+{
+    if (cycles == 0) {
+        return 0;
+    }
+    uint32_t b = 31 - __builtin_clz(cycles);
+    return (b < CTRL_PROFILER_HIST_BUCKETS) ? b : CTRL_PROFILER_HIST_BUCKETS - 1;
+}
+
+static inline void record(prof_stage_stats_t *st, uint32_t cycles)
+{
+    if (st->count == 0 || cycles < st->min_cycles) {
+        st->min_cycles = cycles;
+    }
+    if (cycles > st->max_cycles) {
+        st->max_cycles = cycles;
+    }
+    st->count++;
+    st->total_cycles += cycles;
+    st->hist[bucket_for(cycles)]++;
+}
+
+void ctrl_profiler_commit_tick(uint32_t tick_cycles)
+{
+    uint32_t mhz = esp_rom_get_cpu_ticks_per_us();
+    uint32_t budget_cycles = CONTROL_LOOP_INTERVAL_MS * 1000U * mhz;
+
+    portENTER_CRITICAL(&s_prof_lock);
+    if (mhz != g_prof_tick_mhz || mhz < s_prof.cpu_mhz) {
+        // Slower clock or a DFS switch mid-tick: cycles are not comparable
+        s_prof.skipped++;
+        memset(g_prof_tick_acc, 0, sizeof(g_prof_tick_acc));
+        portEXIT_CRITICAL(&s_prof_lock);
+        return;
+    }
+    if (mhz > s_prof.cpu_mhz) {
+        // First tick, or the earlier ticks ran at a lower clock
+        memset(s_prof.stages, 0, sizeof(s_prof.stages));
+        s_prof.ticks = 0;
+        s_prof.overruns = 0;
+        s_prof.cpu_mhz = mhz;
+    }
+    for (int i = 0; i < PROF_STAGE_TICK; i++) {
+        if (g_prof_tick_mask & (1u << i)) {
+            record(&s_prof.stages[i], g_prof_tick_acc[i]);
+            g_prof_tick_acc[i] = 0;
+        }
+    }
+    record(&s_prof.stages[PROF_STAGE_TICK], tick_cycles);
+    s_prof.ticks++;
+    if (tick_cycles > budget_cycles) {
+        s_prof.overruns++;
+    }
+    portEXIT_CRITICAL(&s_prof_lock);
+}
+
+const char *ctrl_profiler_stage_name(prof_stage_t stage)
+{
+    return (stage < PROF_STAGE_COUNT) ? s_stage_names[stage] : "unknown";
+}
+
+void ctrl_profiler_snapshot(prof_snapshot_t *out)
+{
+    portENTER_CRITICAL(&s_prof_lock);
+    memcpy(out, &s_prof, sizeof(prof_snapshot_t));
+    portEXIT_CRITICAL(&s_prof_lock);
+}
+
+void ctrl_profiler_reset(void)
+{
+    portENTER_CRITICAL(&s_prof_lock);
+    memset(&s_prof, 0, sizeof(s_prof));
+    portEXIT_CRITICAL(&s_prof_lock);
+}
+
+esp_err_t ctrl_profiler_to_json(const prof_snapshot_t *snap, char *buf, size_t len)
+{
+    float mhz = (snap->cpu_mhz > 0) ? (float)snap->cpu_mhz : 1.0f;
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+
+    json_writer_append(&w, "{\"cpu_mhz\":%lu,\"ticks\":%lu,\"skipped\":%lu,\"overruns\":%lu,\"budget_us\":%u,\"stages\":[",
+                       (unsigned long)snap->cpu_mhz, (unsigned long)snap->ticks, (unsigned long)snap->skipped,
+                       (unsigned long)snap->overruns, CONTROL_LOOP_INTERVAL_MS * 1000U);
+
+    for (int i = 0; i < PROF_STAGE_COUNT; i++) {
+        const prof_stage_stats_t *st = &snap->stages[i];
+        float avg = st->count ? (float)st->total_cycles / st->count : 0.0f;
+
+        json_writer_append(&w, "%s{\"name\":\"%s\",\"count\":%lu,\"min_us\":%.2f,\"avg_us\":%.2f,\"max_us\":%.2f,\"hist\":[",
+                           i ? "," : "", s_stage_names[i], (unsigned long)st->count,
+                           st->min_cycles / mhz, avg / mhz, st->max_cycles / mhz);
+        for (int b = 0; b < CTRL_PROFILER_HIST_BUCKETS; b++) {
+            json_writer_append(&w, "%s%lu", b ? "," : "", (unsigned long)st->hist[b]);
+        }
+        json_writer_append(&w, "]}");
+    }
+    json_writer_append(&w, "]}");
+
+    return json_writer_status(&w);
+}
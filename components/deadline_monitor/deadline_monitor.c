@@ -0,0 +1,219 @@
+/**
+ * @file deadline_monitor.c
+ * @brief Deadline supervision implementation
+ *
+ * Per-task check-in state is only touched by its own task; the statistics
+ * are shared with readers under s_lock. The DAC guard ISR and the control
+ * task communicate through one atomic countdown: each control check-in
+ * reloads it, each guard period decrements it, and at zero the ISR zeroes
+ * the DAC. The ISR and everything it touches are in IRAM/DRAM
+ * (CONFIG_GPTIMER_ISR_IRAM_SAFE), so it also runs while the flash cache is
+ * disabled.
+ */
+
+#include "deadline_monitor.h"
+#include "config.h"
+#include "blog.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_task_wdt.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "hal/dac_ll.h"
+#include <stdatomic.h>
+
+static const char *TAG = "DEADLINE";
+
+typedef struct {
+    int64_t last_checkin_us;
+    int64_t deadline_us;
+    bool registered;
+} task_state_t;
+
+static const char *const s_names[DEADLINE_TASK_COUNT] = {
+    [DEADLINE_TASK_CONTROL] = "control",
+    [DEADLINE_TASK_SCALE] = "scale",
+};
+
+static const uint32_t s_slack_ms[DEADLINE_TASK_COUNT] = {
+    [DEADLINE_TASK_CONTROL] = DEADLINE_CONTROL_SLACK_MS,
+    [DEADLINE_TASK_SCALE] = DEADLINE_SCALE_SLACK_MS,
+};
+
+static task_state_t s_tasks[DEADLINE_TASK_COUNT];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static deadline_stats_t s_stats = {0};
+
+/* DAC guard */
+static gptimer_handle_t s_guard_timer = NULL;
+static atomic_uint_fast32_t s_guard_ticks_left = 0;   // Guard periods until the DAC is zeroed
+static atomic_uint_fast32_t s_guard_trips = 0;
+static atomic_bool s_guard_tripped = false;           // Since the last control check-in
+
+/* =============================================================================
+ * DAC GUARD
+ * ===========================================================================*/
+
+static uint32_t guard_ticks(uint32_t period_ms)
+{
+    uint32_t budget_ms = period_ms + DEADLINE_CONTROL_SLACK_MS + DEADLINE_GUARD_GRACE_MS;
+    return (budget_ms + DEADLINE_GUARD_PERIOD_MS - 1) / DEADLINE_GUARD_PERIOD_MS;
+}
+
+static bool IRAM_ATTR guard_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                     void *user_ctx)
+{
+    uint_fast32_t left = atomic_load_explicit(&s_guard_ticks_left, memory_order_relaxed);
+
+    // CAS so a reload by the control task in between is never overwritten
+    while (left > 0) {
+        if (atomic_compare_exchange_weak_explicit(&s_guard_ticks_left, &left, left - 1,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            return false;
+        }
+    }
+
+    // Control task overdue: zero the DAC register directly (the driver
+    // call is not ISR-safe). Repeated every period until it checks in.
+    dac_ll_update_output_value(DAC_CHAN_0, 0);
+    if (!atomic_exchange_explicit(&s_guard_tripped, true, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&s_guard_trips, 1, memory_order_relaxed);
+    }
+    return false;
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t deadline_monitor_init(void)
+{
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,   // 1 us
+    };
+    esp_err_t ret = gptimer_new_timer(&timer_config, &s_guard_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create guard timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = DEADLINE_GUARD_PERIOD_MS * 1000,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = guard_alarm_cb,
+    };
+    ret = gptimer_set_alarm_action(s_guard_timer, &alarm_config);
+    if (ret == ESP_OK) {
+        ret = gptimer_register_event_callbacks(s_guard_timer, &callbacks, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure guard timer: %s", esp_err_to_name(ret));
+        gptimer_del_timer(s_guard_timer);
+        s_guard_timer = NULL;
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "DAC guard ready: pressure off within %d ms of a control stall",
+             DEADLINE_GUARD_BOUND_MS);
+    return ESP_OK;
+}
+
+esp_err_t deadline_register(deadline_task_t task, uint32_t period_ms)
+{
+    int64_t now = esp_timer_get_time();
+    task_state_t *t = &s_tasks[task];
+
+    t->last_checkin_us = now;
+    t->deadline_us = now + (int64_t)(period_ms + s_slack_ms[task]) * 1000;
+    t->registered = true;
+    if (task == DEADLINE_TASK_CONTROL) {
+        atomic_store(&s_guard_ticks_left, guard_ticks(period_ms));
+    }
+
+    esp_err_t ret = esp_task_wdt_add(NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s task not on the task watchdog: %s", s_names[task], esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+bool deadline_checkin(deadline_task_t task, uint32_t period_ms)
+{
+    int64_t now = esp_timer_get_time();
+    task_state_t *t = &s_tasks[task];
+
+    if (task == DEADLINE_TASK_CONTROL) {
+        atomic_store(&s_guard_ticks_left, guard_ticks(period_ms));
+    }
+    if (!t->registered) {
+        return false;
+    }
+    esp_task_wdt_reset();
+
+    uint32_t gap_us = (uint32_t)(now - t->last_checkin_us);
+    uint32_t late_us = (now > t->deadline_us) ? (uint32_t)(now - t->deadline_us) : 0;
+    t->last_checkin_us = now;
+    t->deadline_us = now + (int64_t)(period_ms + s_slack_ms[task]) * 1000;
+
+    portENTER_CRITICAL(&s_lock);
+    deadline_task_stats_t *stats = &s_stats.tasks[task];
+    stats->checkins++;
+    stats->last_gap_us = gap_us;
+    if (gap_us > stats->max_gap_us) {
+        stats->max_gap_us = gap_us;
+    }
+    if (late_us > 0) {
+        stats->misses++;
+        if (late_us > stats->max_late_us) {
+            stats->max_late_us = late_us;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (late_us > 0) {
+        BLOG2(BLOG_DEADLINE_MISS, s_names[task], late_us);
+    }
+
+    return task == DEADLINE_TASK_CONTROL &&
+           atomic_exchange_explicit(&s_guard_tripped, false, memory_order_relaxed);
+}
+
+void deadline_guard_arm(bool armed)
+{
+    if (s_guard_timer == NULL || armed == s_stats.guard_armed) {
+        return;
+    }
+
+    if (armed) {
+        // Fresh budget: the countdown may be stale after idle mode
+        atomic_store(&s_guard_ticks_left, guard_ticks(CONTROL_LOOP_INTERVAL_MS));
+        gptimer_enable(s_guard_timer);
+        gptimer_start(s_guard_timer);
+    } else {
+        gptimer_stop(s_guard_timer);
+        gptimer_disable(s_guard_timer);
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.guard_armed = armed;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void deadline_get_stats(deadline_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+    stats->guard_trips = atomic_load(&s_guard_trips);
+}
+
+const char *deadline_task_name(deadline_task_t task)
+{
+    return (task < DEADLINE_TASK_COUNT) ? s_names[task] : "unknown";
+}
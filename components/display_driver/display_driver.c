@@ -0,0 +1,372 @@
+/**
+ * @file display_driver.c
+ * @brief LCD1602 driver: shadow framebuffer, diffed asynchronous I2C writes
+ *
+ * display_update() only renders the 16x2 frame into RAM and hands it to the
+ * LCD task; it never touches the bus. The LCD task compares the latest
+ * frame with s_shadow (what is on the glass), and sends only the changed
+ * runs of cells. Each run is a DDRAM address command plus its characters.
+ * The whole frame goes out as one 400 kHz I2C transaction. At 4 PCF8574
+ * bytes per HD44780 byte (two nibbles, each strobed with EN), every
+ * character takes ~90 us on the bus, longer than the 37 us the controller
+ * needs, so no delays are needed between bytes. Frames rendered while a
+ * transfer is in progress are coalesced: only the newest one is sent.
+ */
+
+#include "display_driver.h"
+#include "config.h"
+#include "safety_system.h"
+#include "batch.h"
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "DISPLAY";
+
+/* PCF8574 pins: P0 RS, P1 RW, P2 EN, P3 backlight, P4-P7 D4-D7 */
+#define LCD_RS          0x01
+#define LCD_EN          0x04
+#define LCD_BACKLIGHT   0x08
+
+/* HD44780 commands */
+#define LCD_CMD_CLEAR       0x01
+#define LCD_CMD_ENTRY_INC   0x06    // Cursor moves right, no shift
+#define LCD_CMD_DISPLAY_ON  0x0C    // Display on, cursor and blink off
+#define LCD_CMD_FUNC_4BIT   0x28    // 4-bit bus, 2 lines, 5x8 font
+#define LCD_CMD_SET_DDRAM   0x80
+
+/* Worst case frame: every row rewritten with one address command */
+#define LCD_TX_MAX (LCD_ROWS * (LCD_COLS + 1) * 4)
+
+typedef char lcd_frame_t[LCD_ROWS][LCD_COLS];
+
+static i2c_master_bus_handle_t s_bus = NULL;
+static i2c_master_dev_handle_t s_dev = NULL;
+static TaskHandle_t s_lcd_task = NULL;
+
+static StaticTask_t s_lcd_tcb;
+static StackType_t s_lcd_stack[LCD_TASK_STACK_SIZE];
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static lcd_frame_t s_pending;           // Newest frame from display_update() (under s_lock)
+static lcd_frame_t s_shadow;            // Contents of the glass (LCD task only)
+static uint8_t s_tx[LCD_TX_MAX];        // Frame transaction (LCD task only)
+static display_stats_t s_stats = {0};
+
+/* =============================================================================
+ * BUS ENCODING
+ * ===========================================================================*/
+
+static size_t put_nibble(uint8_t *buf, size_t len, uint8_t nibble, uint8_t flags)
+{
+    uint8_t bits = (uint8_t)(nibble << 4) | flags | LCD_BACKLIGHT;
+    buf[len++] = bits | LCD_EN;     // Latched on the falling edge of EN
+    buf[len++] = bits;
+    return len;
+}
+
+static size_t put_byte(uint8_t *buf, size_t len, uint8_t value, uint8_t flags)
+{
+    len = put_nibble(buf, len, value >> 4, flags);
+    return put_nibble(buf, len, value & 0x0F, flags);
+}
+
+static esp_err_t send_command(uint8_t cmd)
+{
+    uint8_t buf[4];
+    size_t len = put_byte(buf, 0, cmd, 0);
+    return i2c_master_transmit(s_dev, buf, len, LCD_I2C_TIMEOUT_MS);
+}
+
+/**
+ * @brief HD44780 power-up sequence into 4-bit mode (display_init, before the LCD task)
+ */
+static esp_err_t lcd_controller_init(void)
+{
+    uint8_t buf[2];
+
+    vTaskDelay(pdMS_TO_TICKS(50));  // Controller power-up time
+
+    // Three times 8-bit mode, whatever mode the controller was left in
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < 3 && ret == ESP_OK; i++) {
+        ret = i2c_master_transmit(s_dev, buf, put_nibble(buf, 0, 0x03, 0), LCD_I2C_TIMEOUT_MS);
+        esp_rom_delay_us(4500);
+    }
+    if (ret == ESP_OK) {
+        ret = i2c_master_transmit(s_dev, buf, put_nibble(buf, 0, 0x02, 0), LCD_I2C_TIMEOUT_MS);
+        esp_rom_delay_us(150);
+    }
+    if (ret == ESP_OK) {
+        ret = send_command(LCD_CMD_FUNC_4BIT);
+    }
+    if (ret == ESP_OK) {
+        ret = send_command(LCD_CMD_DISPLAY_ON);
+    }
+    if (ret == ESP_OK) {
+        ret = send_command(LCD_CMD_CLEAR);
+        esp_rom_delay_us(2000);
+    }
+    if (ret == ESP_OK) {
+        ret = send_command(LCD_CMD_ENTRY_INC);
+    }
+    return ret;
+}
+
+/* =============================================================================
+ * LCD TASK
+ * ===========================================================================*/
+
+/**
+ * @brief Encode the changed runs of one row
+ * @param frame New frame
+ * @param row Row index
+ * @param len Bytes already in s_tx
+ * @param cells Incremented by the cells written
+ * @return New length of s_tx
+ */
+static size_t diff_row(const lcd_frame_t frame, int row, size_t len, uint32_t *cells)
+{
+    int col = 0;
+
+    while (col < LCD_COLS) {
+        if (frame[row][col] == s_shadow[row][col]) {
+            col++;
+            continue;
+        }
+
+        // Extend the run over gaps no longer than LCD_MERGE_GAP
+        int end = col + 1;
+        for (int next = end; next < LCD_COLS && next - end <= LCD_MERGE_GAP; next++) {
+            if (frame[row][next] != s_shadow[row][next]) {
+                end = next + 1;
+            }
+        }
+
+        len = put_byte(s_tx, len, LCD_CMD_SET_DDRAM | (row * 0x40 + col), 0);
+        for (int c = col; c < end; c++) {
+            len = put_byte(s_tx, len, (uint8_t)frame[row][c], LCD_RS);
+        }
+        *cells += end - col;
+        col = end;
+    }
+    return len;
+}
+
+static void lcd_task(void *arg)
+{
+    lcd_frame_t frame;
+
+    // Force a full rewrite of the first frame: its bus time is the
+    // full-frame baseline (full_frame_us) the diffed frames compare against
+    memset(s_shadow, 0, sizeof(s_shadow));
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&s_lock);
+        memcpy(frame, s_pending, sizeof(frame));
+        portEXIT_CRITICAL(&s_lock);
+
+        uint32_t cells = 0;
+        size_t len = 0;
+        for (int row = 0; row < LCD_ROWS; row++) {
+            len = diff_row(frame, row, len, &cells);
+        }
+        if (len == 0) {
+            portENTER_CRITICAL(&s_lock);
+            s_stats.frames_unchanged++;
+            portEXIT_CRITICAL(&s_lock);
+            continue;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t ret = i2c_master_transmit(s_dev, s_tx, len, LCD_I2C_TIMEOUT_MS);
+        uint32_t bus_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        if (ret == ESP_OK) {
+            memcpy(s_shadow, frame, sizeof(s_shadow));
+        } else {
+            // Glass contents unknown: rewrite every cell next frame
+            memset(s_shadow, 0, sizeof(s_shadow));
+        }
+
+        portENTER_CRITICAL(&s_lock);
+        if (ret == ESP_OK) {
+            s_stats.frames_sent++;
+            s_stats.cells_written += cells;
+            s_stats.bytes_sent += len;
+            s_stats.last_frame_us = bus_us;
+            if (bus_us > s_stats.max_frame_us) {
+                s_stats.max_frame_us = bus_us;
+            }
+            if (cells == LCD_ROWS * LCD_COLS) {
+                s_stats.full_frame_us = bus_us;
+            }
+        } else {
+            s_stats.i2c_errors++;
+        }
+        portEXIT_CRITICAL(&s_lock);
+    }
+}
+
+/* =============================================================================
+ * RENDERING
+ * ===========================================================================*/
+
+/**
+ * @brief Copy a line into a frame row, space padded
+ */
+static void set_row(lcd_frame_t frame, int row, const char *text)
+{
+    size_t n = strnlen(text, LCD_COLS);
+    memcpy(frame[row], text, n);
+    memset(frame[row] + n, ' ', LCD_COLS - n);
+}
+
+static void render(lcd_frame_t frame, const system_state_t *state)
+{
+    char line1[LCD_COLS + 1];
+    char line2[LCD_COLS + 1];
+
+    switch (state->state) {
+        case STATE_IDLE:
+            snprintf(line1, sizeof(line1), "Target %6.1f lb", state->target_weight_lbs);
+            if (batch_active()) {
+                batch_status_t batch;
+                batch_get_status(&batch);
+                snprintf(line2, sizeof(line2), "Batch %u/%u", batch.done + 1, batch.drums);
+            } else if (state->scale_online) {
+                snprintf(line2, sizeof(line2), "Scale  %6.1f lb", state->current_weight_lbs);
+            } else {
+                snprintf(line2, sizeof(line2), "Scale offline");
+            }
+            break;
+
+        case STATE_SAFETY_CHECK:
+            safety_get_prompt(line1, line2);
+            break;
+
+        case STATE_FILLING: {
+            float net = state->current_weight_lbs - state->start_weight_lbs;
+            snprintf(line1, sizeof(line1), "%6.1f/%5.0f lb", net, state->target_weight_lbs);
+            snprintf(line2, sizeof(line2), "%-8s P%3.0f%%", zone_to_string(state->active_zone),
+                     state->pressure_setpoint_pct);
+            break;
+        }
+
+        case STATE_COMPLETED:
+            snprintf(line1, sizeof(line1), "Settling...");
+            snprintf(line2, sizeof(line2), "Cutoff %6.1f lb", state->cutoff_weight_lbs - state->start_weight_lbs);
+            break;
+
+        case STATE_ERROR:
+            snprintf(line1, sizeof(line1), "ERROR");
+            snprintf(line2, sizeof(line2), "%s", error_to_string(state->error));
+            break;
+
+        case STATE_CANCELLED:
+        default:
+            snprintf(line1, sizeof(line1), "Fill cancelled");
+            line2[0] = '\0';
+            break;
+    }
+
+    set_row(frame, 0, line1);
+    set_row(frame, 1, line2);
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t display_init(void)
+{
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = -1,                     // Any free controller
+        .sda_io_num = PIN_LCD_SDA,
+        .scl_io_num = PIN_LCD_SCL,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    esp_err_t ret = i2c_new_master_bus(&bus_config, &s_bus);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create I2C bus: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = i2c_master_probe(s_bus, LCD_I2C_ADDR, LCD_I2C_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "No LCD backpack at 0x%02X: %s", LCD_I2C_ADDR, esp_err_to_name(ret));
+        i2c_del_master_bus(s_bus);
+        s_bus = NULL;
+        return ret;
+    }
+
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = LCD_I2C_ADDR,
+        .scl_speed_hz = LCD_I2C_FREQ_HZ,
+    };
+    ret = i2c_master_bus_add_device(s_bus, &dev_config, &s_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add LCD device: %s", esp_err_to_name(ret));
+        i2c_del_master_bus(s_bus);
+        s_bus = NULL;
+        return ret;
+    }
+
+    // Before the task exists: a dead controller fails init and leaves
+    // display_update() returning ESP_ERR_INVALID_STATE
+    ret = lcd_controller_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "LCD controller did not respond: %s", esp_err_to_name(ret));
+        i2c_master_bus_rm_device(s_dev);
+        s_dev = NULL;
+        i2c_del_master_bus(s_bus);
+        s_bus = NULL;
+        return ret;
+    }
+
+    memset(s_pending, ' ', sizeof(s_pending));
+    s_lcd_task = xTaskCreateStatic(lcd_task, "lcd_task", LCD_TASK_STACK_SIZE, NULL,
+                                   LCD_TASK_PRIORITY, s_lcd_stack, &s_lcd_tcb);
+    if (s_lcd_task == NULL) {
+        ESP_LOGE(TAG, "Failed to create LCD task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "LCD at 0x%02X, %d kHz I2C", LCD_I2C_ADDR, LCD_I2C_FREQ_HZ / 1000);
+    return ESP_OK;
+}
+
+esp_err_t display_update(system_state_t *state)
+{
+    if (s_lcd_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lcd_frame_t frame;
+    render(frame, state);
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(s_pending, frame, sizeof(s_pending));
+    s_stats.frames_rendered++;
+    portEXIT_CRITICAL(&s_lock);
+
+    xTaskNotifyGive(s_lcd_task);
+    return ESP_OK;
+}
+
+void display_get_stats(display_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
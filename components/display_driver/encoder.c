@@ -0,0 +1,208 @@
+/**
+ * @file encoder.c
+ * @brief Rotary encoder decoding on the PCNT peripheral
+ *
+ * Both encoder lines feed one PCNT unit with two channels (x4 quadrature):
+ * each channel counts the edges of one line, with direction taken from the
+ * level of the other. Contact bounce on one line while the other is steady
+ * counts +1/-1 and cancels out, and the glitch filter drops spikes shorter
+ * than ENCODER_GLITCH_NS. The driver extends the hardware counter past
+ * ±ENCODER_PCNT_LIMIT (accum_count), so no count is lost between two
+ * display ticks and no CPU time is spent per edge.
+ *
+ * The glitch filter holds an APB PM lock while the unit is enabled, so the
+ * unit is disabled in idle mode. The first click of the turn that wakes
+ * the controller is then seen as a level change only and just wakes it.
+ */
+
+#include "display_driver.h"
+#include "config.h"
+#include "power_manager.h"
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+
+static const char *TAG = "ENCODER";
+
+static pcnt_unit_handle_t s_unit = NULL;
+
+static struct {
+    bool enabled;               // Unit counting (active mode)
+    int last_count;
+    int residual;               // Counts short of a full detent
+    int64_t last_poll_us;
+    int idle_clk, idle_dt;      // Line levels when the unit was disabled
+} s_enc = {0};
+
+/* =============================================================================
+ * HELPERS
+ * ===========================================================================*/
+
+static void encoder_enable(bool enable)
+{
+    if (enable == s_enc.enabled) {
+        return;
+    }
+
+    if (enable) {
+        pcnt_unit_enable(s_unit);
+        pcnt_unit_start(s_unit);
+        pcnt_unit_get_count(s_unit, &s_enc.last_count);
+        s_enc.residual = 0;
+        s_enc.last_poll_us = esp_timer_get_time();
+    } else {
+        pcnt_unit_stop(s_unit);
+        pcnt_unit_disable(s_unit);
+        s_enc.idle_clk = gpio_get_level(PIN_ENCODER_CLK);
+        s_enc.idle_dt = gpio_get_level(PIN_ENCODER_DT);
+    }
+    s_enc.enabled = enable;
+}
+
+/**
+ * @brief Weight step multiplier for the current spin rate
+ * @param detents Detents since the last poll
+ * @param elapsed_us Time since the last poll
+ */
+static int accel_multiplier(int detents, int64_t elapsed_us)
+{
+    if (elapsed_us <= 0) {
+        return 1;
+    }
+    int64_t rate_dps = (int64_t)abs(detents) * 1000000 / elapsed_us;
+    if (rate_dps >= ENCODER_ACCEL_FAST_DPS) {
+        return ENCODER_ACCEL_FAST_MULT;
+    }
+    if (rate_dps >= ENCODER_ACCEL_MID_DPS) {
+        return ENCODER_ACCEL_MID_MULT;
+    }
+    return 1;
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t display_encoder_init(void)
+{
+    pcnt_unit_config_t unit_config = {
+        .high_limit = ENCODER_PCNT_LIMIT,
+        .low_limit = -ENCODER_PCNT_LIMIT,
+        .flags.accum_count = true,      // Keep counting across the limits
+    };
+    esp_err_t ret = pcnt_new_unit(&unit_config, &s_unit);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create PCNT unit: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    pcnt_glitch_filter_config_t filter_config = {
+        .max_glitch_ns = ENCODER_GLITCH_NS,
+    };
+    pcnt_chan_config_t chan_a_config = {
+        .edge_gpio_num = PIN_ENCODER_CLK,
+        .level_gpio_num = PIN_ENCODER_DT,
+    };
+    pcnt_chan_config_t chan_b_config = {
+        .edge_gpio_num = PIN_ENCODER_DT,
+        .level_gpio_num = PIN_ENCODER_CLK,
+    };
+    pcnt_channel_handle_t chan_a = NULL;
+    pcnt_channel_handle_t chan_b = NULL;
+
+    ret = pcnt_unit_set_glitch_filter(s_unit, &filter_config);
+    if (ret == ESP_OK) {
+        ret = pcnt_new_channel(s_unit, &chan_a_config, &chan_a);
+    }
+    if (ret == ESP_OK) {
+        ret = pcnt_new_channel(s_unit, &chan_b_config, &chan_b);
+    }
+    if (ret == ESP_OK) {
+        pcnt_channel_set_edge_action(chan_a, PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+                                     PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+        pcnt_channel_set_level_action(chan_a, PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+                                      PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+        pcnt_channel_set_edge_action(chan_b, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                     PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+        pcnt_channel_set_level_action(chan_b, PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+                                      PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+        // Overflow watch points let the driver extend the count (accum_count)
+        ret = pcnt_unit_add_watch_point(s_unit, ENCODER_PCNT_LIMIT);
+    }
+    if (ret == ESP_OK) {
+        ret = pcnt_unit_add_watch_point(s_unit, -ENCODER_PCNT_LIMIT);
+    }
+    if (ret == ESP_OK) {
+        ret = pcnt_unit_clear_count(s_unit);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure PCNT: %s", esp_err_to_name(ret));
+        if (chan_b) {
+            pcnt_del_channel(chan_b);
+        }
+        if (chan_a) {
+            pcnt_del_channel(chan_a);
+        }
+        pcnt_del_unit(s_unit);
+        s_unit = NULL;
+        return ret;
+    }
+
+    encoder_enable(true);
+    ESP_LOGI(TAG, "Encoder on PCNT (x%d quadrature, %d ns glitch filter)",
+             ENCODER_COUNTS_PER_DETENT, ENCODER_GLITCH_NS);
+    return ESP_OK;
+}
+
+esp_err_t display_handle_encoder(void)
+{
+    if (s_unit == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+
+    // Unit off in idle mode: any line change is a turn that woke the chip
+    encoder_enable(!power_manager_is_idle());
+    if (!s_enc.enabled) {
+        if (gpio_get_level(PIN_ENCODER_CLK) != s_enc.idle_clk ||
+            gpio_get_level(PIN_ENCODER_DT) != s_enc.idle_dt) {
+            g_system_state.last_interaction_ms = (uint32_t)(now_us / 1000);
+        }
+        return ESP_OK;
+    }
+
+    int count = 0;
+    esp_err_t ret = pcnt_unit_get_count(s_unit, &count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    s_enc.residual += count - s_enc.last_count;
+    s_enc.last_count = count;
+    int detents = s_enc.residual / ENCODER_COUNTS_PER_DETENT;
+    s_enc.residual -= detents * ENCODER_COUNTS_PER_DETENT;
+
+    int64_t elapsed_us = now_us - s_enc.last_poll_us;
+    s_enc.last_poll_us = now_us;
+    if (detents == 0) {
+        return ESP_OK;
+    }
+
+    g_system_state.last_interaction_ms = (uint32_t)(now_us / 1000);
+
+    // The target only changes between fills
+    if (g_system_state.state == STATE_IDLE) {
+        float step = WEIGHT_INCREMENT_LBS * accel_multiplier(detents, elapsed_us);
+        float target = g_system_state.target_weight_lbs + detents * step;
+        if (target < MIN_TARGET_WEIGHT_LBS) {
+            target = MIN_TARGET_WEIGHT_LBS;
+        } else if (target > MAX_TARGET_WEIGHT_LBS) {
+            target = MAX_TARGET_WEIGHT_LBS;
+        }
+        g_system_state.target_weight_lbs = target;
+    }
+    return ESP_OK;
+}
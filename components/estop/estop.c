@@ -0,0 +1,228 @@
+/**
+ * @file estop.c
+ * @brief Emergency stop implementation
+ *
+ * The ISR and trip() are in IRAM and only touch DRAM state, the DAC
+ * register (hal/dac_ll.h, as in the DAC guard) and esp_timer. The latch is
+ * an atomic flag so pressure_controller can test it on every write without
+ * a lock; the statistics are shared under s_lock.
+ */
+
+#include "estop.h"
+#include "config.h"
+#include "system_state.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_bit_defs.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "hal/dac_ll.h"
+#include "soc/gpio_struct.h"
+#include <stdatomic.h>
+
+static const char *TAG = "ESTOP";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static estop_stats_t s_stats = {0};
+static atomic_bool s_latched = false;
+
+/* Self-test: set by the test before it raises the interrupt */
+static volatile bool s_test_pending = false;
+static volatile int64_t s_test_raised_us = 0;
+static volatile uint32_t s_test_latency_us = 0;
+
+static const char *const s_source_names[ESTOP_SOURCE_COUNT] = {
+    [ESTOP_SOURCE_INPUT] = "input",
+    [ESTOP_SOURCE_API] = "api",
+    [ESTOP_SOURCE_MQTT] = "mqtt",
+};
+
+/* =============================================================================
+ * TRIP PATH
+ * ===========================================================================*/
+
+/**
+ * @brief Count a stop (ISR or task, latched and DAC already at zero)
+ *
+ * The latch is set before the DAC is zeroed: a control write that missed
+ * it landed before the zero, and one after it sees the latch and re-zeroes
+ * (set_dac_output() checks estop_active() again after writing).
+ */
+static void IRAM_ATTR trip(estop_source_t source, uint32_t latency_us, bool was_latched)
+{
+    portENTER_CRITICAL_SAFE(&s_lock);
+    s_stats.trips[source]++;
+    s_stats.last_latency_us = latency_us;
+    if (latency_us > s_stats.max_latency_us) {
+        s_stats.max_latency_us = latency_us;
+    }
+    if (!was_latched) {
+        s_stats.source = source;
+    }
+    s_stats.latched = true;
+    portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+static void IRAM_ATTR estop_isr(void *arg)
+{
+    int64_t entry_us = esp_timer_get_time();
+
+    // A real press during a self-test still holds the level: estop_poll() latches it
+    if (s_test_pending) {
+        dac_ll_update_output_value(DAC_CHAN_0, 0);
+        s_test_latency_us = (uint32_t)(esp_timer_get_time() - s_test_raised_us);
+        s_test_pending = false;
+        return;
+    }
+
+    // Pressure first, bookkeeping after
+    bool was_latched = atomic_exchange(&s_latched, true);
+    dac_ll_update_output_value(DAC_CHAN_0, 0);
+    int64_t zero_us = esp_timer_get_time();
+    trip(ESTOP_SOURCE_INPUT, (uint32_t)(zero_us - entry_us), was_latched);
+}
+
+/**
+ * @brief Raise the PIN_ESTOP interrupt in software (W1TS status register)
+ */
+static void raise_test_interrupt(void)
+{
+#if PIN_ESTOP < 32
+    GPIO.status_w1ts = BIT(PIN_ESTOP);
+#else
+    GPIO.status1_w1ts.val = BIT(PIN_ESTOP - 32);
+#endif
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t estop_init(void)
+{
+    gpio_config_t estop_cfg = {
+        .pin_bit_mask = (1ULL << PIN_ESTOP),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,      // External pull-up (input-only pin)
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = ESTOP_ACTIVE_LEVEL ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE,
+    };
+    esp_err_t ret = gpio_config(&estop_cfg);
+
+    // GPIO ISR service: installed once by app_main()
+    if (ret == ESP_OK) {
+        ret = gpio_isr_handler_add(PIN_ESTOP, estop_isr, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up e-stop input: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Asserted at power-up: no edge will come
+    estop_poll();
+    ESP_LOGI(TAG, "E-stop on GPIO%d%s", PIN_ESTOP, estop_active() ? " (asserted, latched)" : "");
+    return ESP_OK;
+}
+
+void estop_trigger(estop_source_t source)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    bool was_latched = atomic_exchange(&s_latched, true);
+    dac_ll_update_output_value(DAC_CHAN_0, 0);
+
+    trip(source, (uint32_t)(esp_timer_get_time() - start_us), was_latched);
+}
+
+bool estop_active(void)
+{
+    return atomic_load(&s_latched);
+}
+
+void estop_poll(void)
+{
+    if (!estop_active() && gpio_get_level(PIN_ESTOP) == ESTOP_ACTIVE_LEVEL) {
+        estop_trigger(ESTOP_SOURCE_INPUT);
+    }
+}
+
+esp_err_t estop_reset(void)
+{
+    if (gpio_get_level(PIN_ESTOP) == ESTOP_ACTIVE_LEVEL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    atomic_store(&s_latched, false);
+    portENTER_CRITICAL(&s_lock);
+    s_stats.latched = false;
+    portEXIT_CRITICAL(&s_lock);
+    ESP_LOGI(TAG, "E-stop reset");
+    return ESP_OK;
+}
+
+esp_err_t estop_self_test(void)
+{
+    // The ISR writes 0 to the DAC: only while it is at 0 anyway
+    if (g_system_state.state != STATE_IDLE || estop_active()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint32_t runs = 0;
+    uint32_t failures = 0;
+
+    for (int i = 0; i < ESTOP_SELFTEST_RUNS; i++) {
+        s_test_pending = true;
+        s_test_raised_us = esp_timer_get_time();
+        raise_test_interrupt();
+
+        for (int waited = 0; s_test_pending && waited < ESTOP_SELFTEST_TIMEOUT_US; waited++) {
+            esp_rom_delay_us(1);
+        }
+        if (s_test_pending) {
+            s_test_pending = false;
+            failures++;
+            continue;
+        }
+
+        uint32_t latency_us = s_test_latency_us;
+        runs++;
+        if (latency_us < min_us) {
+            min_us = latency_us;
+        }
+        if (latency_us > max_us) {
+            max_us = latency_us;
+        }
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.test_runs += runs;
+    s_stats.test_failures += failures;
+    if (runs > 0) {
+        s_stats.test_min_us = min_us;
+        s_stats.test_max_us = max_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (failures > 0) {
+        ESP_LOGE(TAG, "Self-test: ISR missed %lu of %d runs", (unsigned long)failures, ESTOP_SELFTEST_RUNS);
+        return ESP_ERR_TIMEOUT;
+    }
+    ESP_LOGI(TAG, "Self-test: trigger to DAC zero %lu-%lu us", (unsigned long)min_us, (unsigned long)max_us);
+    return ESP_OK;
+}
+
+void estop_get_stats(estop_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+const char *estop_source_name(estop_source_t source)
+{
+    return (source < ESTOP_SOURCE_COUNT) ? s_source_names[source] : "unknown";
+}
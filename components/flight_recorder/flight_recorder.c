@@ -0,0 +1,299 @@
+/**
+ * @file flight_recorder.c
+ * @brief Always-on flight recorder implementation
+ *
+ * The ring is written under a spinlock by whichever task makes the
+ * transition (a 32-byte copy). Saving to flash is deferred to a low-priority
+ * task, except on the boot after a crash, where init saves synchronously
+ * before any task can overwrite the retained entries.
+ */
+
+#include "flight_recorder.h"
+#include "config.h"
+#include "system_state.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "FLIGHTREC";
+
+#define FLIGHTREC_RING_MAGIC 0x46524543   // "FREC"
+#define FLIGHTREC_DUMP_MAGIC 0x46524455   // "FRDU"
+#define FLIGHTREC_SECTOR_SIZE 4096
+
+_Static_assert(sizeof(flightrec_entry_t) == 32, "flightrec_entry_t layout changed");
+
+/**
+ * @brief Ring retained across soft resets (RTC slow memory, not initialized)
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t boot;
+    uint32_t head;            // Next write index
+    uint32_t count;           // Valid entries, up to FLIGHTREC_ENTRIES
+    flightrec_entry_t entries[FLIGHTREC_ENTRIES];
+} flightrec_ring_t;
+
+static RTC_NOINIT_ATTR flightrec_ring_t s_ring;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_ready = false;
+static QueueHandle_t s_save_queue = NULL;
+static StaticQueue_t s_save_queue_buf;
+static uint8_t s_save_queue_storage[sizeof(flightrec_trigger_t)];
+static StaticTask_t s_task_tcb;
+static StackType_t s_task_stack[FLIGHTREC_TASK_STACK_SIZE];
+static const esp_partition_t *s_partition = NULL;
+
+/* Scratch copy for saving; used by init and then only by the recorder task */
+static flightrec_entry_t s_scratch[FLIGHTREC_ENTRIES];
+
+/* =============================================================================
+ * RING
+ * ===========================================================================*/
+
+static void append_locked(const flightrec_entry_t *entry)
+{
+    s_ring.entries[s_ring.head] = *entry;
+    s_ring.head = (s_ring.head + 1) % FLIGHTREC_ENTRIES;
+    if (s_ring.count < FLIGHTREC_ENTRIES) {
+        s_ring.count++;
+    }
+}
+
+void flightrec_record(flightrec_kind_t kind, uint8_t from, uint8_t to)
+{
+    if (!s_ready) {
+        return;
+    }
+
+    flightrec_entry_t entry = {
+        .timestamp_us = esp_timer_get_time(),
+        .kind = (uint8_t)kind,
+        .from = from,
+        .to = to,
+        .weight_lbs = g_system_state.current_weight_lbs,
+        .pressure_pct = g_system_state.pressure_setpoint_pct,
+        .target_lbs = g_system_state.target_weight_lbs,
+        .fill_number = g_system_state.fill_number,
+    };
+
+    portENTER_CRITICAL(&s_lock);
+    entry.boot = s_ring.boot;
+    append_locked(&entry);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+size_t flightrec_copy(flightrec_entry_t *out, size_t max)
+{
+    if (!s_ready) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    size_t count = (s_ring.count < max) ? s_ring.count : max;
+    uint32_t start = (s_ring.head + FLIGHTREC_ENTRIES - count) % FLIGHTREC_ENTRIES;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = s_ring.entries[(start + i) % FLIGHTREC_ENTRIES];
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    return count;
+}
+
+/* =============================================================================
+ * FLASH DUMP
+ * ===========================================================================*/
+
+static esp_err_t save_to_flash(flightrec_trigger_t trigger)
+{
+    if (s_partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    flightrec_dump_header_t header = {
+        .magic = FLIGHTREC_DUMP_MAGIC,
+        .boot = s_ring.boot,
+        .trigger = trigger,
+        .count = flightrec_copy(s_scratch, FLIGHTREC_ENTRIES),
+    };
+
+    size_t entries_len = header.count * sizeof(flightrec_entry_t);
+    size_t total = sizeof(header) + entries_len;
+    size_t erase_len = (total + FLIGHTREC_SECTOR_SIZE - 1) & ~(size_t)(FLIGHTREC_SECTOR_SIZE - 1);
+
+    esp_err_t ret = esp_partition_erase_range(s_partition, 0, erase_len);
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(s_partition, sizeof(header), s_scratch, entries_len);
+    }
+    // Header last, so an interrupted save never looks valid
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(s_partition, 0, &header, sizeof(header));
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save flight recorder: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGW(TAG, "Flight recorder saved (%s, %lu entries)",
+             flightrec_trigger_to_string(trigger), (unsigned long)header.count);
+    return ESP_OK;
+}
+
+void flightrec_trigger_save(flightrec_trigger_t trigger)
+{
+    if (s_save_queue == NULL) {
+        return;
+    }
+    // A save already pending will include this transition too
+    xQueueSend(s_save_queue, &trigger, 0);
+}
+
+esp_err_t flightrec_load_saved(flightrec_dump_header_t *header, flightrec_entry_t *out, size_t max)
+{
+    if (s_partition == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = esp_partition_read(s_partition, 0, header, sizeof(*header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (header->magic != FLIGHTREC_DUMP_MAGIC || header->count > FLIGHTREC_ENTRIES) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (header->count > max) {
+        header->count = max;
+    }
+    return esp_partition_read(s_partition, sizeof(*header), out,
+                              header->count * sizeof(flightrec_entry_t));
+}
+
+static void flightrec_task(void *pvParameters)
+{
+    flightrec_trigger_t trigger;
+
+    while (1) {
+        if (xQueueReceive(s_save_queue, &trigger, portMAX_DELAY) == pdTRUE) {
+            save_to_flash(trigger);
+        }
+    }
+}
+
+/* =============================================================================
+ * INITIALIZATION
+ * ===========================================================================*/
+
+esp_err_t flightrec_init(void)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    // RTC memory holds garbage after power-on; otherwise keep the old ring
+    if (reason == ESP_RST_POWERON || s_ring.magic != FLIGHTREC_RING_MAGIC ||
+        s_ring.head >= FLIGHTREC_ENTRIES || s_ring.count > FLIGHTREC_ENTRIES) {
+        memset(&s_ring, 0, sizeof(s_ring));
+        s_ring.magic = FLIGHTREC_RING_MAGIC;
+    }
+    s_ring.boot++;
+
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                           FLIGHTREC_PARTITION_LABEL);
+    if (s_partition == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition, dumps disabled", FLIGHTREC_PARTITION_LABEL);
+    }
+
+    s_ready = true;
+
+    // Save what led up to the crash before new transitions push it out
+    if (reason == ESP_RST_PANIC) {
+        save_to_flash(FLIGHTREC_TRIGGER_PANIC);
+    } else if (reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT) {
+        save_to_flash(FLIGHTREC_TRIGGER_WDT);
+    }
+
+    flightrec_record(FLIGHTREC_BOOT, 0, (uint8_t)reason);
+
+    s_save_queue = xQueueCreateStatic(1, sizeof(flightrec_trigger_t), s_save_queue_storage,
+                                      &s_save_queue_buf);
+    if (xTaskCreateStatic(flightrec_task, "flightrec_task", FLIGHTREC_TASK_STACK_SIZE, NULL,
+                          FLIGHTREC_TASK_PRIORITY, s_task_stack, &s_task_tcb) == NULL) {
+        ESP_LOGE(TAG, "Failed to create recorder task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Flight recorder ready (boot %lu, %lu retained entries)",
+             (unsigned long)s_ring.boot, (unsigned long)s_ring.count);
+    return ESP_OK;
+}
+
+/* =============================================================================
+ * FORMATTING
+ * ===========================================================================*/
+
+static const char *kind_to_string(uint8_t kind)
+{
+    switch (kind) {
+        case FLIGHTREC_BOOT: return "boot";
+        case FLIGHTREC_STATE: return "state";
+        case FLIGHTREC_ZONE: return "zone";
+        case FLIGHTREC_SAFETY: return "safety";
+        case FLIGHTREC_ERROR: return "error";
+        default: return "unknown";
+    }
+}
+
+static const char *value_to_string(uint8_t kind, uint8_t value)
+{
+    switch (kind) {
+        case FLIGHTREC_STATE: return state_to_string((system_state_enum_t)value);
+        case FLIGHTREC_ZONE: return zone_to_string((fill_zone_t)value);
+        case FLIGHTREC_SAFETY: return safety_to_string((safety_state_t)value);
+        case FLIGHTREC_ERROR: return error_to_string((error_code_t)value);
+        default: return NULL;
+    }
+}
+
+const char *flightrec_trigger_to_string(flightrec_trigger_t trigger)
+{
+    switch (trigger) {
+        case FLIGHTREC_TRIGGER_ERROR: return "error";
+        case FLIGHTREC_TRIGGER_PANIC: return "panic";
+        case FLIGHTREC_TRIGGER_WDT: return "watchdog";
+        default: return "unknown";
+    }
+}
+
+esp_err_t flightrec_entry_to_json(const flightrec_entry_t *entry, char *buf, size_t len)
+{
+    int n;
+    const char *from = value_to_string(entry->kind, entry->from);
+    const char *to = value_to_string(entry->kind, entry->to);
+
+    if (from && to) {
+        n = snprintf(buf, len,
+                     "{\"boot\":%lu,\"t_us\":%lld,\"kind\":\"%s\",\"from\":\"%s\",\"to\":\"%s\","
+                     "\"weight\":%.2f,\"pressure\":%.1f,\"target\":%.1f,\"fill\":%lu}",
+                     (unsigned long)entry->boot, (long long)entry->timestamp_us,
+                     kind_to_string(entry->kind), from, to,
+                     entry->weight_lbs, entry->pressure_pct, entry->target_lbs,
+                     (unsigned long)entry->fill_number);
+    } else {
+        // Boot marker: "to" is the numeric esp_reset_reason_t
+        n = snprintf(buf, len,
+                     "{\"boot\":%lu,\"t_us\":%lld,\"kind\":\"%s\",\"reset_reason\":%u}",
+                     (unsigned long)entry->boot, (long long)entry->timestamp_us,
+                     kind_to_string(entry->kind), entry->to);
+    }
+
+    return (n < 0 || (size_t)n >= len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file heap_monitor.c
+ * @brief Heap allocation and fragmentation telemetry implementation
+ *
+ * The hooks run inside every heap_caps_malloc()/free(), possibly with the
+ * flash cache disabled, so they live in IRAM, never allocate or log, and
+ * only touch atomics. Each task claims a counter slot on its first
+ * allocation by CAS on the slot's owner; slots are never released, which is
+ * fine because application tasks are static and never deleted.
+ */
+
+#include "heap_monitor.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "HEAP_MON";
+
+#define HEAP_MONITOR_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+typedef struct {
+    atomic_uintptr_t task;          // Owning TaskHandle_t, 0 if free
+    atomic_uint_fast32_t allocs;
+    atomic_uint_fast32_t frees;
+    atomic_uint_fast32_t alloc_bytes;
+} task_slot_t;
+
+static task_slot_t s_slots[HEAP_MONITOR_MAX_TASKS];
+static atomic_uint_fast32_t s_allocs = 0;
+static atomic_uint_fast32_t s_frees = 0;
+static atomic_uint_fast32_t s_untracked = 0;
+static atomic_uint_fast32_t s_violations = 0;
+static atomic_uintptr_t s_last_violator = 0;
+
+static atomic_uintptr_t s_guarded[HEAP_MONITOR_MAX_GUARDED];
+static atomic_uint_fast32_t s_guarded_count = 0;
+
+/* Sampling state (sampling task only) */
+static uint32_t s_min_largest_block = UINT32_MAX;
+static uint32_t s_last_allocs = 0;
+static int64_t s_last_sample_us = 0;
+static uint32_t s_reported_violations = 0;
+
+/* =============================================================================
+ * HOOKS (every allocation)
+ * ===========================================================================*/
+
+static IRAM_ATTR task_slot_t *slot_for(TaskHandle_t task, bool claim)
+{
+    uintptr_t key = (uintptr_t)task;
+
+    for (int i = 0; i < HEAP_MONITOR_MAX_TASKS; i++) {
+        uintptr_t owner = atomic_load_explicit(&s_slots[i].task, memory_order_acquire);
+        if (owner == key) {
+            return &s_slots[i];
+        }
+        if (owner == 0) {
+            if (!claim) {
+                return NULL;
+            }
+            uintptr_t expected = 0;
+            if (atomic_compare_exchange_strong_explicit(&s_slots[i].task, &expected, key,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire) ||
+                expected == key) {
+                return &s_slots[i];
+            }
+            // Another task took this slot first; keep looking
+        }
+    }
+    return NULL;
+}
+
+#if CONFIG_HEAP_USE_HOOKS
+
+static IRAM_ATTR bool is_guarded(TaskHandle_t task)
+{
+    uint32_t count = atomic_load_explicit(&s_guarded_count, memory_order_acquire);
+    if (count > HEAP_MONITOR_MAX_GUARDED) {
+        count = HEAP_MONITOR_MAX_GUARDED;
+    }
+    // A slot reserved but not yet written reads 0 and matches no task
+    for (uint32_t i = 0; i < count; i++) {
+        if (atomic_load_explicit(&s_guarded[i], memory_order_relaxed) == (uintptr_t)task) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+
+    // Allocations before the scheduler starts or from ISRs have no task
+    TaskHandle_t task = xPortInIsrContext() ? NULL : xTaskGetCurrentTaskHandle();
+    if (task == NULL) {
+        return;
+    }
+
+    if (is_guarded(task)) {
+        atomic_fetch_add_explicit(&s_violations, 1, memory_order_relaxed);
+        atomic_store_explicit(&s_last_violator, (uintptr_t)task, memory_order_relaxed);
+#if HEAP_MONITOR_ASSERT_NO_ALLOC
+        esp_rom_printf("HEAP_MON: %s allocated %u bytes after startup\n",
+                       pcTaskGetName(task), (unsigned)size);
+        abort();
+#endif
+    }
+
+    task_slot_t *slot = slot_for(task, true);
+    if (slot == NULL) {
+        atomic_fetch_add_explicit(&s_untracked, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&slot->allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->alloc_bytes, size, memory_order_relaxed);
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    atomic_fetch_add_explicit(&s_frees, 1, memory_order_relaxed);
+
+    TaskHandle_t task = xPortInIsrContext() ? NULL : xTaskGetCurrentTaskHandle();
+    if (task == NULL) {
+        return;
+    }
+    task_slot_t *slot = slot_for(task, true);
+    if (slot != NULL) {
+        atomic_fetch_add_explicit(&slot->frees, 1, memory_order_relaxed);
+    }
+}
+
+#endif // CONFIG_HEAP_USE_HOOKS
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t heap_monitor_init(void)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    s_last_allocs = atomic_load_explicit(&s_allocs, memory_order_relaxed);
+    s_last_sample_us = esp_timer_get_time();
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "CONFIG_HEAP_USE_HOOKS is off, allocation counts disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t heap_monitor_forbid_alloc(void)
+{
+    uint32_t idx = atomic_fetch_add_explicit(&s_guarded_count, 1, memory_order_acq_rel);
+    if (idx >= HEAP_MONITOR_MAX_GUARDED) {
+        ESP_LOGE(TAG, "Too many guarded tasks, %s not guarded", pcTaskGetName(NULL));
+        return ESP_ERR_NO_MEM;
+    }
+    atomic_store_explicit(&s_guarded[idx], (uintptr_t)xTaskGetCurrentTaskHandle(),
+                          memory_order_release);
+    ESP_LOGI(TAG, "%s: startup done, further allocations are %s", pcTaskGetName(NULL),
+             HEAP_MONITOR_ASSERT_NO_ALLOC ? "fatal" : "counted");
+    return ESP_OK;
+}
+
+void heap_monitor_task_counts(TaskHandle_t task, heap_monitor_task_counts_t *counts)
+{
+    memset(counts, 0, sizeof(*counts));
+
+    task_slot_t *slot = slot_for(task, false);
+    if (slot != NULL) {
+        counts->allocs = atomic_load_explicit(&slot->allocs, memory_order_relaxed);
+        counts->frees = atomic_load_explicit(&slot->frees, memory_order_relaxed);
+        counts->alloc_bytes = atomic_load_explicit(&slot->alloc_bytes, memory_order_relaxed);
+    }
+}
+
+void heap_monitor_sample(heap_monitor_stats_t *stats)
+{
+    int64_t now = esp_timer_get_time();
+
+    memset(stats, 0, sizeof(*stats));
+    stats->free_bytes = heap_caps_get_free_size(HEAP_MONITOR_CAPS);
+    stats->min_free_bytes = heap_caps_get_minimum_free_size(HEAP_MONITOR_CAPS);
+    stats->largest_block = heap_caps_get_largest_free_block(HEAP_MONITOR_CAPS);
+    if (stats->largest_block < s_min_largest_block) {
+        s_min_largest_block = stats->largest_block;
+    }
+    stats->min_largest_block = s_min_largest_block;
+    if (stats->free_bytes > 0) {
+        stats->fragmentation_pct =
+            100.0f - (float)stats->largest_block * 100.0f / (float)stats->free_bytes;
+    }
+
+    stats->allocs = atomic_load_explicit(&s_allocs, memory_order_relaxed);
+    stats->frees = atomic_load_explicit(&s_frees, memory_order_relaxed);
+    if (s_last_sample_us > 0 && now > s_last_sample_us) {
+        stats->alloc_rate = (float)(stats->allocs - s_last_allocs) * 1e6f /
+                            (float)(now - s_last_sample_us);
+    }
+    s_last_allocs = stats->allocs;
+    s_last_sample_us = now;
+
+    stats->guard_violations = atomic_load_explicit(&s_violations, memory_order_relaxed);
+    stats->untracked_allocs = atomic_load_explicit(&s_untracked, memory_order_relaxed);
+
+    if (stats->guard_violations != s_reported_violations) {
+        TaskHandle_t task = (TaskHandle_t)atomic_load_explicit(&s_last_violator,
+                                                               memory_order_relaxed);
+        ESP_LOGE(TAG, "%lu allocations by guarded tasks after startup (last: %s)",
+                 (unsigned long)(stats->guard_violations - s_reported_violations),
+                 task ? pcTaskGetName(task) : "?");
+        s_reported_violations = stats->guard_violations;
+    }
+    if (stats->largest_block < HEAP_MONITOR_LARGEST_BLOCK_WARN_BYTES) {
+        ESP_LOGW(TAG, "Largest free block only %lu bytes (%lu free, %.0f%% fragmented)",
+                 (unsigned long)stats->largest_block, (unsigned long)stats->free_bytes,
+                 stats->fragmentation_pct);
+    }
+}
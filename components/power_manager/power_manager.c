@@ -0,0 +1,236 @@
+/**
+ * @file power_manager.c
+ * @brief Idle-time power management implementation
+ *
+ * Active mode holds two esp_pm locks: CPU_FREQ_MAX (no DFS) and
+ * NO_LIGHT_SLEEP. Idle mode releases both, so the PM driver scales the CPU
+ * down and the tickless idle hook light-sleeps whenever every task is
+ * blocked.
+ *
+ * Mode switches come from several tasks (control task timeout, encoder and
+ * network activity), so each switch - flag, encoder wake-up GPIOs and PM
+ * locks - runs whole under s_mode_mutex; otherwise a concurrent enter and
+ * leave could leave active mode with the button interrupt still masked.
+ * s_lock only guards the flag and statistics (esp_pm takes its own lock).
+ */
+
+#include "power_manager.h"
+#include "config.h"
+#include "system_state.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "POWER";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static StaticSemaphore_t s_mode_mutex_buf;
+static SemaphoreHandle_t s_mode_mutex = NULL;
+static power_stats_t s_stats = {0};
+static bool s_idle = false;
+static int64_t s_last_activity_us = 0;            // Under s_lock (64-bit)
+static int64_t s_idle_since_us = 0;
+static int64_t s_response_pending_since_us = 0;   // 0 if no measurement pending
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_cpu_lock = NULL;
+static esp_pm_lock_handle_t s_awake_lock = NULL;
+#endif
+
+/* =============================================================================
+ * MODE SWITCHING
+ * ===========================================================================*/
+
+static void enable_encoder_wakeup(bool enable)
+{
+#if CONFIG_PM_ENABLE
+    if (enable) {
+        // Level wake-up only: wake when a pin leaves its resting level. The
+        // button's edge interrupt is masked meanwhile, a level interrupt
+        // would fire for as long as the button is held.
+        gpio_intr_disable(PIN_ENCODER_SW);
+        gpio_wakeup_enable(PIN_ENCODER_SW, GPIO_INTR_LOW_LEVEL);
+        gpio_wakeup_enable(PIN_ENCODER_CLK, gpio_get_level(PIN_ENCODER_CLK) ?
+                           GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    } else {
+        gpio_wakeup_disable(PIN_ENCODER_SW);
+        gpio_wakeup_disable(PIN_ENCODER_CLK);
+        // Back to the safety system's any-edge press interrupt
+        gpio_set_intr_type(PIN_ENCODER_SW, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(PIN_ENCODER_SW);
+    }
+#endif
+}
+
+static void enter_idle(int64_t now)
+{
+    xSemaphoreTake(s_mode_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&s_lock);
+    // Re-check: activity may have been reported since the caller looked
+    if (s_idle || now - s_last_activity_us < (int64_t)POWER_IDLE_TIMEOUT_MS * 1000) {
+        portEXIT_CRITICAL(&s_lock);
+        xSemaphoreGive(s_mode_mutex);
+        return;
+    }
+    s_idle = true;
+    s_idle_since_us = now;
+    s_stats.idle = true;
+    s_stats.idle_entries++;
+    portEXIT_CRITICAL(&s_lock);
+
+    enable_encoder_wakeup(true);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(s_awake_lock);
+    esp_pm_lock_release(s_cpu_lock);
+#endif
+    xSemaphoreGive(s_mode_mutex);
+    ESP_LOGI(TAG, "Idle mode (DFS %d MHz, light sleep)", POWER_IDLE_CPU_FREQ_MHZ);
+}
+
+static void leave_idle(power_wake_source_t source, int64_t now)
+{
+    xSemaphoreTake(s_mode_mutex, portMAX_DELAY);
+    portENTER_CRITICAL(&s_lock);
+    if (!s_idle) {
+        portEXIT_CRITICAL(&s_lock);
+        xSemaphoreGive(s_mode_mutex);
+        return;
+    }
+    s_idle = false;
+    s_stats.idle = false;
+    s_stats.idle_time_ms += (uint32_t)((now - s_idle_since_us) / 1000);
+    s_stats.wakes[source]++;
+    s_response_pending_since_us = now;
+    portEXIT_CRITICAL(&s_lock);
+
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(s_cpu_lock);
+    esp_pm_lock_acquire(s_awake_lock);
+#endif
+    enable_encoder_wakeup(false);
+    xSemaphoreGive(s_mode_mutex);
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t power_manager_init(void)
+{
+    s_mode_mutex = xSemaphoreCreateMutexStatic(&s_mode_mutex_buf);
+    s_last_activity_us = esp_timer_get_time();
+
+#if CONFIG_PM_ENABLE
+    esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "active_cpu", &s_cpu_lock);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "active_awake", &s_awake_lock);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create PM locks: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // Active mode until the first idle timeout
+    esp_pm_lock_acquire(s_cpu_lock);
+    esp_pm_lock_acquire(s_awake_lock);
+
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_IDLE_CPU_FREQ_MHZ,
+        .light_sleep_enable = true,
+    };
+    ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_sleep_enable_gpio_wakeup();
+    ESP_LOGI(TAG, "Power management ready (%d-%d MHz, idle after %d ms)",
+             POWER_IDLE_CPU_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, POWER_IDLE_TIMEOUT_MS);
+    return ESP_OK;
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is off, idle mode only lowers task rates");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void power_manager_activity(power_wake_source_t source)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    s_last_activity_us = now;
+    portEXIT_CRITICAL(&s_lock);
+    leave_idle(source, now);
+}
+
+void power_manager_update(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (g_system_state.state != STATE_IDLE) {
+        power_manager_activity(POWER_WAKE_STATE);
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    bool due = !s_idle && now - s_last_activity_us >= (int64_t)POWER_IDLE_TIMEOUT_MS * 1000;
+    portEXIT_CRITICAL(&s_lock);
+    if (due) {
+        enter_idle(now);
+    }
+}
+
+bool power_manager_is_idle(void)
+{
+    return s_idle;
+}
+
+void power_manager_stay_awake_begin(void)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(s_awake_lock);
+#endif
+}
+
+void power_manager_stay_awake_end(void)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(s_awake_lock);
+#endif
+}
+
+void power_manager_display_tick(uint32_t lateness_us)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_idle) {
+        if (lateness_us > s_stats.max_tick_lateness_us) {
+            s_stats.max_tick_lateness_us = lateness_us;
+        }
+    } else if (s_response_pending_since_us != 0) {
+        uint32_t response_us = (uint32_t)(now - s_response_pending_since_us);
+        s_stats.last_response_us = response_us;
+        if (response_us > s_stats.max_response_us) {
+            s_stats.max_response_us = response_us;
+        }
+        s_response_pending_since_us = 0;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void power_manager_get_stats(power_stats_t *stats)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    if (s_idle) {
+        stats->idle_time_ms += (uint32_t)((now - s_idle_since_us) / 1000);
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -7,15 +7,24 @@
  * - PID controller with anti-windup
  * - Relay auto-tuning (Ziegler-Nichols method)
  * - NVS storage for PID parameters
+ * - ITV feedback timing: edge ISR, step latency, air supply check and the
+ *   dead time that gates PID integration
  */
 
 #include "pressure_controller.h"
 #include "config.h"
 #include "system_state.h"
+#include "blog.h"
+#include "state_transition.h"
+#include "estop.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "driver/dac.h"
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include <math.h>
@@ -65,12 +74,121 @@ typedef struct {
 
 } autotune_state_t;
 
+typedef struct {
+    bool on;                       // Switch level at the last edge
+    int64_t on_since_us;           // Rising edge, 0 while off
+    bool pending;                  // Upward step waiting for the switch
+    bool left_band;                // Switch was off at some time during the step
+    int64_t step_us;               // DAC write that started (or restarted) the step
+    uint8_t step_value;            // DAC value of that write
+    uint8_t ref_value;             // Rises are measured from here
+    itv_stats_t stats;
+} itv_monitor_t;
+
 static pid_state_t s_pid = {0};
 static autotune_state_t s_autotune = {0};
+static int16_t s_dac_value = -1;   // Last value written to the DAC, -1 = unknown
+
+/* Shared with the feedback ISR under s_itv_lock */
+static portMUX_TYPE s_itv_lock = portMUX_INITIALIZER_UNLOCKED;
+static itv_monitor_t s_itv = {0};
+
+#define ITV_STEP_MIN_DAC ((int)(ITV_STEP_MIN_PCT / 100.0f * DAC_MAX_VALUE))
 
 /* External global state */
 extern system_state_t g_system_state;
 
+/* =============================================================================
+ * ITV FEEDBACK TIMING
+ * ===========================================================================*/
+
+/**
+ * @brief Close the pending step with the switch on (s_itv_lock held)
+ */
+static void IRAM_ATTR itv_step_reached(int64_t now_us)
+{
+    uint32_t response_us = (uint32_t)(now_us - s_itv.step_us);
+    itv_stats_t *st = &s_itv.stats;
+
+    st->reached++;
+    st->last_response_us = response_us;
+    if (response_us > st->max_response_us) {
+        st->max_response_us = response_us;
+    }
+    if (st->dead_time_us == 0) {
+        st->dead_time_us = response_us;
+    } else {
+        int32_t delta = (int32_t)response_us - (int32_t)st->dead_time_us;
+        st->dead_time_us = (uint32_t)((int32_t)st->dead_time_us + delta / (1 << ITV_DEAD_TIME_EWMA_SHIFT));
+    }
+    st->slow_streak = (response_us > ITV_RESPONSE_SLOW_MS * 1000U) ? st->slow_streak + 1 : 0;
+
+    s_itv.pending = false;
+    s_itv.ref_value = s_itv.step_value;
+}
+
+/**
+ * @brief Feedback switch edge ISR: timestamp it, end a pending step on the rising edge
+ */
+static void IRAM_ATTR itv_feedback_isr(void *arg)
+{
+    int64_t now_us = esp_timer_get_time();
+    bool on = (gpio_ll_get_level(&GPIO, PIN_ITV_FEEDBACK) == 1);
+
+    portENTER_CRITICAL_ISR(&s_itv_lock);
+    if (on && !s_itv.on) {
+        s_itv.on_since_us = now_us;
+        if (s_itv.pending) {
+            itv_step_reached(now_us);
+        }
+    } else if (!on) {
+        s_itv.on_since_us = 0;
+        s_itv.left_band = true;
+    }
+    s_itv.on = on;
+    portEXIT_CRITICAL_ISR(&s_itv_lock);
+}
+
+/**
+ * @brief Start, restart or drop a measured step after a DAC write
+ *
+ * A rise of ITV_STEP_MIN_DAC over the reference starts a step; a further
+ * rise of that size restarts its clock (a ramp is timed from its last
+ * large increment). Lower writes move the reference down, 0 ends the step.
+ */
+static void itv_track_write(uint8_t dac_value)
+{
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_itv_lock);
+    if (dac_value == 0) {
+        s_itv.pending = false;
+        s_itv.ref_value = 0;
+    } else if (dac_value < s_itv.ref_value) {
+        s_itv.ref_value = dac_value;
+    } else if (dac_value >= (s_itv.pending ? s_itv.step_value : s_itv.ref_value) + ITV_STEP_MIN_DAC) {
+        if (!s_itv.pending) {
+            s_itv.stats.steps++;
+            s_itv.left_band = !s_itv.on;
+        }
+        s_itv.pending = true;
+        s_itv.step_us = now_us;
+        s_itv.step_value = dac_value;
+    }
+    portEXIT_CRITICAL(&s_itv_lock);
+}
+
+/**
+ * @brief Whether the integral should hold: a step is younger than the measured dead time
+ */
+static bool itv_in_dead_time(int64_t now_us)
+{
+    portENTER_CRITICAL(&s_itv_lock);
+    bool hold = s_itv.pending && now_us - s_itv.step_us < (int64_t)s_itv.stats.dead_time_us;
+    portEXIT_CRITICAL(&s_itv_lock);
+    return hold;
+}
+
 /* =============================================================================
  * DAC CONTROL FUNCTIONS
  * ===========================================================================*/
@@ -82,6 +200,9 @@ extern system_state_t g_system_state;
  */
 static esp_err_t set_dac_output(float percent)
 {
+    // A latched e-stop overrides every caller (autotune, zones, PID)
+    if (estop_active()) percent = 0.0f;
+
     // Clamp to valid range
     if (percent < 0.0f) percent = 0.0f;
     if (percent > 100.0f) percent = 100.0f;
@@ -90,11 +211,30 @@ static esp_err_t set_dac_output(float percent)
     // DAC output: 0-3.3V, op-amp gain = 3.0, so output = 0-9.9V (close to 0-10V)
     uint8_t dac_value = (uint8_t)((percent / 100.0f) * DAC_MAX_VALUE);
 
+    // The DAC holds its level: skip the register write if nothing changed
+    // (the control loop rewrites 0% every tick while idle)
+    if (dac_value == s_dac_value) {
+        s_pid.output_percent = percent;
+        return ESP_OK;
+    }
+
     // Set DAC output on GPIO25 (DAC channel 1)
     esp_err_t ret = dac_output_voltage(DAC_CHANNEL_1, dac_value);
 
+    // A trip between the check above and the write: the ISR's zero may
+    // have been overwritten, so zero again rather than wait a tick
+    if (dac_value != 0 && estop_active()) {
+        percent = 0.0f;
+        dac_value = 0;
+        ret = dac_output_voltage(DAC_CHANNEL_1, 0);
+    }
+
     if (ret == ESP_OK) {
         s_pid.output_percent = percent;
+        s_dac_value = dac_value;
+        itv_track_write(dac_value);
+    } else {
+        s_dac_value = -1;
     }
 
     return ret;
@@ -212,7 +352,7 @@ void pressure_controller_reset_pid(void)
     s_pid.prev_measurement = 0.0f;
     s_pid.last_time_us = esp_timer_get_time();
 
-    ESP_LOGI(TAG, "PID controller reset");
+    BLOG0(BLOG_PID_RESET);
 }
 
 float pressure_controller_compute_pid(float setpoint, float measurement)
@@ -233,8 +373,11 @@ float pressure_controller_compute_pid(float setpoint, float measurement)
     // Proportional term
     float p_term = s_pid.kp * error;
 
-    // Integral term with anti-windup
-    s_pid.integral += error * dt;
+    // Integral term with anti-windup; no integration while the last step is
+    // still inside the ITV dead time (the process cannot have responded yet)
+    if (!itv_in_dead_time((int64_t)now_us)) {
+        s_pid.integral += error * dt;
+    }
 
     // Clamp integral to prevent windup
     if (s_pid.integral > PID_INTEGRAL_MAX) {
@@ -344,9 +487,9 @@ static bool detect_peak(float current_weight)
             s_autotune.peak_count++;
             is_peak = true;
 
-            ESP_LOGI(TAG, "Peak %d detected: %.2f lbs at %.2f sec",
-                     s_autotune.peak_count, s_autotune.last_weight,
-                     s_autotune.peak_times[s_autotune.peak_count - 1]);
+            BLOG3(BLOG_AUTOTUNE_PEAK,
+                  s_autotune.peak_count, s_autotune.last_weight,
+                  s_autotune.peak_times[s_autotune.peak_count - 1]);
         }
     }
 
@@ -422,7 +565,7 @@ esp_err_t pressure_controller_run_autotune(float current_weight)
         ESP_LOGE(TAG, "Auto-tune timeout");
         s_autotune.active = false;
         g_system_state.autotune_state = AUTOTUNE_TIMEOUT;
-        g_system_state.error = ERROR_AUTOTUNE_TIMEOUT;
+        state_set_error(ERROR_AUTOTUNE_TIMEOUT);
         set_dac_output(0.0f);
         return ESP_FAIL;
     }
@@ -502,17 +645,27 @@ esp_err_t pressure_controller_init(void)
         ESP_LOGE(TAG, "Failed to enable DAC: %s", esp_err_to_name(ret));
         return ret;
     }
+    s_dac_value = -1;   // Force the first write
 
-    // Configure ITV feedback GPIO (GPIO26)
+    // Configure ITV feedback GPIO (GPIO26), both edges timestamped
     gpio_config_t feedback_cfg = {
         .pin_bit_mask = (1ULL << PIN_ITV_FEEDBACK),
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+        .intr_type = GPIO_INTR_ANYEDGE
     };
 
     ret = gpio_config(&feedback_cfg);
+
+    // GPIO ISR service: installed once by app_main()
+    if (ret == ESP_OK) {
+        portENTER_CRITICAL(&s_itv_lock);
+        s_itv.on = (gpio_get_level(PIN_ITV_FEEDBACK) == 1);
+        s_itv.on_since_us = s_itv.on ? esp_timer_get_time() : 0;
+        portEXIT_CRITICAL(&s_itv_lock);
+        ret = gpio_isr_handler_add(PIN_ITV_FEEDBACK, itv_feedback_isr, NULL);
+    }
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure feedback GPIO: %s", esp_err_to_name(ret));
         return ret;
@@ -558,6 +711,67 @@ bool pressure_controller_get_feedback(void)
     return (gpio_get_level(PIN_ITV_FEEDBACK) == 1);
 }
 
+int64_t pressure_controller_feedback_on_since_us(void)
+{
+    portENTER_CRITICAL(&s_itv_lock);
+    int64_t since_us = s_itv.on_since_us;
+    portEXIT_CRITICAL(&s_itv_lock);
+    return since_us;
+}
+
+esp_err_t pressure_controller_check_air(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    uint32_t step_pct = 0;
+    uint32_t response_us = 0;
+
+    portENTER_CRITICAL(&s_itv_lock);
+    if (s_itv.pending && now_us - s_itv.step_us >= (int64_t)ITV_RESPONSE_TIMEOUT_MS * 1000) {
+        s_itv.pending = false;
+        s_itv.ref_value = s_itv.step_value;
+        if (s_itv.on && !s_itv.left_band) {
+            s_itv.stats.in_band++;
+        } else {
+            s_itv.stats.missed++;
+            step_pct = s_itv.step_value * 100U / DAC_MAX_VALUE;
+            ret = ESP_ERR_TIMEOUT;
+        }
+    }
+    if (ret == ESP_OK && s_itv.stats.slow_streak >= ITV_SLOW_STREAK_FAULT) {
+        s_itv.stats.slow_streak = 0;
+        response_us = s_itv.stats.last_response_us;
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    if (ret != ESP_OK) {
+        s_itv.stats.faults++;
+    }
+    portEXIT_CRITICAL(&s_itv_lock);
+
+    if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGE(TAG, "ITV did not reach %lu%% within %d ms: no air supply?",
+                 (unsigned long)step_pct, ITV_RESPONSE_TIMEOUT_MS);
+    } else if (ret == ESP_ERR_INVALID_RESPONSE) {
+        ESP_LOGE(TAG, "ITV response degraded: %d in a row over %d ms (last %lu ms)",
+                 ITV_SLOW_STREAK_FAULT, ITV_RESPONSE_SLOW_MS, (unsigned long)(response_us / 1000));
+    }
+    return ret;
+}
+
+void pressure_controller_itv_new_sequence(void)
+{
+    portENTER_CRITICAL(&s_itv_lock);
+    s_itv.stats.slow_streak = 0;
+    portEXIT_CRITICAL(&s_itv_lock);
+}
+
+void pressure_controller_get_itv_stats(itv_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_itv_lock);
+    *stats = s_itv.stats;
+    portEXIT_CRITICAL(&s_itv_lock);
+}
+
 /* =============================================================================
  * HYBRID ZONE/PID CONTROL
  * ===========================================================================*/
@@ -623,8 +837,10 @@ esp_err_t pressure_controller_set_hybrid(float zone_setpoint, float current_pres
     // Proportional term
     float p_term = temp_kp * error;
 
-    // Integral term with anti-windup
-    s_pid.integral += error * dt;
+    // Integral term with anti-windup, held during the ITV dead time
+    if (!itv_in_dead_time((int64_t)now_us)) {
+        s_pid.integral += error * dt;
+    }
 
     // Clamp integral based on zone range
     float zone_range = get_zone_pid_range(zone);
@@ -1,16 +1,38 @@
 /**
  * @file safety_system.c
- * @brief 4-stage safety interlock system implementation
+ * @brief Table-driven safety checklist implementation
  *
- * Implements non-blocking state machine for safety checks using LCD prompts
- * and rotary encoder button confirmation.
+ * Implements a non-blocking state machine over the checklist table, with
+ * LCD prompts, rotary encoder button confirmation and ITV feedback steps.
+ * The table is owned by the display task while a sequence runs: a new one
+ * from safety_set_checklist() is kept in s_config (under s_config_lock)
+ * and copied in by safety_begin().
+ *
+ * The button is interrupt driven: any edge on PIN_ENCODER_SW (re)starts a
+ * one-shot gptimer, and when the line has been quiet for SAFETY_DEBOUNCE_MS
+ * the timer ISR samples the level. A new press is posted with the time of
+ * its first edge to s_press_queue, which safety_run_checks() consumes. Both
+ * ISRs are in IRAM and only touch DRAM state, gptimer control functions
+ * (CONFIG_GPTIMER_CTRL_FUNC_IN_IRAM) and the queue. The timer is enabled
+ * between safety_begin() and safety_end() only: an enabled gptimer holds a
+ * PM lock and would keep the chip out of light sleep.
  */
 
 #include "safety_system.h"
 #include "config.h"
+#include "state_transition.h"
+#include "pressure_controller.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_attr.h"
 #include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "hal/gpio_ll.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "nvs.h"
+#include <stdio.h>
 #include <string.h>
 
 static const char *TAG = "SAFETY";
@@ -21,17 +43,46 @@ static const char *TAG = "SAFETY";
 
 typedef struct {
     uint64_t check_start_time_us;  // Start time of current check (microseconds)
-    bool button_last_state;         // Previous button state for edge detection
-    bool waiting_for_release;       // Waiting for button release before next press
+    int64_t sequence_start_us;      // safety_begin() time
+    int64_t itv_since_us;           // ITV feedback on at the pre-charge since (0 = off)
+    bool repeat_drum;               // Only SAFETY_SCOPE_DRUM steps this sequence
 } safety_internal_t;
 
 static safety_internal_t s_safety = {0};
+static volatile bool s_ready = false;   // safety_init() succeeded: fills may start
+
+/* Table of the running sequence (display task) and the latest configured one */
+static safety_checklist_t s_checklist;
+static safety_checklist_t s_config;
+static portMUX_TYPE s_config_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Debounced button presses, posted by the debounce timer ISR */
+typedef struct {
+    int64_t edge_us;                // First edge of the press (esp_timer time)
+} button_press_t;
+
+static StaticQueue_t s_press_queue_buf;
+static uint8_t s_press_queue_storage[SAFETY_PRESS_QUEUE_LEN * sizeof(button_press_t)];
+static QueueHandle_t s_press_queue = NULL;
+
+static gptimer_handle_t s_debounce_timer = NULL;
+static portMUX_TYPE s_button_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Shared with the ISRs (under s_button_lock) */
+static struct {
+    bool armed;                     // Timer enabled, edges are debounced
+    bool settling;                  // Debounce timer running
+    bool down;                      // Debounced level (true = pressed)
+    int64_t edge_us;                // First edge since the line was last stable
+} s_button = {0};
+
+static safety_stats_t s_stats = {0};
 
 /* External global state */
 extern system_state_t g_system_state;
 
 /* =============================================================================
- * SAFETY CHECK PROMPTS
+ * CHECKLIST
  * ===========================================================================*/
 
 typedef struct {
@@ -39,64 +90,298 @@ typedef struct {
     const char *line2;
 } safety_prompt_t;
 
+/* Prompts outside the checklist steps */
 static const safety_prompt_t s_prompts[] = {
     [SAFETY_IDLE] = {"Ready", "Press to start"},
-    [SAFETY_AIR_CHECK] = {"SAFETY CHECK 1/4", "Air line OK?"},
-    [SAFETY_HOSE_CHECK] = {"SAFETY CHECK 2/4", "Fill hose OK?"},
-    [SAFETY_POSITION_CHECK] = {"SAFETY CHECK 3/4", "Tank position?"},
-    [SAFETY_START_CHECK] = {"SAFETY CHECK 4/4", "Ready to fill?"},
     [SAFETY_COMPLETE] = {"Safety Complete", "Starting fill..."},
     [SAFETY_TIMEOUT] = {"SAFETY TIMEOUT", "Sequence abort"},
     [SAFETY_CANCELLED] = {"CANCELLED", "Safety aborted"}
 };
 
+/* Built-in checklist, used until a site stores its own */
+static const safety_checklist_t s_default_checklist = {
+    .version = SAFETY_CHECKLIST_VERSION,
+    .count = 4,
+    .steps = {
+        {"Air line OK?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Fill hose OK?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Tank position?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_DRUM, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Ready to fill?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+    },
+};
+
+static const char *const s_confirm_names[SAFETY_CONFIRM_COUNT] = {
+    [SAFETY_CONFIRM_BUTTON] = "button",
+    [SAFETY_CONFIRM_ITV_FEEDBACK] = "itv",
+};
+
+static const char *const s_scope_names[SAFETY_SCOPE_COUNT] = {
+    [SAFETY_SCOPE_DRUM] = "drum",
+    [SAFETY_SCOPE_BATCH] = "batch",
+};
+
+/**
+ * @brief Check a table before it is used or stored
+ *
+ * Later drums of a batch job may run no step at all (continuous filling),
+ * but single fills and the first drum of a job need an operator.
+ *
+ * @return true if every step is usable and at least one is a button step
+ */
+static bool checklist_valid(const safety_checklist_t *checklist)
+{
+    if (checklist->version != SAFETY_CHECKLIST_VERSION ||
+        checklist->count == 0 || checklist->count > SAFETY_MAX_STEPS) {
+        return false;
+    }
+
+    bool operator_confirms = false;
+    for (int i = 0; i < checklist->count; i++) {
+        const safety_step_t *step = &checklist->steps[i];
+        if (step->prompt[0] == '\0' || memchr(step->prompt, '\0', sizeof(step->prompt)) == NULL ||
+            step->confirm >= SAFETY_CONFIRM_COUNT || step->scope >= SAFETY_SCOPE_COUNT ||
+            step->timeout_ms < SAFETY_STEP_TIMEOUT_MIN_MS || step->timeout_ms > SAFETY_STEP_TIMEOUT_MAX_MS) {
+            return false;
+        }
+        // The ITV only reports pressure while it is pre-charged
+        if (step->confirm == SAFETY_CONFIRM_ITV_FEEDBACK && !PRECHARGE_ENABLE) {
+            return false;
+        }
+        if (step->confirm == SAFETY_CONFIRM_BUTTON) {
+            operator_confirms = true;
+        }
+    }
+    return operator_confirms;
+}
+
+/**
+ * @brief Load the site's checklist from NVS into s_config (defaults otherwise)
+ */
+static void checklist_load(void)
+{
+    nvs_handle_t nvs_handle;
+    safety_checklist_t stored;
+    size_t size = sizeof(stored);
+
+    s_config = s_default_checklist;
+
+    esp_err_t ret = nvs_open(NVS_SAFETY_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "No stored checklist, using the built-in one");
+        return;
+    }
+    ret = nvs_get_blob(nvs_handle, NVS_KEY_SAFETY, &stored, &size);
+    nvs_close(nvs_handle);
+
+    if (ret != ESP_OK || size != sizeof(stored) || !checklist_valid(&stored)) {
+        ESP_LOGW(TAG, "Stored checklist unusable (%s), using the built-in one", esp_err_to_name(ret));
+        return;
+    }
+    s_config = stored;
+    ESP_LOGI(TAG, "Loaded site checklist (%u steps)", stored.count);
+}
+
+/**
+ * @brief Whether step i runs in this sequence
+ */
+static bool step_selected(int i)
+{
+    return i < s_checklist.count &&
+           (!s_safety.repeat_drum || s_checklist.steps[i].scope == SAFETY_SCOPE_DRUM);
+}
+
+/**
+ * @brief Checklist step shown in a safety state
+ * @return Index into s_checklist.steps, or -1 outside the steps
+ */
+static int step_index(safety_state_t state)
+{
+    int index = (int)state - SAFETY_STEP_1;
+    return (index >= 0 && index < s_checklist.count) ? index : -1;
+}
+
 /* =============================================================================
  * HELPER FUNCTIONS
  * ===========================================================================*/
 
 /**
- * @brief Read current encoder button state
- * @return true if button is pressed (active LOW on GPIO34)
+ * @brief Button edge ISR: restart the quiet period of the debounce timer
+ */
+static void IRAM_ATTR button_edge_isr(void *arg)
+{
+    portENTER_CRITICAL_ISR(&s_button_lock);
+    if (s_button.armed) {
+        gptimer_set_raw_count(s_debounce_timer, 0);
+        if (!s_button.settling) {
+            s_button.settling = true;
+            s_button.edge_us = esp_timer_get_time();
+            gptimer_start(s_debounce_timer);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&s_button_lock);
+}
+
+/**
+ * @brief Debounce timer ISR: the line has been quiet, take its level
  */
-static bool read_button_state(void)
+static bool IRAM_ATTR debounce_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                        void *user_ctx)
 {
+    BaseType_t woken = pdFALSE;
     // GPIO34 is input-only on ESP32, active LOW when pressed
-    return (gpio_get_level(PIN_ENCODER_SW) == 0);
+    bool down = (gpio_ll_get_level(&GPIO, PIN_ENCODER_SW) == 0);
+
+    portENTER_CRITICAL_ISR(&s_button_lock);
+    gptimer_stop(timer);
+    s_button.settling = false;
+    bool pressed = down && !s_button.down;
+    s_button.down = down;
+    button_press_t press = { .edge_us = s_button.edge_us };
+    portEXIT_CRITICAL_ISR(&s_button_lock);
+
+    // One event per press: the release only re-arms the edge detection
+    if (pressed) {
+        xQueueSendFromISR(s_press_queue, &press, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * @brief Enable or disable press detection (display task)
+ * @param armed Whether presses should be debounced and queued
+ */
+static void button_arm(bool armed)
+{
+    if (s_debounce_timer == NULL || armed == s_button.armed) {
+        return;
+    }
+
+    if (armed) {
+        gptimer_enable(s_debounce_timer);
+        portENTER_CRITICAL(&s_button_lock);
+        s_button.down = (gpio_get_level(PIN_ENCODER_SW) == 0);  // A held button is not a press
+        s_button.settling = false;
+        s_button.armed = true;
+        portEXIT_CRITICAL(&s_button_lock);
+    } else {
+        portENTER_CRITICAL(&s_button_lock);
+        s_button.armed = false;
+        if (s_button.settling) {
+            gptimer_stop(s_debounce_timer);
+            s_button.settling = false;
+        }
+        portEXIT_CRITICAL(&s_button_lock);
+        gptimer_disable(s_debounce_timer);
+    }
+    xQueueReset(s_press_queue);
 }
 
 /**
- * @brief Detect button press event (falling edge with debounce)
- * @return true if button was just pressed
+ * @brief Take a press made while the current stage was shown
+ * @return true if the current check was confirmed
  */
 static bool button_pressed(void)
 {
-    bool current_state = read_button_state();
-    bool pressed = false;
+    button_press_t press;
 
-    // Edge detection: transition from released to pressed
-    if (current_state && !s_safety.button_last_state && !s_safety.waiting_for_release) {
-        pressed = true;
-        s_safety.waiting_for_release = true;  // Wait for release before detecting next press
-        ESP_LOGI(TAG, "Button press detected");
+    while (xQueueReceive(s_press_queue, &press, 0) == pdTRUE) {
+        // A press from before the prompt appeared confirms nothing
+        if (press.edge_us < (int64_t)s_safety.check_start_time_us) {
+            continue;
+        }
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - press.edge_us);
+        portENTER_CRITICAL(&s_button_lock);
+        s_stats.presses++;
+        s_stats.last_latency_us = latency_us;
+        if (latency_us > s_stats.max_latency_us) {
+            s_stats.max_latency_us = latency_us;
+        }
+        portEXIT_CRITICAL(&s_button_lock);
+        ESP_LOGI(TAG, "Button press detected (%lu us after the edge)", (unsigned long)latency_us);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Create the press queue, debounce timer and edge interrupt
+ * @return ESP_OK on success
+ */
+static esp_err_t button_init(void)
+{
+    s_press_queue = xQueueCreateStatic(SAFETY_PRESS_QUEUE_LEN, sizeof(button_press_t),
+                                       s_press_queue_storage, &s_press_queue_buf);
+
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,   // 1 us
+    };
+    esp_err_t ret = gptimer_new_timer(&timer_config, &s_debounce_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create debounce timer: %s", esp_err_to_name(ret));
+        return ret;
     }
 
-    // Reset waiting flag when button is released
-    if (!current_state && s_safety.waiting_for_release) {
-        s_safety.waiting_for_release = false;
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = SAFETY_DEBOUNCE_MS * 1000,
+        .flags.auto_reload_on_alarm = false,    // One shot, restarted by the next edge
+    };
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = debounce_alarm_cb,
+    };
+    ret = gptimer_set_alarm_action(s_debounce_timer, &alarm_config);
+    if (ret == ESP_OK) {
+        ret = gptimer_register_event_callbacks(s_debounce_timer, &callbacks, NULL);
     }
 
-    s_safety.button_last_state = current_state;
-    return pressed;
+    // GPIO ISR service: installed once by app_main()
+    if (ret == ESP_OK) {
+        ret = gpio_isr_handler_add(PIN_ENCODER_SW, button_edge_isr, NULL);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up button interrupt: %s", esp_err_to_name(ret));
+        gptimer_del_timer(s_debounce_timer);
+        s_debounce_timer = NULL;
+    }
+    return ret;
 }
 
 /**
  * @brief Check if current safety check has timed out
+ * @param step Step being shown
  * @return true if timeout occurred
  */
-static bool check_timeout(void)
+static bool check_timeout(const safety_step_t *step)
 {
     uint64_t elapsed_ms = (esp_timer_get_time() - s_safety.check_start_time_us) / 1000;
-    return (elapsed_ms > SAFETY_CHECK_TIMEOUT_MS);
+    return (elapsed_ms > step->timeout_ms);
+}
+
+/**
+ * @brief Whether the ITV confirms air pressure (SAFETY_CONFIRM_ITV_FEEDBACK)
+ *
+ * The switch must be on, with the control task holding the full
+ * pre-charge, for SAFETY_ITV_HOLD_MS: at a 0 % setpoint it reports
+ * nothing about the supply. The hold runs from the later of the switch-on
+ * edge (timestamped by the feedback ISR, so a bounce between two display
+ * ticks restarts it) and the full pre-charge being seen. No response at
+ * all is caught by the control task (pressure_controller_check_air()).
+ */
+static bool itv_confirmed(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    int64_t on_since_us = pressure_controller_feedback_on_since_us();
+
+    if (g_system_state.pressure_setpoint_pct < PRECHARGE_PCT || on_since_us == 0) {
+        s_safety.itv_since_us = 0;
+        return false;
+    }
+    if (s_safety.itv_since_us == 0) {
+        s_safety.itv_since_us = now_us;
+    }
+    int64_t hold_from_us = (on_since_us > s_safety.itv_since_us) ? on_since_us : s_safety.itv_since_us;
+    return now_us - hold_from_us >= (int64_t)SAFETY_ITV_HOLD_MS * 1000;
 }
 
 /**
@@ -105,11 +390,45 @@ static bool check_timeout(void)
  */
 static void start_check_stage(safety_state_t new_state)
 {
-    g_system_state.safety_state = new_state;
-    s_safety.check_start_time_us = esp_timer_get_time();
-    s_safety.waiting_for_release = true;  // Require button release before next confirmation
+    state_set_safety(new_state);
+    s_safety.check_start_time_us = esp_timer_get_time();  // Earlier presses are ignored
+    s_safety.itv_since_us = 0;
+
+    ESP_LOGI(TAG, "Starting safety check stage: %s",
+             s_checklist.steps[new_state - SAFETY_STEP_1].prompt);
+}
+
+/**
+ * @brief Move past a confirmed (or the idle) stage to the next selected step
+ * @param after Stage just finished
+ * @return ESP_OK if no checks are left, ESP_ERR_INVALID_STATE otherwise
+ */
+static esp_err_t advance(safety_state_t after)
+{
+    // Fail closed: no table means no operator confirmation, never a pass
+    if (!s_ready || s_checklist.count == 0) {
+        ESP_LOGE(TAG, "Safety system not initialized, fill refused");
+        state_set_safety(SAFETY_CANCELLED);
+        return ESP_FAIL;
+    }
+
+    int first = (after == SAFETY_IDLE) ? 0 : step_index(after) + 1;
+    for (int i = first; i < s_checklist.count; i++) {
+        if (step_selected(i)) {
+            start_check_stage((safety_state_t)(SAFETY_STEP_1 + i));
+            return ESP_ERR_INVALID_STATE;  // Still in progress
+        }
+    }
 
-    ESP_LOGI(TAG, "Starting safety check stage: %s", s_prompts[new_state].line2);
+    uint32_t sequence_ms = (uint32_t)((esp_timer_get_time() - s_safety.sequence_start_us) / 1000);
+    portENTER_CRITICAL(&s_button_lock);
+    s_stats.sequences++;
+    s_stats.last_sequence_ms = sequence_ms;
+    portEXIT_CRITICAL(&s_button_lock);
+
+    state_set_safety(SAFETY_COMPLETE);
+    ESP_LOGI(TAG, "All safety checks passed in %lu ms", (unsigned long)sequence_ms);
+    return ESP_OK;
 }
 
 /* =============================================================================
@@ -126,7 +445,7 @@ esp_err_t safety_init(void)
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,  // Enable internal pull-up
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+        .intr_type = GPIO_INTR_ANYEDGE     // Press and release restart the debouncer
     };
 
     esp_err_t ret = gpio_config(&button_cfg);
@@ -135,67 +454,97 @@ esp_err_t safety_init(void)
         return ret;
     }
 
+    ret = button_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     // Initialize internal state
     s_safety.check_start_time_us = 0;
-    s_safety.button_last_state = false;
-    s_safety.waiting_for_release = false;
+    checklist_load();
+    s_checklist = s_config;
 
     // Initialize safety state to IDLE
-    g_system_state.safety_state = SAFETY_IDLE;
+    state_set_safety(SAFETY_IDLE);
+    s_ready = (s_checklist.count > 0);
 
     ESP_LOGI(TAG, "Safety system initialized successfully");
     return ESP_OK;
 }
 
-esp_err_t safety_run_checks(void)
+void safety_begin(bool repeat_drum)
 {
-    // Check for timeout on all active check stages
-    if (g_system_state.safety_state >= SAFETY_AIR_CHECK &&
-        g_system_state.safety_state <= SAFETY_START_CHECK) {
-        if (check_timeout()) {
-            ESP_LOGW(TAG, "Safety check timeout at stage %d", g_system_state.safety_state);
-            g_system_state.safety_state = SAFETY_TIMEOUT;
-            g_system_state.error = ERROR_SAFETY_TIMEOUT;
-            return ESP_FAIL;
-        }
+    // Out of the steps before the table changes (the control task reads it)
+    state_set_safety(SAFETY_IDLE);
+    portENTER_CRITICAL(&s_config_lock);
+    s_checklist = s_config;
+    portEXIT_CRITICAL(&s_config_lock);
+
+    s_safety.repeat_drum = repeat_drum;
+    s_safety.check_start_time_us = 0;
+    s_safety.sequence_start_us = esp_timer_get_time();
+    pressure_controller_itv_new_sequence();
+    button_arm(true);  // Presses made before this are dropped
+}
+
+void safety_end(void)
+{
+    button_arm(false);
+}
+
+bool safety_wait_press(uint32_t timeout_ms)
+{
+    button_press_t press;
+
+    if (s_press_queue == NULL) {
+        vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+        return false;
     }
+    return xQueuePeek(s_press_queue, &press, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
 
-    // State machine
-    switch (g_system_state.safety_state) {
-        case SAFETY_IDLE:
-            // Start first check
-            start_check_stage(SAFETY_AIR_CHECK);
-            return ESP_ERR_INVALID_STATE;  // Still in progress
+esp_err_t safety_run_checks(void)
+{
+    safety_state_t state = g_system_state.safety_state;
+    int index = step_index(state);
 
-        case SAFETY_AIR_CHECK:
-            if (button_pressed()) {
-                ESP_LOGI(TAG, "Air line check confirmed");
-                start_check_stage(SAFETY_HOSE_CHECK);
-            }
-            return ESP_ERR_INVALID_STATE;  // Still in progress
+    // A step being shown: confirmed, timed out or still waiting
+    if (index >= 0) {
+        const safety_step_t *step = &s_checklist.steps[index];
 
-        case SAFETY_HOSE_CHECK:
-            if (button_pressed()) {
-                ESP_LOGI(TAG, "Fill hose check confirmed");
-                start_check_stage(SAFETY_POSITION_CHECK);
-            }
-            return ESP_ERR_INVALID_STATE;  // Still in progress
+        if (check_timeout(step)) {
+            ESP_LOGW(TAG, "Safety check timeout at step %d (%s)", index + 1, step->prompt);
+            state_set_safety(SAFETY_TIMEOUT);
+            state_set_error(ERROR_SAFETY_TIMEOUT);
+            return ESP_FAIL;
+        }
 
-        case SAFETY_POSITION_CHECK:
-            if (button_pressed()) {
-                ESP_LOGI(TAG, "Tank position check confirmed");
-                start_check_stage(SAFETY_START_CHECK);
+        if (step->confirm == SAFETY_CONFIRM_ITV_FEEDBACK) {
+            // A press confirms nothing here; left queued it would keep
+            // safety_wait_press() returning at once for the whole step
+            xQueueReset(s_press_queue);
+            if (!itv_confirmed()) {
+                return ESP_ERR_INVALID_STATE;  // Still in progress
             }
-            return ESP_ERR_INVALID_STATE;  // Still in progress
+            portENTER_CRITICAL(&s_button_lock);
+            s_stats.auto_confirms++;
+            portEXIT_CRITICAL(&s_button_lock);
+            ESP_LOGI(TAG, "Verified by ITV feedback: %s", step->prompt);
+            return advance(state);
+        }
 
-        case SAFETY_START_CHECK:
-            if (button_pressed()) {
-                ESP_LOGI(TAG, "Final start confirmation received");
-                g_system_state.safety_state = SAFETY_COMPLETE;
-                ESP_LOGI(TAG, "All safety checks passed!");
-                return ESP_OK;  // All checks complete
-            }
-            return ESP_ERR_INVALID_STATE;  // Still in progress
+        if (button_pressed()) {
+            ESP_LOGI(TAG, "Confirmed: %s", step->prompt);
+            return advance(state);
+        }
+        return ESP_ERR_INVALID_STATE;  // Still in progress
+    }
+
+    // State machine
+    switch (state) {
+        case SAFETY_IDLE:
+            // Start first selected check
+            return advance(SAFETY_IDLE);
 
         case SAFETY_COMPLETE:
             // Already complete
@@ -207,18 +556,100 @@ esp_err_t safety_run_checks(void)
             return ESP_FAIL;
 
         default:
-            ESP_LOGE(TAG, "Invalid safety state: %d", g_system_state.safety_state);
+            ESP_LOGE(TAG, "Invalid safety state: %d", state);
             return ESP_FAIL;
     }
 }
 
+bool safety_ready(void)
+{
+    return s_ready;
+}
+
+bool safety_precharge_pending(void)
+{
+    int index = step_index(g_system_state.safety_state);
+    if (index < 0) {
+        return false;
+    }
+    if (s_checklist.steps[index].confirm == SAFETY_CONFIRM_ITV_FEEDBACK) {
+        return true;
+    }
+    // No selected step after this one
+    for (int i = index + 1; i < s_checklist.count; i++) {
+        if (step_selected(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void safety_cancel(void)
 {
     ESP_LOGW(TAG, "Safety check sequence cancelled by user");
-    g_system_state.safety_state = SAFETY_CANCELLED;
+    state_set_safety(SAFETY_CANCELLED);
     s_safety.check_start_time_us = 0;
 }
 
+void safety_get_checklist(safety_checklist_t *checklist)
+{
+    portENTER_CRITICAL(&s_config_lock);
+    *checklist = s_config;
+    portEXIT_CRITICAL(&s_config_lock);
+}
+
+esp_err_t safety_set_checklist(const safety_checklist_t *checklist)
+{
+    if (!checklist_valid(checklist)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Unused slots are stored zeroed
+    safety_checklist_t stored = {0};
+    stored.version = checklist->version;
+    stored.count = checklist->count;
+    memcpy(stored.steps, checklist->steps, checklist->count * sizeof(safety_step_t));
+
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_SAFETY_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for writing: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = nvs_set_blob(nvs_handle, NVS_KEY_SAFETY, &stored, sizeof(stored));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save checklist: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    portENTER_CRITICAL(&s_config_lock);
+    s_config = stored;
+    portEXIT_CRITICAL(&s_config_lock);
+    ESP_LOGI(TAG, "Checklist saved (%u steps), used from the next sequence", stored.count);
+    return ESP_OK;
+}
+
+void safety_get_stats(safety_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_button_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_button_lock);
+}
+
+const char *safety_confirm_name(safety_confirm_t confirm)
+{
+    return (confirm < SAFETY_CONFIRM_COUNT) ? s_confirm_names[confirm] : "unknown";
+}
+
+const char *safety_scope_name(safety_scope_t scope)
+{
+    return (scope < SAFETY_SCOPE_COUNT) ? s_scope_names[scope] : "unknown";
+}
+
 void safety_get_prompt(char *line1, char *line2)
 {
     if (line1 == NULL || line2 == NULL) {
@@ -228,9 +659,26 @@ void safety_get_prompt(char *line1, char *line2)
 
     // Get current safety state
     safety_state_t state = g_system_state.safety_state;
-
-    // Bounds check
-    if (state >= SAFETY_IDLE && state <= SAFETY_CANCELLED) {
+    int index = step_index(state);
+
+    if (index >= 0) {
+        // Position among the steps this sequence runs
+        int position = 0;
+        int total = 0;
+        for (int i = 0; i < s_checklist.count; i++) {
+            if (step_selected(i)) {
+                total++;
+                if (i <= index) {
+                    position++;
+                }
+            }
+        }
+        const safety_step_t *step = &s_checklist.steps[index];
+        snprintf(line1, 17, "%s %d/%d",
+                 (step->confirm == SAFETY_CONFIRM_BUTTON) ? "SAFETY CHECK" : "AUTO CHECK", position, total);
+        strncpy(line2, step->prompt, 16);
+        line2[16] = '\0';
+    } else if (state == SAFETY_IDLE || (state >= SAFETY_COMPLETE && state <= SAFETY_CANCELLED)) {
         strncpy(line1, s_prompts[state].line1, 16);
         strncpy(line2, s_prompts[state].line2, 16);
         line1[16] = '\0';  // Ensure null termination
@@ -0,0 +1,82 @@
+/**
+ * @file startup.c
+ * @brief Dependency-aware startup sequencing implementation
+ */
+
+#include "startup.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "STARTUP";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_ready_ms = 0;
+static EventBits_t s_faults = 0;
+
+const char *startup_stage_name(EventBits_t ready_bit)
+{
+    switch (ready_bit) {
+        case EVENT_SCALE_READY: return "scale";
+        case EVENT_CONTROL_READY: return "control";
+        case EVENT_DISPLAY_READY: return "display";
+        default: return "unknown";
+    }
+}
+
+void startup_stage_done(EventBits_t ready_bit, esp_err_t result)
+{
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    if (result != ESP_OK) {
+        ESP_LOGE(TAG, "%s init failed: %s", startup_stage_name(ready_bit), esp_err_to_name(result));
+    } else {
+        ESP_LOGI(TAG, "%s ready at %lu ms", startup_stage_name(ready_bit), (unsigned long)now_ms);
+    }
+
+    // Fault first: a reader that sees the ready bit also sees the fault
+    portENTER_CRITICAL(&s_lock);
+    if (result != ESP_OK) {
+        s_faults |= ready_bit;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    EventBits_t bits = xEventGroupSetBits(g_system_events, ready_bit);
+    if ((bits & EVENT_SYSTEM_READY) == EVENT_SYSTEM_READY) {
+        portENTER_CRITICAL(&s_lock);
+        if (s_ready_ms == 0 && s_faults == 0) {
+            s_ready_ms = (now_ms > 0) ? now_ms : 1;
+        }
+        portEXIT_CRITICAL(&s_lock);
+    }
+}
+
+bool startup_wait(EventBits_t ready_bits, uint32_t timeout_ms)
+{
+    EventBits_t bits = xEventGroupWaitBits(g_system_events, ready_bits, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeout_ms));
+    return (bits & ready_bits) == ready_bits;
+}
+
+EventBits_t startup_faults(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    EventBits_t faults = s_faults;
+    portEXIT_CRITICAL(&s_lock);
+    return faults;
+}
+
+bool startup_healthy(void)
+{
+    EventBits_t bits = xEventGroupGetBits(g_system_events);
+    return (bits & EVENT_SYSTEM_READY) == EVENT_SYSTEM_READY && startup_faults() == 0;
+}
+
+uint32_t startup_boot_to_ready_ms(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    uint32_t ms = s_ready_ms;
+    portEXIT_CRITICAL(&s_lock);
+    return ms;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file state_transition.c
+ * @brief Recorded setters for the state fields of g_system_state
+ */
+
+#include "state_transition.h"
+#include "flight_recorder.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static state_transition_stats_t s_stats = {0};
+static int64_t s_changed_us = 0;
+static TaskHandle_t s_changed_by = NULL;
+
+void state_set_system(system_state_enum_t state)
+{
+    system_state_enum_t old = g_system_state.state;
+    if (old == state) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&s_lock);
+    s_changed_us = now_us;
+    s_changed_by = self;
+    s_stats.transitions++;
+    portEXIT_CRITICAL(&s_lock);
+
+    g_system_state.state = state;
+    flightrec_record(FLIGHTREC_STATE, (uint8_t)old, (uint8_t)state);
+
+    // The error code belongs to this ERROR: the next fault, even with the
+    // same code, must be recorded again
+    if (old == STATE_ERROR) {
+        state_set_error(ERROR_NONE);
+    }
+
+    if (g_system_events != NULL) {
+        EventBits_t bits = EVENT_STATE_CHANGED;
+        if (state == STATE_FILLING) {
+            bits |= EVENT_FILL_START;
+        } else if (state == STATE_ERROR) {
+            bits |= EVENT_ERROR;
+        }
+        xEventGroupSetBits(g_system_events, bits);
+    }
+
+    if (state == STATE_ERROR) {
+        flightrec_trigger_save(FLIGHTREC_TRIGGER_ERROR);
+    }
+}
+
+void state_set_zone(fill_zone_t zone)
+{
+    fill_zone_t old = g_system_state.active_zone;
+    if (old == zone) {
+        return;
+    }
+
+    g_system_state.active_zone = zone;
+    flightrec_record(FLIGHTREC_ZONE, (uint8_t)old, (uint8_t)zone);
+}
+
+void state_set_safety(safety_state_t state)
+{
+    safety_state_t old = g_system_state.safety_state;
+    if (old == state) {
+        return;
+    }
+
+    g_system_state.safety_state = state;
+    flightrec_record(FLIGHTREC_SAFETY, (uint8_t)old, (uint8_t)state);
+
+    if (g_system_events != NULL) {
+        if (state == SAFETY_COMPLETE) {
+            xEventGroupSetBits(g_system_events, EVENT_SAFETY_COMPLETE);
+        } else if (old == SAFETY_COMPLETE) {
+            xEventGroupClearBits(g_system_events, EVENT_SAFETY_COMPLETE);
+        }
+    }
+}
+
+void state_set_error(error_code_t error)
+{
+    error_code_t old = g_system_state.error;
+    if (old == error) {
+        return;
+    }
+
+    g_system_state.error = error;
+    flightrec_record(FLIGHTREC_ERROR, (uint8_t)old, (uint8_t)error);
+}
+
+int64_t state_changed_us(void)
+{
+    portENTER_CRITICAL(&s_lock);
+    int64_t changed_us = s_changed_us;
+    portEXIT_CRITICAL(&s_lock);
+    return changed_us;
+}
+
+bool state_changed_by_caller(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&s_lock);
+    bool mine = (s_changed_by == self);
+    portEXIT_CRITICAL(&s_lock);
+    return mine;
+}
+
+void state_record_stop_latency(uint32_t latency_us)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_stats.stops++;
+    s_stats.last_stop_us = latency_us;
+    if (latency_us > s_stats.max_stop_us) {
+        s_stats.max_stop_us = latency_us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void state_get_stats(state_transition_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file task_monitor.c
+ * @brief FreeRTOS task runtime and stack telemetry implementation
+ *
+ * CPU % comes from the difference of each task's run-time counter between
+ * two samples, divided by the elapsed run-time clock. The counter is 32-bit
+ * microseconds, so the interval must stay well below its ~71 minute wrap.
+ * Core load is 100 % minus the share of that core's IDLE task.
+ */
+
+#include "task_monitor.h"
+#include "json_writer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const char *TAG = "TASK_MON";
+
+/* Previous run-time counters, matched by task handle (sampling task only) */
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+    uint32_t stack_free;
+} prev_sample_t;
+
+static prev_sample_t s_prev[TASK_MONITOR_MAX_TASKS];
+static uint32_t s_prev_count = 0;
+static uint32_t s_prev_total = 0;
+
+static TaskStatus_t s_status[TASK_MONITOR_MAX_TASKS];
+static task_monitor_snapshot_t s_work;
+static task_monitor_snapshot_t s_latest;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static StaticTask_t s_task_tcb;
+static StackType_t s_task_stack[TASK_MONITOR_TASK_STACK_SIZE];
+
+static const prev_sample_t *find_prev(TaskHandle_t handle)
+{
+    for (uint32_t i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].handle == handle) {
+            return &s_prev[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Take one sample and publish it if a previous sample exists
+ */
+static void sample(void)
+{
+    const TaskStatus_t *status = s_status;
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(s_status, TASK_MONITOR_MAX_TASKS, &total);
+    if (n == 0) {
+        // FreeRTOS reports nothing when the array is too small
+        UBaseType_t tasks = uxTaskGetNumberOfTasks();
+        uint32_t dropped = (tasks > TASK_MONITOR_MAX_TASKS) ? tasks - TASK_MONITOR_MAX_TASKS : 0;
+        portENTER_CRITICAL(&s_lock);
+        s_latest.tasks_dropped = dropped;
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    uint32_t elapsed = total - s_prev_total;
+    bool have_prev = (s_prev_count > 0 && elapsed > 0);
+
+    memset(&s_work, 0, sizeof(s_work));
+    s_work.sample_time_us = esp_timer_get_time();
+    s_work.interval_us = elapsed;
+    s_work.task_count = n;
+    heap_monitor_sample(&s_work.heap);
+    deadline_get_stats(&s_work.deadlines);
+    for (UBaseType_t i = 0; i < s_work.task_count; i++) {
+        const TaskStatus_t *ts = &status[i];
+        task_monitor_task_t *t = &s_work.tasks[i];
+        const prev_sample_t *prev = find_prev(ts->xHandle);
+
+        strncpy(t->name, ts->pcTaskName, sizeof(t->name) - 1);
+        t->core = (ts->xCoreID >= 0 && ts->xCoreID < portNUM_PROCESSORS) ?
+                  (uint8_t)ts->xCoreID : TASK_MONITOR_NO_AFFINITY;
+        t->priority = (uint8_t)ts->uxCurrentPriority;
+        t->stack_free_bytes = ts->usStackHighWaterMark;
+
+        heap_monitor_task_counts_t counts;
+        heap_monitor_task_counts(ts->xHandle, &counts);
+        t->allocs = counts.allocs;
+        t->alloc_bytes = counts.alloc_bytes;
+
+        if (have_prev && prev) {
+            t->cpu_pct = (float)(ts->ulRunTimeCounter - prev->runtime) * 100.0f / (float)elapsed;
+        }
+
+        // Idle tasks are pinned, one per core
+        if (strncmp(t->name, "IDLE", 4) == 0 && t->core < TASK_MONITOR_MAX_CORES) {
+            float load = 100.0f - t->cpu_pct;
+            s_work.core_load_pct[t->core] = (load < 0.0f) ? 0.0f : load;
+        }
+
+        if (t->stack_free_bytes < TASK_MONITOR_STACK_WARN_BYTES &&
+            (prev == NULL || t->stack_free_bytes < prev->stack_free)) {
+            ESP_LOGW(TAG, "%s: only %lu bytes of stack left", t->name,
+                     (unsigned long)t->stack_free_bytes);
+        }
+    }
+
+    // Remember counters for the next interval
+    for (UBaseType_t i = 0; i < s_work.task_count; i++) {
+        s_prev[i].handle = status[i].xHandle;
+        s_prev[i].runtime = status[i].ulRunTimeCounter;
+        s_prev[i].stack_free = status[i].usStackHighWaterMark;
+    }
+    s_prev_count = s_work.task_count;
+    s_prev_total = total;
+
+    if (have_prev) {
+        portENTER_CRITICAL(&s_lock);
+        s_latest = s_work;
+        portEXIT_CRITICAL(&s_lock);
+    }
+}
+
+static void task_monitor_task(void *pvParameters)
+{
+    while (1) {
+        sample();
+        vTaskDelay(pdMS_TO_TICKS(TASK_MONITOR_INTERVAL_MS));
+    }
+}
+
+esp_err_t task_monitor_init(void)
+{
+    if (xTaskCreateStatic(task_monitor_task, "task_monitor", TASK_MONITOR_TASK_STACK_SIZE, NULL,
+                          TASK_MONITOR_TASK_PRIORITY, s_task_stack, &s_task_tcb) == NULL) {
+        ESP_LOGE(TAG, "Failed to create sampling task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void task_monitor_snapshot(task_monitor_snapshot_t *snap)
+{
+    portENTER_CRITICAL(&s_lock);
+    *snap = s_latest;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t task_monitor_to_json(const task_monitor_snapshot_t *snap, char *buf, size_t len)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+
+    json_writer_append(&w, "{\"device_id\":\"%s\",\"interval_ms\":%lu,\"core_load\":[",
+                       MQTT_DEVICE_ID, (unsigned long)(snap->interval_us / 1000));
+    for (int core = 0; core < TASK_MONITOR_MAX_CORES; core++) {
+        json_writer_append(&w, "%s%.1f", core ? "," : "", snap->core_load_pct[core]);
+    }
+    json_writer_append(&w, "],\"heap\":{\"free\":%lu,\"min_free\":%lu,\"largest_block\":%lu,"
+                       "\"min_largest_block\":%lu,\"frag\":%.1f,\"allocs\":%lu,\"alloc_rate\":%.2f,"
+                       "\"guard_violations\":%lu}",
+                       (unsigned long)snap->heap.free_bytes, (unsigned long)snap->heap.min_free_bytes,
+                       (unsigned long)snap->heap.largest_block, (unsigned long)snap->heap.min_largest_block,
+                       snap->heap.fragmentation_pct, (unsigned long)snap->heap.allocs,
+                       snap->heap.alloc_rate, (unsigned long)snap->heap.guard_violations);
+    json_writer_append(&w, ",\"deadlines\":{");
+    for (int i = 0; i < DEADLINE_TASK_COUNT; i++) {
+        const deadline_task_stats_t *d = &snap->deadlines.tasks[i];
+        json_writer_append(&w, "\"%s\":{\"misses\":%lu,\"max_gap_us\":%lu,\"max_late_us\":%lu},",
+                           deadline_task_name((deadline_task_t)i), (unsigned long)d->misses,
+                           (unsigned long)d->max_gap_us, (unsigned long)d->max_late_us);
+    }
+    json_writer_append(&w, "\"guard_trips\":%lu}", (unsigned long)snap->deadlines.guard_trips);
+    json_writer_append(&w, ",\"tasks_dropped\":%lu,\"tasks\":[", (unsigned long)snap->tasks_dropped);
+
+    for (uint32_t i = 0; i < snap->task_count; i++) {
+        const task_monitor_task_t *t = &snap->tasks[i];
+        json_writer_append(&w, "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u,\"cpu\":%.2f,\"stack_free\":%lu,"
+                           "\"allocs\":%lu}",
+                           i ? "," : "", t->name,
+                           (t->core == TASK_MONITOR_NO_AFFINITY) ? -1 : (int)t->core,
+                           t->priority, t->cpu_pct, (unsigned long)t->stack_free_bytes,
+                           (unsigned long)t->allocs);
+    }
+    json_writer_append(&w, "]}");
+
+    return json_writer_status(&w);
+}
@@ -4,10 +4,29 @@
  */
 
 #include "webserver.h"
+#include "config.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
-#include "cJSON.h"
+#include "esp_timer.h"
 #include "system_state.h"
+#include "state_transition.h"
+#include "startup.h"
+#include "flight_recorder.h"
+#include "task_monitor.h"
+#include "wifi_manager.h"
+#include "power_manager.h"
+#include "batch.h"
+#include "safety_system.h"
+#include "estop.h"
+#include "pressure_controller.h"
+#include "display_driver.h"
+#include "ctrl_profiler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "WEBSERVER";
@@ -16,12 +35,188 @@ static httpd_handle_t server = NULL;
 /* External reference to global state */
 extern system_state_t g_system_state;
 
+/* =============================================================================
+ * ASYNC REQUEST HANDLING
+ * ===========================================================================*/
+
+/**
+ * @brief Deferred request queued for a worker
+ *
+ * While a worker runs the handler, req->user_ctx points at this item so
+ * handlers can check the remaining time budget.
+ */
+typedef struct {
+    httpd_req_t *req;                       // Async copy of the request
+    esp_err_t (*handler)(httpd_req_t *req); // Real URI handler
+    int64_t deadline_us;                    // Absolute deadline (esp_timer time)
+} async_request_t;
+
+static QueueHandle_t s_async_queue = NULL;
+static StaticQueue_t s_async_queue_buf;
+static uint8_t s_async_queue_storage[WEBSERVER_ASYNC_QUEUE_LEN * sizeof(async_request_t)];
+
+/* Worker tasks are statically allocated (see tools/mem_budget) */
+static StaticTask_t s_worker_tcb[WEBSERVER_ASYNC_WORKERS];
+static StackType_t s_worker_stack[WEBSERVER_ASYNC_WORKERS][WEBSERVER_WORKER_STACK_SIZE];
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static webserver_stats_t s_stats = {0};
+
 /* Forward declarations */
 static esp_err_t root_handler(httpd_req_t *req);
 static esp_err_t api_status_handler(httpd_req_t *req);
 static esp_err_t api_start_fill_handler(httpd_req_t *req);
 static esp_err_t api_stop_fill_handler(httpd_req_t *req);
+static esp_err_t api_estop_handler(httpd_req_t *req);
+static esp_err_t api_estop_reset_handler(httpd_req_t *req);
+static esp_err_t api_estop_test_handler(httpd_req_t *req);
+static esp_err_t api_checklist_get_handler(httpd_req_t *req);
+static esp_err_t api_checklist_set_handler(httpd_req_t *req);
 static esp_err_t api_set_target_handler(httpd_req_t *req);
+static esp_err_t api_batch_handler(httpd_req_t *req);
+static esp_err_t api_profile_handler(httpd_req_t *req);
+static esp_err_t api_profile_reset_handler(httpd_req_t *req);
+static esp_err_t api_flightrec_handler(httpd_req_t *req);
+static esp_err_t api_flightrec_saved_handler(httpd_req_t *req);
+static esp_err_t metrics_handler(httpd_req_t *req);
+
+/**
+ * @brief Bump a request counter (workers and the httpd task all count)
+ */
+static void stats_count(uint32_t *counter)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    (*counter)++;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static bool request_expired(httpd_req_t *req)
+{
+    const async_request_t *item = (const async_request_t *)req->user_ctx;
+    return esp_timer_get_time() > item->deadline_us;
+}
+
+/**
+ * @brief Receive the full request body within the request time budget
+ *
+ * Retries socket timeouts until the deadline so a client trickling its body
+ * only ever holds one worker, and never for longer than the budget.
+ *
+ * @param req Request (must be running on an async worker)
+ * @param buf Destination buffer, NUL-terminated on success
+ * @param buf_len Size of buf
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the body does not fit,
+ *         ESP_ERR_TIMEOUT if the budget ran out, ESP_FAIL on socket error
+ */
+static esp_err_t recv_body(httpd_req_t *req, char *buf, size_t buf_len)
+{
+    if (req->content_len == 0 || req->content_len >= buf_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t received = 0;
+    while (received < req->content_len) {
+        if (request_expired(req)) {
+            stats_count(&s_stats.timed_out);
+            return ESP_ERR_TIMEOUT;
+        }
+
+        int ret = httpd_req_recv(req, buf + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;  // Slow client, keep waiting until the deadline
+        }
+        if (ret <= 0) {
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+
+    buf[received] = '\0';
+    return ESP_OK;
+}
+
+/**
+ * @brief recv_body(), replying to the client if the body was not received
+ *
+ * Sends 400 for a missing or oversized body and 408 when the budget ran out;
+ * a closed socket gets no reply.
+ *
+ * @return ESP_OK with the body in buf, ESP_FAIL if the handler should return
+ */
+static esp_err_t recv_body_or_reply(httpd_req_t *req, char *buf, size_t buf_len)
+{
+    esp_err_t ret = recv_body(req, buf, buf_len);
+
+    if (ret == ESP_ERR_INVALID_SIZE) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or oversized body");
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        httpd_resp_send_err(req, HTTPD_408_REQ_TIMEOUT, "Request timeout");
+    }
+    return (ret == ESP_OK) ? ESP_OK : ESP_FAIL;
+}
+
+/**
+ * @brief Async worker task
+ *
+ * Runs deferred handlers so the httpd task itself never blocks on a client.
+ */
+static void async_worker_task(void *pvParameters)
+{
+    async_request_t item;
+
+    while (1) {
+        if (xQueueReceive(s_async_queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        item.req->user_ctx = &item;
+
+        if (request_expired(item.req)) {
+            // Sat in the queue past its budget, answer immediately
+            stats_count(&s_stats.timed_out);
+            httpd_resp_set_status(item.req, "503 Service Unavailable");
+            httpd_resp_sendstr(item.req, "Request budget exceeded");
+        } else {
+            item.handler(item.req);
+            stats_count(&s_stats.served);
+        }
+
+        httpd_req_async_handler_complete(item.req);
+    }
+}
+
+/**
+ * @brief Entry point for every URI: defer the real handler to a worker
+ *
+ * The real handler is passed in the URI's user_ctx. Requests wait for a
+ * worker in a queue of WEBSERVER_ASYNC_QUEUE_LEN; when it is full the
+ * client gets an immediate 503. A request that waited past its budget is
+ * answered 503 by the worker without running the handler.
+ */
+static esp_err_t async_dispatch(httpd_req_t *req)
+{
+    async_request_t item = {
+        .req = NULL,
+        .handler = (esp_err_t (*)(httpd_req_t *))req->user_ctx,
+        .deadline_us = esp_timer_get_time() + (int64_t)WEBSERVER_REQUEST_BUDGET_MS * 1000,
+    };
+
+    // Only this task queues, so a free slot seen here is still free below.
+    // Answer on req itself: after begin() it belongs to the async copy.
+    if (uxQueueSpacesAvailable(s_async_queue) == 0) {
+        stats_count(&s_stats.rejected_busy);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "Server busy");
+        return ESP_OK;
+    }
+
+    if (httpd_req_async_handler_begin(req, &item.req) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Async begin failed");
+        return ESP_FAIL;
+    }
+
+    xQueueSend(s_async_queue, &item, 0);
+    return ESP_OK;
+}
 
 /**
  * @brief Embedded HTML for WebUI
@@ -174,86 +369,211 @@ static esp_err_t root_handler(httpd_req_t *req)
 }
 
 /**
- * @brief API endpoint: Get system status (JSON)
+ * @brief Send a {"status","message"} reply
  */
-static esp_err_t api_status_handler(httpd_req_t *req)
+static esp_err_t send_result(httpd_req_t *req, bool success, const char *message)
 {
-    cJSON *root = cJSON_CreateObject();
+    char json_str[128];
 
-    cJSON_AddStringToObject(root, "state", state_to_string(g_system_state.state));
-    cJSON_AddStringToObject(root, "zone", zone_to_string(g_system_state.active_zone));
-    cJSON_AddNumberToObject(root, "current_weight", g_system_state.current_weight_lbs);
-    cJSON_AddNumberToObject(root, "target_weight", g_system_state.target_weight_lbs);
-    cJSON_AddNumberToObject(root, "pressure_pct", g_system_state.pressure_setpoint_pct);
+    snprintf(json_str, sizeof(json_str), "{\"status\":\"%s\",\"message\":\"%s\"}",
+             success ? "success" : "error", message);
 
-    float progress = (g_system_state.current_weight_lbs / g_system_state.target_weight_lbs) * 100.0f;
-    cJSON_AddNumberToObject(root, "progress_pct", progress);
-
-    cJSON_AddNumberToObject(root, "fills_today", g_system_state.fills_today);
-    cJSON_AddNumberToObject(root, "total_lbs_today", g_system_state.total_lbs_today);
-    cJSON_AddBoolToObject(root, "scale_online", g_system_state.scale_online);
-    cJSON_AddBoolToObject(root, "mqtt_connected", g_system_state.mqtt_connected);
-
-    const char *json_str = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, json_str);
 
-    free((void *)json_str);
-    cJSON_Delete(root);
-
     return ESP_OK;
 }
 
 /**
- * @brief API endpoint: Start fill operation
+ * @brief Reject a target weight outside MIN/MAX_TARGET_WEIGHT_LBS
  */
-static esp_err_t api_start_fill_handler(httpd_req_t *req)
+static esp_err_t send_target_out_of_range(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
+    char message[48];
 
-    if (g_system_state.state == STATE_IDLE) {
-        g_system_state.state = STATE_SAFETY_CHECK;
-        cJSON_AddStringToObject(root, "status", "success");
-        cJSON_AddStringToObject(root, "message", "Fill started (safety checks required)");
-    } else {
-        cJSON_AddStringToObject(root, "status", "error");
-        cJSON_AddStringToObject(root, "message", "System not idle");
+    snprintf(message, sizeof(message), "Target out of range (%.0f-%.0f lbs)",
+             MIN_TARGET_WEIGHT_LBS, MAX_TARGET_WEIGHT_LBS);
+    return send_result(req, false, message);
+}
+
+/**
+ * @brief Read a top-level number from a flat JSON object
+ *
+ * Enough for the small fixed-shape request bodies of this API, without
+ * building a heap-allocated tree per request.
+ *
+ * @return true if the key exists and holds a number
+ */
+static bool json_get_number(const char *json, const char *key, float *out)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+
+    const char *p = strstr(json, pattern);
+    if (p == NULL) {
+        return false;
     }
+    p += strlen(pattern);
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+    if (*p++ != ':') {
+        return false;
+    }
+
+    char *end;
+    float value = strtof(p, &end);
+    if (end == p) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+/**
+ * @brief API endpoint: Get system status (JSON)
+ */
+static esp_err_t api_status_handler(httpd_req_t *req)
+{
+    char json_str[768];
+    batch_status_t batch;
+    batch_get_status(&batch);
+    float progress = (g_system_state.current_weight_lbs / g_system_state.target_weight_lbs) * 100.0f;
+
+    snprintf(json_str, sizeof(json_str),
+             "{\"state\":\"%s\",\"zone\":\"%s\",\"current_weight\":%.2f,"
+             "\"target_weight\":%.2f,\"pressure_pct\":%.1f,\"progress_pct\":%.1f,"
+             "\"fills_today\":%lu,\"total_lbs_today\":%.1f,"
+             "\"scale_online\":%s,\"mqtt_connected\":%s,\"boot_ready_ms\":%lu,"
+             "\"startup_ok\":%s,\"last_fill\":{\"actual_lbs\":%.2f,\"spill_lbs\":%.2f,\"settle_ms\":%lu,"
+             "\"settled\":%s,\"first_stroke_ms\":%lu,\"precharged\":%s},"
+             "\"batch\":{\"phase\":\"%s\",\"drums\":%u,\"done\":%u,\"tare_lbs\":%.2f,"
+             "\"changeover_ms\":%lu,\"aborted\":%s}}",
+             state_to_string(g_system_state.state),
+             zone_to_string(g_system_state.active_zone),
+             g_system_state.current_weight_lbs,
+             g_system_state.target_weight_lbs,
+             g_system_state.pressure_setpoint_pct,
+             progress,
+             (unsigned long)g_system_state.fills_today,
+             g_system_state.total_lbs_today,
+             g_system_state.scale_online ? "true" : "false",
+             g_system_state.mqtt_connected ? "true" : "false",
+             (unsigned long)startup_boot_to_ready_ms(),
+             startup_healthy() ? "true" : "false",
+             g_system_state.actual_dispensed_lbs,
+             g_system_state.spill_lbs,
+             (unsigned long)g_system_state.settle_time_ms,
+             g_system_state.settle_stable ? "true" : "false",
+             (unsigned long)g_system_state.first_stroke_ms,
+             g_system_state.precharged ? "true" : "false",
+             batch_phase_to_string(batch.phase), batch.drums, batch.done, batch.tare_lbs,
+             (unsigned long)batch.last_changeover_ms, batch.aborted ? "true" : "false");
 
-    const char *json_str = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, json_str);
 
-    free((void *)json_str);
-    cJSON_Delete(root);
-
     return ESP_OK;
 }
 
+/**
+ * @brief API endpoint: Start fill operation
+ */
+static esp_err_t api_start_fill_handler(httpd_req_t *req)
+{
+    power_manager_activity(POWER_WAKE_NETWORK);
+    if (batch_active()) {
+        return send_result(req, false, "Batch job running");
+    }
+    if (!startup_healthy()) {
+        return send_result(req, false, "Startup incomplete or failed");
+    }
+    if (!safety_ready()) {
+        return send_result(req, false, "Safety system not initialized");
+    }
+    if (g_system_state.state == STATE_IDLE) {
+        state_set_system(STATE_SAFETY_CHECK);
+        return send_result(req, true, "Fill started (safety checks required)");
+    }
+    return send_result(req, false, "System not idle");
+}
+
 /**
  * @brief API endpoint: Stop/cancel fill operation
  */
 static esp_err_t api_stop_fill_handler(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
-
+    power_manager_activity(POWER_WAKE_NETWORK);
+    bool had_batch = batch_active();
+    batch_stop();
+    // ERROR is held while the e-stop is latched: cancelling it would only be
+    // forced back next tick, with another error event and flight record save
+    if (estop_active()) {
+        return send_result(req, had_batch, had_batch ? "Batch job stopped, emergency stop still latched"
+                                                     : "Emergency stop latched, use /api/estop/reset");
+    }
     if (g_system_state.state != STATE_IDLE) {
-        g_system_state.state = STATE_CANCELLED;
-        cJSON_AddStringToObject(root, "status", "success");
-        cJSON_AddStringToObject(root, "message", "Fill cancelled");
-    } else {
-        cJSON_AddStringToObject(root, "status", "error");
-        cJSON_AddStringToObject(root, "message", "No active fill");
+        state_set_system(STATE_CANCELLED);
+        return send_result(req, true, "Fill cancelled");
+    }
+    if (had_batch) {
+        return send_result(req, true, "Batch job stopped");
     }
+    return send_result(req, false, "No active fill");
+}
 
-    const char *json_str = cJSON_Print(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, json_str);
+/**
+ * @brief API endpoint: Emergency stop
+ *
+ * Registered directly rather than through async_dispatch: it runs in the
+ * httpd task, so a full worker queue cannot delay the stop.
+ */
+static esp_err_t api_estop_handler(httpd_req_t *req)
+{
+    estop_trigger(ESTOP_SOURCE_API);
+    return send_result(req, true, "Emergency stop latched");
+}
 
-    free((void *)json_str);
-    cJSON_Delete(root);
+/**
+ * @brief API endpoint: Clear a latched emergency stop
+ */
+static esp_err_t api_estop_reset_handler(httpd_req_t *req)
+{
+    power_manager_activity(POWER_WAKE_NETWORK);
+    if (!estop_active()) {
+        return send_result(req, false, "No emergency stop latched");
+    }
+    if (estop_reset() != ESP_OK) {
+        return send_result(req, false, "E-stop input still asserted");
+    }
+    if (g_system_state.error == ERROR_ESTOP) {
+        state_set_error(ERROR_NONE);
+        state_set_system(STATE_IDLE);
+    }
+    return send_result(req, true, "Emergency stop cleared");
+}
 
-    return ESP_OK;
+/**
+ * @brief API endpoint: Measure trigger-to-zero latency (idle only)
+ */
+static esp_err_t api_estop_test_handler(httpd_req_t *req)
+{
+    power_manager_activity(POWER_WAKE_NETWORK);
+    esp_err_t ret = estop_self_test();
+    if (ret == ESP_ERR_INVALID_STATE) {
+        return send_result(req, false, "System not idle");
+    }
+
+    estop_stats_t stats;
+    estop_get_stats(&stats);
+    char json_str[128];
+    snprintf(json_str, sizeof(json_str),
+             "{\"status\":\"%s\",\"runs\":%lu,\"failures\":%lu,\"min_us\":%lu,\"max_us\":%lu}",
+             (ret == ESP_OK) ? "success" : "error", (unsigned long)stats.test_runs,
+             (unsigned long)stats.test_failures, (unsigned long)stats.test_min_us,
+             (unsigned long)stats.test_max_us);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json_str);
 }
 
 /**
@@ -261,59 +581,657 @@ static esp_err_t api_stop_fill_handler(httpd_req_t *req)
  */
 static esp_err_t api_set_target_handler(httpd_req_t *req)
 {
-    char content[100];
-    int ret = httpd_req_recv(req, content, sizeof(content));
-
-    if (ret <= 0) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid request");
+    char content[WEBSERVER_MAX_BODY_LEN];
+    if (recv_body_or_reply(req, content, sizeof(content)) != ESP_OK) {
         return ESP_FAIL;
     }
 
-    content[ret] = '\0';
+    float new_target;
+    if (!json_get_number(content, "target", &new_target)) {
+        return send_result(req, false, "Invalid JSON");
+    }
+    if (new_target < MIN_TARGET_WEIGHT_LBS || new_target > MAX_TARGET_WEIGHT_LBS) {
+        return send_target_out_of_range(req);
+    }
 
-    cJSON *json = cJSON_Parse(content);
-    cJSON *target = cJSON_GetObjectItem(json, "target");
+    g_system_state.target_weight_lbs = new_target;
+    power_manager_activity(POWER_WAKE_NETWORK);
+    return send_result(req, true, "Target weight updated");
+}
+
+/**
+ * @brief API endpoint: Safety checklist in use (JSON)
+ */
+static esp_err_t api_checklist_get_handler(httpd_req_t *req)
+{
+    safety_checklist_t checklist;
+    char item[128];
 
-    cJSON *root = cJSON_CreateObject();
+    safety_get_checklist(&checklist);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, "{\"steps\":[");
+    for (int i = 0; i < checklist.count; i++) {
+        const safety_step_t *step = &checklist.steps[i];
+        // Prompts never contain '"' or '\' (rejected on upload)
+        snprintf(item, sizeof(item),
+                 "%s{\"prompt\":\"%s\",\"confirm\":\"%s\",\"scope\":\"%s\",\"timeout_s\":%lu}",
+                 (i > 0) ? "," : "", step->prompt,
+                 safety_confirm_name((safety_confirm_t)step->confirm),
+                 safety_scope_name((safety_scope_t)step->scope),
+                 (unsigned long)(step->timeout_ms / 1000));
+        httpd_resp_sendstr_chunk(req, item);
+    }
+    httpd_resp_sendstr_chunk(req, "]}");
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
 
-    if (target && cJSON_IsNumber(target)) {
-        float new_target = target->valuedouble;
+/**
+ * @brief Parse one checklist line: confirm,scope,timeout_s,prompt
+ * @return true if the line is a valid step
+ */
+static bool parse_checklist_line(char *text, safety_step_t *step)
+{
+    char *fields[3];
+    char *rest = text;
 
-        if (new_target >= 10.0f && new_target <= 250.0f) {
-            g_system_state.target_weight_lbs = new_target;
-            cJSON_AddStringToObject(root, "status", "success");
-            cJSON_AddStringToObject(root, "message", "Target weight updated");
-        } else {
-            cJSON_AddStringToObject(root, "status", "error");
-            cJSON_AddStringToObject(root, "message", "Target out of range (10-250 lbs)");
+    for (int i = 0; i < 3; i++) {
+        char *comma = strchr(rest, ',');
+        if (comma == NULL) {
+            return false;
         }
+        *comma = '\0';
+        fields[i] = rest;
+        rest = comma + 1;
+    }
+
+    if (strcmp(fields[0], "button") == 0) {
+        step->confirm = SAFETY_CONFIRM_BUTTON;
+    } else if (strcmp(fields[0], "itv") == 0) {
+        step->confirm = SAFETY_CONFIRM_ITV_FEEDBACK;
     } else {
-        cJSON_AddStringToObject(root, "status", "error");
-        cJSON_AddStringToObject(root, "message", "Invalid JSON");
+        return false;
+    }
+    if (strcmp(fields[1], "drum") == 0) {
+        step->scope = SAFETY_SCOPE_DRUM;
+    } else if (strcmp(fields[1], "batch") == 0) {
+        step->scope = SAFETY_SCOPE_BATCH;
+    } else {
+        return false;
+    }
+
+    char *end;
+    unsigned long timeout_s = strtoul(fields[2], &end, 10);
+    if (end == fields[2] || *end != '\0' || timeout_s > SAFETY_STEP_TIMEOUT_MAX_MS / 1000) {
+        return false;
+    }
+    step->timeout_ms = (uint32_t)timeout_s * 1000;
+
+    // The prompt goes on the LCD and into JSON as is
+    size_t len = strlen(rest);
+    if (len == 0 || len > SAFETY_PROMPT_CHARS) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (rest[i] < ' ' || rest[i] > '~' || rest[i] == '"' || rest[i] == '\\') {
+            return false;
+        }
+    }
+    memcpy(step->prompt, rest, len + 1);
+    return true;
+}
+
+/**
+ * @brief API endpoint: Replace the safety checklist
+ *
+ * Body (text): one step per line, "confirm,scope,timeout_s,prompt" with
+ * confirm button|itv and scope drum|batch, e.g. "itv,batch,20,Air supply".
+ * Saved to NVS and used from the next safety sequence.
+ */
+static esp_err_t api_checklist_set_handler(httpd_req_t *req)
+{
+    char content[SAFETY_MAX_STEPS * 48];
+    if (recv_body_or_reply(req, content, sizeof(content)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    safety_checklist_t checklist = { .version = SAFETY_CHECKLIST_VERSION };
+    char *saveptr = NULL;
+    for (char *text = strtok_r(content, "\n", &saveptr); text != NULL;
+         text = strtok_r(NULL, "\n", &saveptr)) {
+        text[strcspn(text, "\r")] = '\0';
+        if (text[0] == '\0') {
+            continue;
+        }
+        if (checklist.count == SAFETY_MAX_STEPS) {
+            return send_result(req, false, "Too many steps");
+        }
+        if (!parse_checklist_line(text, &checklist.steps[checklist.count])) {
+            return send_result(req, false, "Invalid step line");
+        }
+        checklist.count++;
+    }
+
+    power_manager_activity(POWER_WAKE_NETWORK);
+    esp_err_t ret = safety_set_checklist(&checklist);
+    if (ret == ESP_ERR_INVALID_ARG) {
+        return send_result(req, false, "Rejected: timeout out of range or no button step");
+    }
+    if (ret != ESP_OK) {
+        return send_result(req, false, "Failed to save checklist");
+    }
+    return send_result(req, true, "Checklist saved, used from the next fill");
+}
+
+/**
+ * @brief API endpoint: Start a batch job
+ *
+ * Body: {"drums": N, "target": lbs}. The first drum starts once it is
+ * placed on the scale; POST /api/stop ends the job.
+ */
+static esp_err_t api_batch_handler(httpd_req_t *req)
+{
+    char content[WEBSERVER_MAX_BODY_LEN];
+    if (recv_body_or_reply(req, content, sizeof(content)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    power_manager_activity(POWER_WAKE_NETWORK);
+
+    float drums;
+    float target;
+    if (!json_get_number(content, "drums", &drums) || !json_get_number(content, "target", &target)) {
+        return send_result(req, false, "Invalid JSON");
+    }
+    if (drums < 1.0f || drums > BATCH_MAX_DRUMS || drums != (float)(int)drums) {
+        return send_result(req, false, "Drum count out of range");
+    }
+    if (target < MIN_TARGET_WEIGHT_LBS || target > MAX_TARGET_WEIGHT_LBS) {
+        return send_target_out_of_range(req);
+    }
+    if (!startup_healthy()) {
+        return send_result(req, false, "Startup incomplete or failed");
+    }
+    if (!safety_ready()) {
+        return send_result(req, false, "Safety system not initialized");
+    }
+
+    esp_err_t ret = batch_start((uint16_t)drums, target);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        return send_result(req, false, "System not idle");
+    } else if (ret != ESP_OK) {
+        return send_result(req, false, "Invalid batch job");
+    }
+    return send_result(req, true, "Batch job started, place the first drum");
+}
+
+/**
+ * @brief API endpoint: Control loop profile (per-stage cycle histograms)
+ */
+static esp_err_t api_profile_handler(httpd_req_t *req)
+{
+    prof_snapshot_t snap;
+    char json_str[2048];
+
+    ctrl_profiler_snapshot(&snap);
+    if (ctrl_profiler_to_json(&snap, json_str, sizeof(json_str)) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Profile too large");
+        return ESP_FAIL;
     }
 
-    const char *json_str = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, json_str);
 
-    free((void *)json_str);
-    cJSON_Delete(root);
-    cJSON_Delete(json);
+    return ESP_OK;
+}
+
+/**
+ * @brief API endpoint: Clear control loop profile
+ */
+static esp_err_t api_profile_reset_handler(httpd_req_t *req)
+{
+    ctrl_profiler_reset();
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, "{\"status\":\"success\",\"message\":\"Profile cleared\"}");
 
     return ESP_OK;
 }
 
+/**
+ * @brief Stream flight recorder entries as a JSON array, one chunk each
+ */
+static esp_err_t send_flightrec_entries(httpd_req_t *req, const flightrec_entry_t *entries,
+                                        size_t count)
+{
+    char line[160];
+
+    httpd_resp_sendstr_chunk(req, "\"entries\":[");
+    for (size_t i = 0; i < count; i++) {
+        if (request_expired(req)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (i > 0) {
+            httpd_resp_sendstr_chunk(req, ",");
+        }
+        if (flightrec_entry_to_json(&entries[i], line, sizeof(line)) == ESP_OK) {
+            httpd_resp_sendstr_chunk(req, line);
+        }
+    }
+    httpd_resp_sendstr_chunk(req, "]}");
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief API endpoint: Live flight recorder ring (oldest first)
+ */
+static esp_err_t api_flightrec_handler(httpd_req_t *req)
+{
+    flightrec_entry_t entries[FLIGHTREC_ENTRIES];  // 2 KB, sized into the worker stack
+    size_t count = flightrec_copy(entries, FLIGHTREC_ENTRIES);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, "{");
+    return send_flightrec_entries(req, entries, count);
+}
+
+/**
+ * @brief API endpoint: Flight recorder dump saved on the last error/crash
+ */
+static esp_err_t api_flightrec_saved_handler(httpd_req_t *req)
+{
+    flightrec_dump_header_t header;
+    flightrec_entry_t entries[FLIGHTREC_ENTRIES];
+
+    if (flightrec_load_saved(&header, entries, FLIGHTREC_ENTRIES) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No saved flight recorder dump");
+        return ESP_OK;
+    }
+
+    char head[96];
+    snprintf(head, sizeof(head), "{\"trigger\":\"%s\",\"boot\":%lu,",
+             flightrec_trigger_to_string((flightrec_trigger_t)header.trigger),
+             (unsigned long)header.boot);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, head);
+    return send_flightrec_entries(req, entries, header.count);
+}
+
+/**
+ * @brief Prometheus endpoint: task CPU %, core load and stack margins
+ */
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    task_monitor_snapshot_t snap;
+    char line[256];
+
+    task_monitor_snapshot(&snap);
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_core_load_percent CPU load per core over the last sampling interval\n"
+        "# TYPE bdo_core_load_percent gauge\n");
+    for (int core = 0; core < TASK_MONITOR_MAX_CORES; core++) {
+        snprintf(line, sizeof(line), "bdo_core_load_percent{core=\"%d\"} %.2f\n",
+                 core, snap.core_load_pct[core]);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_task_cpu_percent Share of one core used by the task over the last interval\n"
+        "# TYPE bdo_task_cpu_percent gauge\n");
+    for (uint32_t i = 0; i < snap.task_count; i++) {
+        const task_monitor_task_t *t = &snap.tasks[i];
+        snprintf(line, sizeof(line), "bdo_task_cpu_percent{task=\"%s\",core=\"%d\"} %.2f\n",
+                 t->name, (t->core == TASK_MONITOR_NO_AFFINITY) ? -1 : (int)t->core, t->cpu_pct);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_task_stack_free_bytes Minimum free stack since the task started\n"
+        "# TYPE bdo_task_stack_free_bytes gauge\n");
+    for (uint32_t i = 0; i < snap.task_count; i++) {
+        const task_monitor_task_t *t = &snap.tasks[i];
+        snprintf(line, sizeof(line), "bdo_task_stack_free_bytes{task=\"%s\"} %lu\n",
+                 t->name, (unsigned long)t->stack_free_bytes);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_task_heap_allocs_total Heap allocations made by the task since boot\n"
+        "# TYPE bdo_task_heap_allocs_total counter\n");
+    for (uint32_t i = 0; i < snap.task_count; i++) {
+        const task_monitor_task_t *t = &snap.tasks[i];
+        snprintf(line, sizeof(line), "bdo_task_heap_allocs_total{task=\"%s\"} %lu\n",
+                 t->name, (unsigned long)t->allocs);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_task_heap_alloc_bytes_total Bytes allocated by the task since boot\n"
+        "# TYPE bdo_task_heap_alloc_bytes_total counter\n");
+    for (uint32_t i = 0; i < snap.task_count; i++) {
+        const task_monitor_task_t *t = &snap.tasks[i];
+        snprintf(line, sizeof(line), "bdo_task_heap_alloc_bytes_total{task=\"%s\"} %lu\n",
+                 t->name, (unsigned long)t->alloc_bytes);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+
+    snprintf(line, sizeof(line),
+             "# HELP bdo_tasks_unreported Tasks beyond TASK_MONITOR_MAX_TASKS\n"
+             "# TYPE bdo_tasks_unreported gauge\n"
+             "bdo_tasks_unreported %lu\n", (unsigned long)snap.tasks_dropped);
+    httpd_resp_sendstr_chunk(req, line);
+
+    const heap_monitor_stats_t *heap = &snap.heap;
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_heap_free_bytes gauge\n"
+             "bdo_heap_free_bytes %lu\n"
+             "# TYPE bdo_heap_min_free_bytes gauge\n"
+             "bdo_heap_min_free_bytes %lu\n",
+             (unsigned long)heap->free_bytes, (unsigned long)heap->min_free_bytes);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_heap_largest_free_block_bytes Largest allocation possible now\n"
+             "# TYPE bdo_heap_largest_free_block_bytes gauge\n"
+             "bdo_heap_largest_free_block_bytes %lu\n",
+             (unsigned long)heap->largest_block);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_heap_min_largest_free_block_bytes gauge\n"
+             "bdo_heap_min_largest_free_block_bytes %lu\n"
+             "# TYPE bdo_heap_fragmentation_percent gauge\n"
+             "bdo_heap_fragmentation_percent %.1f\n",
+             (unsigned long)heap->min_largest_block, heap->fragmentation_pct);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_heap_allocs_total counter\n"
+             "bdo_heap_allocs_total %lu\n"
+             "# TYPE bdo_heap_frees_total counter\n"
+             "bdo_heap_frees_total %lu\n",
+             (unsigned long)heap->allocs, (unsigned long)heap->frees);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_heap_guard_violations_total Allocations by tasks that declared startup done\n"
+             "# TYPE bdo_heap_guard_violations_total counter\n"
+             "bdo_heap_guard_violations_total %lu\n",
+             (unsigned long)heap->guard_violations);
+    httpd_resp_sendstr_chunk(req, line);
+
+    snprintf(line, sizeof(line),
+             "# HELP bdo_fill_first_stroke_ms Start confirmation to first pump stroke, last fill\n"
+             "# TYPE bdo_fill_first_stroke_ms gauge\n"
+             "bdo_fill_first_stroke_ms %lu\n"
+             "# TYPE bdo_fill_precharged gauge\n"
+             "bdo_fill_precharged %d\n",
+             (unsigned long)g_system_state.first_stroke_ms, g_system_state.precharged ? 1 : 0);
+    httpd_resp_sendstr_chunk(req, line);
+
+    const deadline_stats_t *dl = &snap.deadlines;
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_deadline_misses_total Late check-ins of a real-time task\n"
+        "# TYPE bdo_deadline_misses_total counter\n");
+    for (int i = 0; i < DEADLINE_TASK_COUNT; i++) {
+        snprintf(line, sizeof(line), "bdo_deadline_misses_total{task=\"%s\"} %lu\n",
+                 deadline_task_name((deadline_task_t)i), (unsigned long)dl->tasks[i].misses);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+    httpd_resp_sendstr_chunk(req,
+        "# HELP bdo_deadline_max_gap_us Longest time between two check-ins since boot\n"
+        "# TYPE bdo_deadline_max_gap_us gauge\n");
+    for (int i = 0; i < DEADLINE_TASK_COUNT; i++) {
+        snprintf(line, sizeof(line), "bdo_deadline_max_gap_us{task=\"%s\"} %lu\n",
+                 deadline_task_name((deadline_task_t)i), (unsigned long)dl->tasks[i].max_gap_us);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+    snprintf(line, sizeof(line),
+             "# HELP bdo_dac_guard_trips_total Control stalls where the guard ISR zeroed the DAC\n"
+             "# TYPE bdo_dac_guard_trips_total counter\n"
+             "bdo_dac_guard_trips_total %lu\n"
+             "# TYPE bdo_dac_guard_armed gauge\n"
+             "bdo_dac_guard_armed %d\n",
+             (unsigned long)dl->guard_trips, dl->guard_armed ? 1 : 0);
+    httpd_resp_sendstr_chunk(req, line);
+
+    state_transition_stats_t transitions;
+    state_get_stats(&transitions);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_state_transitions_total counter\n"
+             "bdo_state_transitions_total %lu\n"
+             "# TYPE bdo_stops_total counter\n"
+             "bdo_stops_total %lu\n",
+             (unsigned long)transitions.transitions, (unsigned long)transitions.stops);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_stop_latency_us Stop/error posted to DAC at zero\n"
+             "# TYPE bdo_stop_latency_us gauge\n"
+             "bdo_stop_latency_us{kind=\"last\"} %lu\n"
+             "bdo_stop_latency_us{kind=\"max\"} %lu\n",
+             (unsigned long)transitions.last_stop_us, (unsigned long)transitions.max_stop_us);
+    httpd_resp_sendstr_chunk(req, line);
+
+    estop_stats_t estop;
+    estop_get_stats(&estop);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_estop_latched Emergency stop latched\n"
+             "# TYPE bdo_estop_latched gauge\n"
+             "bdo_estop_latched %d\n"
+             "# TYPE bdo_estop_trips_total counter\n",
+             estop.latched ? 1 : 0);
+    httpd_resp_sendstr_chunk(req, line);
+    for (int i = 0; i < ESTOP_SOURCE_COUNT; i++) {
+        snprintf(line, sizeof(line), "bdo_estop_trips_total{source=\"%s\"} %lu\n",
+                 estop_source_name((estop_source_t)i), (unsigned long)estop.trips[i]);
+        httpd_resp_sendstr_chunk(req, line);
+    }
+    snprintf(line, sizeof(line),
+             "# HELP bdo_estop_latency_us E-stop trigger to DAC at zero\n"
+             "# TYPE bdo_estop_latency_us gauge\n"
+             "bdo_estop_latency_us{kind=\"last\"} %lu\n"
+             "bdo_estop_latency_us{kind=\"max\"} %lu\n",
+             (unsigned long)estop.last_latency_us, (unsigned long)estop.max_latency_us);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_estop_selftest_latency_us Software interrupt to DAC at zero\n"
+             "# TYPE bdo_estop_selftest_latency_us gauge\n"
+             "bdo_estop_selftest_latency_us{kind=\"min\"} %lu\n"
+             "bdo_estop_selftest_latency_us{kind=\"max\"} %lu\n",
+             (unsigned long)estop.test_min_us, (unsigned long)estop.test_max_us);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_estop_selftest_failures_total counter\n"
+             "bdo_estop_selftest_failures_total %lu\n",
+             (unsigned long)estop.test_failures);
+    httpd_resp_sendstr_chunk(req, line);
+
+    itv_stats_t itv;
+    pressure_controller_get_itv_stats(&itv);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_itv_steps_total Upward DAC steps timed on the ITV switch\n"
+             "# TYPE bdo_itv_steps_total counter\n"
+             "bdo_itv_steps_total{result=\"reached\"} %lu\n"
+             "bdo_itv_steps_total{result=\"missed\"} %lu\n"
+             "bdo_itv_steps_total{result=\"in_band\"} %lu\n",
+             (unsigned long)itv.reached, (unsigned long)itv.missed, (unsigned long)itv.in_band);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_itv_response_us DAC step to pressure reached\n"
+             "# TYPE bdo_itv_response_us gauge\n"
+             "bdo_itv_response_us{kind=\"last\"} %lu\n"
+             "bdo_itv_response_us{kind=\"max\"} %lu\n"
+             "bdo_itv_response_us{kind=\"dead_time\"} %lu\n",
+             (unsigned long)itv.last_response_us, (unsigned long)itv.max_response_us,
+             (unsigned long)itv.dead_time_us);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_itv_air_faults_total counter\n"
+             "bdo_itv_air_faults_total %lu\n"
+             "# TYPE bdo_itv_slow_streak gauge\n"
+             "bdo_itv_slow_streak %lu\n",
+             (unsigned long)itv.faults, (unsigned long)itv.slow_streak);
+    httpd_resp_sendstr_chunk(req, line);
+
+    safety_stats_t safety;
+    safety_get_stats(&safety);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_safety_confirms_total Safety steps confirmed, by button or instrument\n"
+             "# TYPE bdo_safety_confirms_total counter\n"
+             "bdo_safety_confirms_total{by=\"button\"} %lu\n"
+             "bdo_safety_confirms_total{by=\"itv\"} %lu\n",
+             (unsigned long)safety.presses, (unsigned long)safety.auto_confirms);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_safety_sequence_ms Last passed safety sequence, start to fill\n"
+             "# TYPE bdo_safety_sequence_ms gauge\n"
+             "bdo_safety_sequence_ms %lu\n"
+             "# TYPE bdo_safety_sequences_total counter\n"
+             "bdo_safety_sequences_total %lu\n",
+             (unsigned long)safety.last_sequence_ms, (unsigned long)safety.sequences);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_safety_confirm_latency_us Button edge to safety check advanced\n"
+             "# TYPE bdo_safety_confirm_latency_us gauge\n"
+             "bdo_safety_confirm_latency_us{kind=\"last\"} %lu\n"
+             "bdo_safety_confirm_latency_us{kind=\"max\"} %lu\n",
+             (unsigned long)safety.last_latency_us, (unsigned long)safety.max_latency_us);
+    httpd_resp_sendstr_chunk(req, line);
+
+    display_stats_t lcd;
+    display_get_stats(&lcd);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_lcd_frame_bus_us I2C bus time per LCD frame (full = all 32 cells)\n"
+             "# TYPE bdo_lcd_frame_bus_us gauge\n"
+             "bdo_lcd_frame_bus_us{kind=\"last\"} %lu\n"
+             "bdo_lcd_frame_bus_us{kind=\"max\"} %lu\n"
+             "bdo_lcd_frame_bus_us{kind=\"full\"} %lu\n",
+             (unsigned long)lcd.last_frame_us, (unsigned long)lcd.max_frame_us,
+             (unsigned long)lcd.full_frame_us);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_lcd_frames_total counter\n"
+             "bdo_lcd_frames_total{result=\"sent\"} %lu\n"
+             "bdo_lcd_frames_total{result=\"unchanged\"} %lu\n"
+             "# TYPE bdo_lcd_cells_written_total counter\n"
+             "bdo_lcd_cells_written_total %lu\n",
+             (unsigned long)lcd.frames_sent, (unsigned long)lcd.frames_unchanged,
+             (unsigned long)lcd.cells_written);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_lcd_bytes_sent_total counter\n"
+             "bdo_lcd_bytes_sent_total %lu\n"
+             "# TYPE bdo_lcd_i2c_errors_total counter\n"
+             "bdo_lcd_i2c_errors_total %lu\n",
+             (unsigned long)lcd.bytes_sent, (unsigned long)lcd.i2c_errors);
+    httpd_resp_sendstr_chunk(req, line);
+
+    webserver_stats_t http;
+    webserver_get_stats(&http);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_http_requests_total Requests by outcome\n"
+             "# TYPE bdo_http_requests_total counter\n"
+             "bdo_http_requests_total{result=\"served\"} %lu\n"
+             "bdo_http_requests_total{result=\"busy\"} %lu\n"
+             "bdo_http_requests_total{result=\"timed_out\"} %lu\n",
+             (unsigned long)http.served, (unsigned long)http.rejected_busy,
+             (unsigned long)http.timed_out);
+    httpd_resp_sendstr_chunk(req, line);
+
+    wifi_manager_stats_t link;
+    wifi_manager_get_stats(&link);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_wifi_connected gauge\n"
+             "bdo_wifi_connected %d\n"
+             "# TYPE bdo_wifi_rssi_dbm gauge\n"
+             "bdo_wifi_rssi_dbm %d\n"
+             "# TYPE bdo_wifi_reconnects_total counter\n"
+             "bdo_wifi_reconnects_total %lu\n",
+             link.connected ? 1 : 0, link.rssi_dbm, (unsigned long)link.reconnect_count);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_wifi_outage_ms WiFi outage durations since boot\n"
+             "# TYPE bdo_wifi_outage_ms gauge\n"
+             "bdo_wifi_outage_ms{kind=\"last\"} %lu\n"
+             "bdo_wifi_outage_ms{kind=\"max\"} %lu\n"
+             "bdo_wifi_outage_ms{kind=\"total\"} %lu\n",
+             (unsigned long)link.last_outage_ms, (unsigned long)link.max_outage_ms,
+             (unsigned long)link.total_outage_ms);
+    httpd_resp_sendstr_chunk(req, line);
+
+    // Status polls and scrapes are not activity: they must not keep the
+    // controller out of idle mode
+    power_stats_t power;
+    power_manager_get_stats(&power);
+    snprintf(line, sizeof(line),
+             "# TYPE bdo_power_idle gauge\n"
+             "bdo_power_idle %d\n"
+             "# TYPE bdo_power_idle_entries_total counter\n"
+             "bdo_power_idle_entries_total %lu\n"
+             "# TYPE bdo_power_idle_seconds_total counter\n"
+             "bdo_power_idle_seconds_total %.3f\n",
+             power.idle ? 1 : 0, (unsigned long)power.idle_entries,
+             power.idle_time_ms / 1000.0);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_power_wakes_total Idle mode exits by cause\n"
+             "# TYPE bdo_power_wakes_total counter\n"
+             "bdo_power_wakes_total{source=\"state\"} %lu\n"
+             "bdo_power_wakes_total{source=\"encoder\"} %lu\n"
+             "bdo_power_wakes_total{source=\"network\"} %lu\n",
+             (unsigned long)power.wakes[POWER_WAKE_STATE],
+             (unsigned long)power.wakes[POWER_WAKE_ENCODER],
+             (unsigned long)power.wakes[POWER_WAKE_NETWORK]);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_power_wake_response_us Wake to first full-rate display refresh\n"
+             "# TYPE bdo_power_wake_response_us gauge\n"
+             "bdo_power_wake_response_us{kind=\"last\"} %lu\n"
+             "bdo_power_wake_response_us{kind=\"max\"} %lu\n",
+             (unsigned long)power.last_response_us, (unsigned long)power.max_response_us);
+    httpd_resp_sendstr_chunk(req, line);
+    snprintf(line, sizeof(line),
+             "# HELP bdo_power_idle_tick_lateness_max_us Worst display tick delay in idle mode\n"
+             "# TYPE bdo_power_idle_tick_lateness_max_us gauge\n"
+             "bdo_power_idle_tick_lateness_max_us %lu\n",
+             (unsigned long)power.max_tick_lateness_us);
+    httpd_resp_sendstr_chunk(req, line);
+
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
 /**
  * @brief Initialize web server
  */
 esp_err_t webserver_init(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_open_sockets = 4;
+    config.server_port = WEBSERVER_PORT;
+    config.max_open_sockets = WEBSERVER_MAX_OPEN_SOCKETS;
+    config.max_uri_handlers = WEBSERVER_MAX_URI_HANDLERS;
     config.lru_purge_enable = true;
+    config.recv_wait_timeout = WEBSERVER_RECV_TIMEOUT_S;
+    config.send_wait_timeout = WEBSERVER_SEND_TIMEOUT_S;
 
     ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
 
+    // Worker pool for deferred handlers
+    s_async_queue = xQueueCreateStatic(WEBSERVER_ASYNC_QUEUE_LEN, sizeof(async_request_t),
+                                       s_async_queue_storage, &s_async_queue_buf);
+    if (s_async_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create async request queue");
+        return ESP_FAIL;
+    }
+
+    for (int i = 0; i < WEBSERVER_ASYNC_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "http_worker_%d", i);
+        if (xTaskCreateStaticPinnedToCore(async_worker_task, name, WEBSERVER_WORKER_STACK_SIZE,
+                                          NULL, WEBSERVER_WORKER_PRIORITY, s_worker_stack[i],
+                                          &s_worker_tcb[i], 1) == NULL) {
+            ESP_LOGE(TAG, "Failed to create %s", name);
+            return ESP_FAIL;
+        }
+    }
+
     if (httpd_start(&server, &config) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start web server");
         return ESP_FAIL;
@@ -323,49 +1241,146 @@ esp_err_t webserver_init(void)
     httpd_uri_t uri_root = {
         .uri = "/",
         .method = HTTP_GET,
-        .handler = root_handler,
-        .user_ctx = NULL
+        .handler = async_dispatch,
+        .user_ctx = (void *)root_handler
     };
     httpd_register_uri_handler(server, &uri_root);
 
     httpd_uri_t uri_api_status = {
         .uri = "/api/status",
         .method = HTTP_GET,
-        .handler = api_status_handler,
-        .user_ctx = NULL
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_status_handler
     };
     httpd_register_uri_handler(server, &uri_api_status);
 
     httpd_uri_t uri_api_start = {
         .uri = "/api/start",
         .method = HTTP_POST,
-        .handler = api_start_fill_handler,
-        .user_ctx = NULL
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_start_fill_handler
     };
     httpd_register_uri_handler(server, &uri_api_start);
 
     httpd_uri_t uri_api_stop = {
         .uri = "/api/stop",
         .method = HTTP_POST,
-        .handler = api_stop_fill_handler,
-        .user_ctx = NULL
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_stop_fill_handler
     };
     httpd_register_uri_handler(server, &uri_api_stop);
 
+    httpd_uri_t uri_api_estop = {
+        .uri = "/api/estop",
+        .method = HTTP_POST,
+        .handler = api_estop_handler,   // Not deferred: see api_estop_handler
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_api_estop);
+
+    httpd_uri_t uri_api_estop_reset = {
+        .uri = "/api/estop/reset",
+        .method = HTTP_POST,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_estop_reset_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_estop_reset);
+
+    httpd_uri_t uri_api_estop_test = {
+        .uri = "/api/estop/test",
+        .method = HTTP_POST,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_estop_test_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_estop_test);
+
     httpd_uri_t uri_api_set_target = {
         .uri = "/api/set_target",
         .method = HTTP_POST,
-        .handler = api_set_target_handler,
-        .user_ctx = NULL
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_set_target_handler
     };
     httpd_register_uri_handler(server, &uri_api_set_target);
 
+    httpd_uri_t uri_api_batch = {
+        .uri = "/api/batch",
+        .method = HTTP_POST,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_batch_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_batch);
+
+    httpd_uri_t uri_api_checklist_get = {
+        .uri = "/api/checklist",
+        .method = HTTP_GET,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_checklist_get_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_checklist_get);
+
+    httpd_uri_t uri_api_checklist_set = {
+        .uri = "/api/checklist",
+        .method = HTTP_POST,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_checklist_set_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_checklist_set);
+
+    httpd_uri_t uri_api_profile = {
+        .uri = "/api/profile",
+        .method = HTTP_GET,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_profile_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_profile);
+
+    httpd_uri_t uri_api_profile_reset = {
+        .uri = "/api/profile/reset",
+        .method = HTTP_POST,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_profile_reset_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_profile_reset);
+
+    httpd_uri_t uri_api_flightrec = {
+        .uri = "/api/flightrec",
+        .method = HTTP_GET,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_flightrec_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_flightrec);
+
+    httpd_uri_t uri_api_flightrec_saved = {
+        .uri = "/api/flightrec/saved",
+        .method = HTTP_GET,
+        .handler = async_dispatch,
+        .user_ctx = (void *)api_flightrec_saved_handler
+    };
+    httpd_register_uri_handler(server, &uri_api_flightrec_saved);
+
+    httpd_uri_t uri_metrics = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = async_dispatch,
+        .user_ctx = (void *)metrics_handler
+    };
+    httpd_register_uri_handler(server, &uri_metrics);
+
     ESP_LOGI(TAG, "Web server started successfully");
     ESP_LOGI(TAG, "Access WebUI at http://<ESP32_IP>/");
 
     return ESP_OK;
 }
 
+void webserver_get_stats(webserver_stats_t *stats)
+{
+    if (stats) {
+        portENTER_CRITICAL(&s_stats_lock);
+        *stats = s_stats;
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
 /**
  * @brief Stop web server
  */
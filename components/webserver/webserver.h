@@ -9,6 +9,15 @@
 #include "esp_err.h"
 #include "system_state.h"
 
+/**
+ * @brief Web server request counters
+ */
+typedef struct {
+    uint32_t served;          // Requests handled by a worker
+    uint32_t rejected_busy;   // 503s because the request queue was full
+    uint32_t timed_out;       // Requests that ran out of time budget
+} webserver_stats_t;
+
 /**
  * @brief Initialize and start the web server
  * @return ESP_OK on success
@@ -21,4 +30,10 @@ esp_err_t webserver_init(void);
  */
 esp_err_t webserver_stop(void);
 
+/**
+ * @brief Get web server request counters
+ * @param stats Pointer to store counters
+ */
+void webserver_get_stats(webserver_stats_t *stats);
+
 #endif // WEBSERVER_H
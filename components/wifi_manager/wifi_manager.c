@@ -0,0 +1,310 @@
+/**
+ * @file wifi_manager.c
+ * @brief WiFi station connection manager implementation
+ *
+ * Attempt sequence after boot or a drop:
+ *   0: cached BSSID/channel (no scan), if a cache exists
+ *   1: all-channel scan, strongest AP
+ *   2+: all-channel scan after WIFI_BACKOFF_MIN_MS, doubling up to
+ *       WIFI_BACKOFF_MAX_MS
+ * Handlers run on the default event loop task; the retry timer on the
+ * esp_timer task. Statistics are read by other tasks under s_lock.
+ */
+
+#include "wifi_manager.h"
+#include "config.h"
+#include "system_state.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "WIFI_MGR";
+
+#define WIFI_NVS_NAMESPACE "wifi_mgr"
+#define WIFI_NVS_KEY_SSID "ssid"
+#define WIFI_NVS_KEY_BSSID "bssid"
+#define WIFI_NVS_KEY_CHANNEL "channel"
+
+/**
+ * @brief Last AP we were associated with
+ */
+typedef struct {
+    bool valid;
+    uint8_t bssid[6];
+    uint8_t channel;
+} ap_cache_t;
+
+static ap_cache_t s_cache = {0};
+static uint32_t s_attempt = 0;            // Attempts since the last successful connect
+static esp_timer_handle_t s_retry_timer = NULL;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_manager_stats_t s_stats = {0};
+static int64_t s_down_since_us = 0;       // 0 while connected or before the first connect
+
+/* =============================================================================
+ * AP CACHE (NVS)
+ * ===========================================================================*/
+
+static void cache_load(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;  // Nothing cached yet
+    }
+
+    // A cache for a different network is useless
+    char ssid[33] = {0};
+    size_t ssid_len = sizeof(ssid);
+    size_t bssid_len = sizeof(s_cache.bssid);
+    if (nvs_get_str(nvs, WIFI_NVS_KEY_SSID, ssid, &ssid_len) == ESP_OK &&
+        strcmp(ssid, WIFI_SSID) == 0 &&
+        nvs_get_blob(nvs, WIFI_NVS_KEY_BSSID, s_cache.bssid, &bssid_len) == ESP_OK &&
+        bssid_len == sizeof(s_cache.bssid) &&
+        nvs_get_u8(nvs, WIFI_NVS_KEY_CHANNEL, &s_cache.channel) == ESP_OK) {
+        s_cache.valid = true;
+        ESP_LOGI(TAG, "Cached AP " MACSTR " on channel %u",
+                 MAC2STR(s_cache.bssid), s_cache.channel);
+    }
+    nvs_close(nvs);
+}
+
+static void cache_store(const uint8_t *bssid, uint8_t channel)
+{
+    if (s_cache.valid && s_cache.channel == channel &&
+        memcmp(s_cache.bssid, bssid, sizeof(s_cache.bssid)) == 0) {
+        return;  // Unchanged: no flash write
+    }
+
+    memcpy(s_cache.bssid, bssid, sizeof(s_cache.bssid));
+    s_cache.channel = channel;
+    s_cache.valid = true;
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        nvs_set_str(nvs, WIFI_NVS_KEY_SSID, WIFI_SSID);
+        nvs_set_blob(nvs, WIFI_NVS_KEY_BSSID, bssid, sizeof(s_cache.bssid));
+        nvs_set_u8(nvs, WIFI_NVS_KEY_CHANNEL, channel);
+        ret = nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to cache AP: %s", esp_err_to_name(ret));
+    }
+}
+
+/* =============================================================================
+ * CONNECTION ATTEMPTS
+ * ===========================================================================*/
+
+static void connect_to(bool use_cache)
+{
+    wifi_config_t cfg = {
+        .sta = {
+            .ssid = WIFI_SSID,
+            .password = WIFI_PASSWORD,
+            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+        },
+    };
+
+    if (use_cache) {
+        cfg.sta.bssid_set = true;
+        memcpy(cfg.sta.bssid, s_cache.bssid, sizeof(cfg.sta.bssid));
+        cfg.sta.channel = s_cache.channel;
+        cfg.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        // Roamed or AP gone: pick the strongest AP of the network
+        cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        cfg.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+
+    esp_wifi_set_config(WIFI_IF_STA, &cfg);
+    esp_err_t ret = esp_wifi_connect();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_connect: %s", esp_err_to_name(ret));
+    }
+}
+
+static uint32_t backoff_ms(uint32_t step)
+{
+    uint32_t delay = WIFI_BACKOFF_MIN_MS;
+    while (step-- > 0 && delay < WIFI_BACKOFF_MAX_MS) {
+        delay *= 2;
+    }
+    return (delay < WIFI_BACKOFF_MAX_MS) ? delay : WIFI_BACKOFF_MAX_MS;
+}
+
+static void next_attempt(void)
+{
+    uint32_t attempt = s_attempt++;
+
+    if (attempt == 0 && s_cache.valid) {
+        connect_to(true);
+    } else if (attempt <= 1) {
+        connect_to(false);
+    } else {
+        uint32_t delay = backoff_ms(attempt - 2);
+        ESP_LOGI(TAG, "Retry %lu in %lu ms", (unsigned long)attempt, (unsigned long)delay);
+        esp_timer_start_once(s_retry_timer, (uint64_t)delay * 1000);
+    }
+}
+
+static void retry_timer_cb(void *arg)
+{
+    connect_to(false);
+}
+
+/* =============================================================================
+ * EVENT HANDLERS
+ * ===========================================================================*/
+
+static void on_disconnected(const wifi_event_sta_disconnected_t *event)
+{
+    if (g_system_state.wifi_connected) {
+        ESP_LOGW(TAG, "Link lost (reason %u)", event->reason);
+        s_attempt = 0;
+    }
+
+    g_system_state.wifi_connected = false;
+    xEventGroupClearBits(g_system_events, EVENT_WIFI_CONNECTED);
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_stats.connected) {
+        s_stats.connected = false;
+        s_down_since_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    next_attempt();
+}
+
+static void on_got_ip(void)
+{
+    wifi_ap_record_t ap;
+    bool have_ap = (esp_wifi_sta_get_ap_info(&ap) == ESP_OK);
+    if (have_ap) {
+        cache_store(ap.bssid, ap.primary);
+    }
+
+    uint32_t outage_ms = 0;
+    int64_t now = esp_timer_get_time();
+    bool reconnect = false;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_down_since_us != 0) {
+        reconnect = true;
+        outage_ms = (uint32_t)((now - s_down_since_us) / 1000);
+        s_stats.reconnect_count++;
+        s_stats.last_outage_ms = outage_ms;
+        s_stats.total_outage_ms += outage_ms;
+        if (outage_ms > s_stats.max_outage_ms) {
+            s_stats.max_outage_ms = outage_ms;
+        }
+        s_down_since_us = 0;
+    }
+    s_stats.connected = true;
+    if (have_ap) {
+        s_stats.channel = ap.primary;
+        memcpy(s_stats.bssid, ap.bssid, sizeof(s_stats.bssid));
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    s_attempt = 0;
+    g_system_state.wifi_connected = true;
+    xEventGroupSetBits(g_system_events, EVENT_WIFI_CONNECTED);
+
+    if (reconnect) {
+        ESP_LOGI(TAG, "Reconnected to " MACSTR " (ch %u, %d dBm) after %lu ms",
+                 MAC2STR(s_stats.bssid), s_stats.channel, have_ap ? ap.rssi : 0,
+                 (unsigned long)outage_ms);
+    } else {
+        ESP_LOGI(TAG, "Connected to " MACSTR " (ch %u, %d dBm) at %lu ms after boot",
+                 MAC2STR(s_stats.bssid), s_stats.channel, have_ap ? ap.rssi : 0,
+                 (unsigned long)(now / 1000));
+    }
+}
+
+static void wifi_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data)
+{
+    if (base == WIFI_EVENT && id == WIFI_EVENT_STA_START) {
+        next_attempt();
+    } else if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED) {
+        on_disconnected((const wifi_event_sta_disconnected_t *)data);
+    } else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
+        on_got_ip();
+    }
+}
+
+/* =============================================================================
+ * PUBLIC API
+ * ===========================================================================*/
+
+esp_err_t wifi_manager_init(void)
+{
+    cache_load();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_retry_timer));
+
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    esp_netif_create_default_wifi_sta();
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                                        wifi_event_handler, NULL, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                        wifi_event_handler, NULL, NULL));
+
+    // Config changes on every attempt: keep them out of flash
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_ERROR_CHECK(esp_wifi_start());
+
+    ESP_LOGI(TAG, "WiFi connecting to %s%s...", WIFI_SSID,
+             s_cache.valid ? " (cached AP)" : "");
+    return ESP_OK;
+}
+
+void wifi_manager_get_stats(wifi_manager_stats_t *stats)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    if (s_down_since_us != 0) {
+        stats->current_outage_ms = (uint32_t)((now - s_down_since_us) / 1000);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    wifi_ap_record_t ap;
+    stats->rssi_dbm = (stats->connected && esp_wifi_sta_get_ap_info(&ap) == ESP_OK) ? ap.rssi : 0;
+}
+
+esp_err_t wifi_manager_to_json(const wifi_manager_stats_t *stats, char *buf, size_t len)
+{
+    int n = snprintf(buf, len,
+                     "{\"device_id\":\"%s\",\"connected\":%s,\"rssi\":%d,\"channel\":%u,"
+                     "\"bssid\":\"" MACSTR "\",\"reconnects\":%lu,\"last_outage_ms\":%lu,"
+                     "\"max_outage_ms\":%lu,\"total_outage_ms\":%lu}",
+                     MQTT_DEVICE_ID, stats->connected ? "true" : "false", stats->rssi_dbm,
+                     stats->channel, MAC2STR(stats->bssid),
+                     (unsigned long)stats->reconnect_count, (unsigned long)stats->last_outage_ms,
+                     (unsigned long)stats->max_outage_ms, (unsigned long)stats->total_outage_ms);
+
+    return (n < 0 || (size_t)n >= len) ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
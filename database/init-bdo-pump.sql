@@ -89,13 +89,108 @@ CREATE INDEX IF NOT EXISTS idx_pump_status_device_time
 CREATE INDEX IF NOT EXISTS idx_pump_status_state
     ON pump_status (state, time DESC);
 
+-- ============================================================================
+-- TABLE 4: PUMP STATUS LATEST
+-- Last status row per device, upserted on every pump_status insert, so the
+-- current status is a primary key lookup however much history (and however
+-- many compressed chunks) pump_status holds
+-- ============================================================================
+
+CREATE TABLE IF NOT EXISTS pump_status_latest (
+    device_id TEXT PRIMARY KEY,
+    time TIMESTAMPTZ NOT NULL,
+    state TEXT NOT NULL,
+    current_weight_lbs DOUBLE PRECISION,
+    target_weight_lbs DOUBLE PRECISION,
+    progress_pct DOUBLE PRECISION,
+    current_pressure_pct DOUBLE PRECISION,
+    active_zone TEXT,
+    fill_elapsed_ms BIGINT,
+    fills_today INTEGER,
+    total_lbs_today DOUBLE PRECISION,
+    uptime_seconds BIGINT
+);
+
+-- Late or replayed rows (Telegraf retries, backfill) never replace a newer one
+CREATE OR REPLACE FUNCTION pump_status_latest_upsert() RETURNS TRIGGER AS $$
+BEGIN
+    INSERT INTO pump_status_latest AS l (
+        device_id, time, state, current_weight_lbs, target_weight_lbs,
+        progress_pct, current_pressure_pct, active_zone, fill_elapsed_ms,
+        fills_today, total_lbs_today, uptime_seconds)
+    VALUES (
+        NEW.device_id, NEW.time, NEW.state, NEW.current_weight_lbs, NEW.target_weight_lbs,
+        NEW.progress_pct, NEW.current_pressure_pct, NEW.active_zone, NEW.fill_elapsed_ms,
+        NEW.fills_today, NEW.total_lbs_today, NEW.uptime_seconds)
+    ON CONFLICT (device_id) DO UPDATE SET
+        time = EXCLUDED.time,
+        state = EXCLUDED.state,
+        current_weight_lbs = EXCLUDED.current_weight_lbs,
+        target_weight_lbs = EXCLUDED.target_weight_lbs,
+        progress_pct = EXCLUDED.progress_pct,
+        current_pressure_pct = EXCLUDED.current_pressure_pct,
+        active_zone = EXCLUDED.active_zone,
+        fill_elapsed_ms = EXCLUDED.fill_elapsed_ms,
+        fills_today = EXCLUDED.fills_today,
+        total_lbs_today = EXCLUDED.total_lbs_today,
+        uptime_seconds = EXCLUDED.uptime_seconds
+    WHERE l.time <= EXCLUDED.time;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS trg_pump_status_latest ON pump_status;
+CREATE TRIGGER trg_pump_status_latest
+    AFTER INSERT ON pump_status
+    FOR EACH ROW EXECUTE FUNCTION pump_status_latest_upsert();
+
+-- Seed from existing history when upgrading a database (no-op on a new one)
+INSERT INTO pump_status_latest
+SELECT DISTINCT ON (device_id)
+    device_id, time, state, current_weight_lbs, target_weight_lbs,
+    progress_pct, current_pressure_pct, active_zone, fill_elapsed_ms,
+    fills_today, total_lbs_today, uptime_seconds
+FROM pump_status
+ORDER BY device_id, time DESC
+ON CONFLICT (device_id) DO NOTHING;
+
+-- ============================================================================
+-- TABLE 5: PUMP FILL SAMPLES
+-- High-rate trace of each fill (10-50 Hz per device): weight, flow, DAC
+-- output, zone and ITV feedback by offset from the fill start
+-- ============================================================================
+
+-- Partitioned on fill_start, which every sample of a fill shares: a fill
+-- never straddles two chunks, and with segmentby (device_id, fill_number)
+-- it is exactly one compressed segment, however old. 6-hour chunks stay
+-- well under memory at 50 Hz for a few devices (~4.3M rows/device/day).
+CREATE TABLE IF NOT EXISTS pump_fill_samples (
+    fill_start TIMESTAMPTZ NOT NULL,
+    device_id TEXT NOT NULL,
+    fill_number INTEGER NOT NULL,
+    t_offset_ms INTEGER NOT NULL,
+    weight_lbs DOUBLE PRECISION,
+    flow_lbs_s DOUBLE PRECISION,
+    dac_pct DOUBLE PRECISION,
+    zone TEXT,
+    itv_feedback BOOLEAN
+);
+
+SELECT create_hypertable('pump_fill_samples', 'fill_start',
+    chunk_time_interval => INTERVAL '6 hours', if_not_exists => TRUE);
+
+-- One sample per offset: uploads can be retried with ON CONFLICT DO NOTHING
+CREATE UNIQUE INDEX IF NOT EXISTS idx_pump_fill_samples_fill
+    ON pump_fill_samples (device_id, fill_number, fill_start, t_offset_ms);
+
 -- ============================================================================
 -- VIEWS
 -- ============================================================================
 
--- Latest status for each pump device
+-- Latest status for each pump device (kept by trg_pump_status_latest; a
+-- device keeps its last row after pump_status retention drops its history)
 CREATE OR REPLACE VIEW latest_pump_status AS
-SELECT DISTINCT ON (device_id)
+SELECT
     time,
     device_id,
     state,
@@ -107,35 +202,42 @@ SELECT DISTINCT ON (device_id)
     fills_today,
     total_lbs_today,
     uptime_seconds
-FROM pump_status
-ORDER BY device_id, time DESC;
-
--- Daily pump summary
-CREATE OR REPLACE VIEW daily_pump_summary AS
-SELECT
-    DATE(time) as date,
-    device_id,
-    COUNT(*) FILTER (WHERE completion_status = 'success') as successful_fills,
-    COUNT(*) FILTER (WHERE completion_status = 'error') as error_fills,
-    COUNT(*) FILTER (WHERE completion_status = 'cancelled') as cancelled_fills,
-    SUM(actual_lbs) FILTER (WHERE completion_status = 'success') as total_lbs_dispensed,
-    AVG(actual_lbs) FILTER (WHERE completion_status = 'success') as avg_fill_lbs,
-    AVG(error_lbs) FILTER (WHERE completion_status = 'success') as avg_error_lbs,
-    STDDEV(error_lbs) FILTER (WHERE completion_status = 'success') as stddev_error_lbs,
-    AVG(fill_time_ms) FILTER (WHERE completion_status = 'success') / 1000.0 as avg_fill_time_sec,
-    MIN(error_lbs) as min_error,
-    MAX(error_lbs) as max_error
-FROM pump_fills
-GROUP BY DATE(time), device_id
-ORDER BY date DESC;
+FROM pump_status_latest
+ORDER BY device_id;
 
 -- ============================================================================
 -- CONTINUOUS AGGREGATES (Pre-computed materialized views)
+-- Hierarchical: pump_fills_daily rolls up pump_fills_hourly, not the raw
+-- table. The hourly aggregate therefore keeps sums, sums of squares and
+-- counts, which add up across buckets (averages and deviations do not).
+-- Real-time aggregation (materialized_only = false) answers the buckets
+-- the policies have not materialized yet from the level below, so
+-- dashboards are current without scanning raw history.
+-- Needs TimescaleDB 2.9+ (continuous aggregates on continuous aggregates).
 -- ============================================================================
 
--- Hourly fill statistics
+-- Databases created before the hierarchical layout must rebuild the rollups
+-- (stop here rather than replace daily_pump_summary over the old layout)
+\set saved_on_error_stop :ON_ERROR_STOP
+\set ON_ERROR_STOP on
+DO $$
+BEGIN
+    IF EXISTS (SELECT FROM timescaledb_information.continuous_aggregates
+               WHERE view_name = 'pump_fills_hourly')
+       AND NOT EXISTS (SELECT FROM information_schema.columns
+                       WHERE table_name = 'pump_fills_hourly' AND column_name = 'sum_error_lbs') THEN
+        RAISE EXCEPTION 'pump_fills_hourly has the pre-hierarchical layout'
+            USING HINT = 'DROP VIEW daily_pump_summary; DROP MATERIALIZED VIEW pump_fills_daily, '
+                         'pump_fills_hourly; re-run this script, then CALL refresh_continuous_aggregate() '
+                         'on pump_fills_hourly and pump_fills_daily with NULL, NULL. Aggregates older '
+                         'than the raw retention (90 days) are lost.';
+    END IF;
+END $$;
+\set ON_ERROR_STOP :saved_on_error_stop
+
+-- Hourly fill statistics (from raw pump_fills)
 CREATE MATERIALIZED VIEW IF NOT EXISTS pump_fills_hourly
-WITH (timescaledb.continuous) AS
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
 SELECT
     time_bucket('1 hour', time) AS bucket,
     device_id,
@@ -144,48 +246,158 @@ SELECT
     SUM(actual_lbs) as total_lbs,
     AVG(actual_lbs) as avg_lbs,
     STDDEV(actual_lbs) as stddev_lbs,
+    COUNT(error_lbs) as error_count,
+    SUM(error_lbs) as sum_error_lbs,
+    SUM(error_lbs * error_lbs) as sum_sq_error_lbs,
     AVG(error_lbs) as avg_error_lbs,
     STDDEV(error_lbs) as stddev_error_lbs,
+    SUM(fill_time_ms) as sum_fill_time_ms,
     AVG(fill_time_ms) / 1000.0 as avg_fill_time_sec,
     AVG(pressure_avg_pct) as avg_pressure_pct,
     MIN(actual_lbs) as min_lbs,
-    MAX(actual_lbs) as max_lbs
+    MAX(actual_lbs) as max_lbs,
+    MIN(error_lbs) as min_error_lbs,
+    MAX(error_lbs) as max_error_lbs
 FROM pump_fills
 GROUP BY bucket, device_id, completion_status
 WITH NO DATA;
 
--- Refresh policy: update every hour, looking back 2 hours
+-- Refresh policy: update every hour, looking back 3 days. pump_fills_daily
+-- only sees what is materialized here, and real-time aggregation only covers
+-- buckets above the watermark, so a fill uploaded late (device offline,
+-- telegraf buffer) must still be picked up by this policy; the look-back
+-- matches the daily policy's. Refreshes only recompute invalidated buckets.
 SELECT add_continuous_aggregate_policy('pump_fills_hourly',
-    start_offset => INTERVAL '2 hours',
+    start_offset => INTERVAL '3 days',
     end_offset => INTERVAL '1 hour',
     schedule_interval => INTERVAL '1 hour',
     if_not_exists => TRUE);
 
--- Daily fill statistics
+-- Databases created with the 2 hour look-back keep their policy above
+SELECT alter_job(j.job_id, config => jsonb_set(j.config, '{start_offset}', '"3 days"'))
+FROM timescaledb_information.jobs j
+JOIN timescaledb_information.continuous_aggregates ca
+  ON j.hypertable_schema = ca.materialization_hypertable_schema
+ AND j.hypertable_name = ca.materialization_hypertable_name
+WHERE ca.view_name = 'pump_fills_hourly'
+  AND j.proc_name = 'policy_refresh_continuous_aggregate'
+  AND (j.config->>'start_offset')::interval < INTERVAL '3 days';
+
+-- Daily fill statistics (rolled up from pump_fills_hourly, UTC days)
 CREATE MATERIALIZED VIEW IF NOT EXISTS pump_fills_daily
-WITH (timescaledb.continuous) AS
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
 SELECT
-    time_bucket('1 day', time) AS bucket,
+    time_bucket('1 day', bucket) AS bucket,
     device_id,
-    COUNT(*) as total_fills,
-    COUNT(*) FILTER (WHERE completion_status = 'success') as successful_fills,
-    COUNT(*) FILTER (WHERE completion_status = 'error') as error_fills,
-    COUNT(*) FILTER (WHERE completion_status = 'cancelled') as cancelled_fills,
-    SUM(actual_lbs) FILTER (WHERE completion_status = 'success') as total_lbs_dispensed,
-    AVG(actual_lbs) FILTER (WHERE completion_status = 'success') as avg_fill_lbs,
-    AVG(error_lbs) FILTER (WHERE completion_status = 'success') as avg_error_lbs,
-    AVG(fill_time_ms) FILTER (WHERE completion_status = 'success') / 1000.0 as avg_fill_time_sec
-FROM pump_fills
-GROUP BY bucket, device_id
+    SUM(fill_count)::BIGINT as total_fills,
+    (SUM(fill_count) FILTER (WHERE completion_status = 'success'))::BIGINT as successful_fills,
+    (SUM(fill_count) FILTER (WHERE completion_status = 'error'))::BIGINT as error_fills,
+    (SUM(fill_count) FILTER (WHERE completion_status = 'cancelled'))::BIGINT as cancelled_fills,
+    SUM(total_lbs) FILTER (WHERE completion_status = 'success') as total_lbs_dispensed,
+    SUM(total_lbs) FILTER (WHERE completion_status = 'success')
+        / NULLIF(SUM(fill_count) FILTER (WHERE completion_status = 'success'), 0) as avg_fill_lbs,
+    SUM(sum_error_lbs) FILTER (WHERE completion_status = 'success')
+        / NULLIF(SUM(error_count) FILTER (WHERE completion_status = 'success'), 0) as avg_error_lbs,
+    -- Sample standard deviation from n, sum and sum of squares
+    CASE WHEN SUM(error_count) FILTER (WHERE completion_status = 'success') > 1 THEN
+        SQRT(GREATEST(
+            (SUM(sum_sq_error_lbs) FILTER (WHERE completion_status = 'success')
+             - SUM(sum_error_lbs) FILTER (WHERE completion_status = 'success') ^ 2
+               / SUM(error_count) FILTER (WHERE completion_status = 'success'))
+            / (SUM(error_count) FILTER (WHERE completion_status = 'success') - 1), 0))
+    END as stddev_error_lbs,
+    SUM(sum_fill_time_ms) FILTER (WHERE completion_status = 'success')
+        / NULLIF(SUM(fill_count) FILTER (WHERE completion_status = 'success'), 0) / 1000.0
+        as avg_fill_time_sec,
+    MIN(min_error_lbs) as min_error,
+    MAX(max_error_lbs) as max_error
+FROM pump_fills_hourly
+GROUP BY time_bucket('1 day', bucket), device_id
 WITH NO DATA;
 
--- Refresh policy: update daily at midnight
+-- Refresh policy: update daily, after the hourly buckets it reads are in
 SELECT add_continuous_aggregate_policy('pump_fills_daily',
     start_offset => INTERVAL '3 days',
     end_offset => INTERVAL '1 day',
     schedule_interval => INTERVAL '1 day',
     if_not_exists => TRUE);
 
+-- Status trend per minute (from raw pump_status, 5 s snapshots)
+CREATE MATERIALIZED VIEW IF NOT EXISTS pump_status_1m
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT
+    time_bucket('1 minute', time) AS bucket,
+    device_id,
+    COUNT(*) as samples,
+    last(state, time) as state,
+    last(active_zone, time) as active_zone,
+    AVG(current_weight_lbs) as avg_weight_lbs,
+    MAX(current_weight_lbs) as max_weight_lbs,
+    AVG(current_pressure_pct) as avg_pressure_pct,
+    MAX(current_pressure_pct) as max_pressure_pct,
+    MAX(progress_pct) as max_progress_pct,
+    MAX(fills_today) as fills_today,
+    MAX(total_lbs_today) as total_lbs_today
+FROM pump_status
+GROUP BY bucket, device_id
+WITH NO DATA;
+
+SELECT add_continuous_aggregate_policy('pump_status_1m',
+    start_offset => INTERVAL '1 hour',
+    end_offset => INTERVAL '1 minute',
+    schedule_interval => INTERVAL '1 minute',
+    if_not_exists => TRUE);
+
+-- Per-fill summary of the sample traces (one row per fill). Grouped on the
+-- shared fill_start, so the bucket width only has to be a valid bucket
+CREATE MATERIALIZED VIEW IF NOT EXISTS pump_fill_sample_summary
+WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+SELECT
+    time_bucket('1 minute', fill_start) AS bucket,
+    device_id,
+    fill_number,
+    MIN(fill_start) as fill_start,
+    COUNT(*) as samples,
+    MAX(t_offset_ms) as duration_ms,
+    first(weight_lbs, t_offset_ms) as start_weight_lbs,
+    last(weight_lbs, t_offset_ms) as end_weight_lbs,
+    AVG(flow_lbs_s) as avg_flow_lbs_s,
+    MAX(flow_lbs_s) as max_flow_lbs_s,
+    AVG(dac_pct) as avg_dac_pct,
+    MAX(dac_pct) as max_dac_pct,
+    MIN(t_offset_ms) FILTER (WHERE itv_feedback) as first_feedback_ms,
+    AVG(CASE WHEN itv_feedback THEN 1.0 ELSE 0.0 END) as feedback_on_ratio
+FROM pump_fill_samples
+GROUP BY bucket, device_id, fill_number
+WITH NO DATA;
+
+-- A fill is complete well within end_offset; later uploads are caught
+-- by the look-back
+SELECT add_continuous_aggregate_policy('pump_fill_sample_summary',
+    start_offset => INTERVAL '1 day',
+    end_offset => INTERVAL '30 minutes',
+    schedule_interval => INTERVAL '15 minutes',
+    if_not_exists => TRUE);
+
+-- Daily pump summary (pump_fills_daily; days are UTC)
+DROP VIEW IF EXISTS daily_pump_summary;
+CREATE VIEW daily_pump_summary AS
+SELECT
+    (bucket AT TIME ZONE 'UTC')::date as date,
+    device_id,
+    successful_fills,
+    error_fills,
+    cancelled_fills,
+    total_lbs_dispensed,
+    avg_fill_lbs,
+    avg_error_lbs,
+    stddev_error_lbs,
+    avg_fill_time_sec,
+    min_error,
+    max_error
+FROM pump_fills_daily
+ORDER BY date DESC;
+
 -- ============================================================================
 -- DATA RETENTION POLICIES
 -- ============================================================================
@@ -194,10 +406,13 @@ SELECT add_continuous_aggregate_policy('pump_fills_daily',
 SELECT add_retention_policy('pump_fills', INTERVAL '90 days', if_not_exists => TRUE);
 SELECT add_retention_policy('pump_events', INTERVAL '90 days', if_not_exists => TRUE);
 SELECT add_retention_policy('pump_status', INTERVAL '30 days', if_not_exists => TRUE);
+SELECT add_retention_policy('pump_fill_samples', INTERVAL '180 days', if_not_exists => TRUE);
 
 -- Keep aggregated data for 2 years
 SELECT add_retention_policy('pump_fills_hourly', INTERVAL '2 years', if_not_exists => TRUE);
 SELECT add_retention_policy('pump_fills_daily', INTERVAL '2 years', if_not_exists => TRUE);
+SELECT add_retention_policy('pump_status_1m', INTERVAL '1 year', if_not_exists => TRUE);
+SELECT add_retention_policy('pump_fill_sample_summary', INTERVAL '2 years', if_not_exists => TRUE);
 
 -- ============================================================================
 -- COMPRESSION POLICIES (Optional - saves ~90% disk space)
@@ -219,10 +434,19 @@ ALTER TABLE pump_status SET (
     timescaledb.compress_segmentby = 'device_id, state'
 );
 
+-- One segment per fill, samples in offset order (delta encoding of the
+-- offsets, Gorilla for the values)
+ALTER TABLE pump_fill_samples SET (
+    timescaledb.compress,
+    timescaledb.compress_segmentby = 'device_id, fill_number',
+    timescaledb.compress_orderby = 't_offset_ms'
+);
+
 -- Compress data older than 7 days
 SELECT add_compression_policy('pump_fills', INTERVAL '7 days', if_not_exists => TRUE);
 SELECT add_compression_policy('pump_events', INTERVAL '7 days', if_not_exists => TRUE);
 SELECT add_compression_policy('pump_status', INTERVAL '3 days', if_not_exists => TRUE);
+SELECT add_compression_policy('pump_fill_samples', INTERVAL '1 day', if_not_exists => TRUE);
 
 -- ============================================================================
 -- PERMISSIONS
@@ -234,25 +458,44 @@ GRANT ALL PRIVILEGES ON ALL SEQUENCES IN SCHEMA public TO telegraf;
 
 -- ============================================================================
 -- USEFUL QUERIES (for Grafana dashboards)
+-- All read the continuous aggregates; hourly buckets also line up with
+-- local midnight for "today" in whole-hour time zones
 -- ============================================================================
 
 -- Total fills today
--- SELECT COUNT(*) FROM pump_fills WHERE time >= CURRENT_DATE AND completion_status = 'success';
+-- SELECT COALESCE(SUM(fill_count), 0) FROM pump_fills_hourly
+-- WHERE bucket >= CURRENT_DATE AND completion_status = 'success';
 
 -- Total pounds dispensed today
--- SELECT SUM(actual_lbs) FROM pump_fills WHERE time >= CURRENT_DATE AND completion_status = 'success';
+-- SELECT COALESCE(SUM(total_lbs), 0) FROM pump_fills_hourly
+-- WHERE bucket >= CURRENT_DATE AND completion_status = 'success';
 
 -- Fill accuracy trend (last 24 hours)
--- SELECT time_bucket('1 hour', time) AS time, AVG(error_lbs) as avg_error
--- FROM pump_fills
--- WHERE time >= NOW() - INTERVAL '24 hours' AND completion_status = 'success'
--- GROUP BY time_bucket('1 hour', time) ORDER BY time;
+-- SELECT bucket AS time, SUM(sum_error_lbs) / NULLIF(SUM(error_count), 0) as avg_error
+-- FROM pump_fills_hourly
+-- WHERE bucket >= NOW() - INTERVAL '24 hours' AND completion_status = 'success'
+-- GROUP BY bucket ORDER BY bucket;
 
 -- Current system status
 -- SELECT * FROM latest_pump_status;
 
 -- Fills per hour (last 7 days)
--- SELECT bucket, fill_count FROM pump_fills_hourly WHERE bucket >= NOW() - INTERVAL '7 days';
+-- SELECT bucket, SUM(fill_count) as fill_count FROM pump_fills_hourly
+-- WHERE bucket >= NOW() - INTERVAL '7 days' GROUP BY bucket ORDER BY bucket;
+
+-- Daily summary (last 30 days)
+-- SELECT * FROM daily_pump_summary WHERE date >= CURRENT_DATE - 30;
+
+-- One fill's curve (fill_start from pump_fill_sample_summary: one chunk, one segment)
+-- SELECT fill_start + t_offset_ms * INTERVAL '1 millisecond' AS time,
+--        weight_lbs, flow_lbs_s, dac_pct, itv_feedback::int AS itv_feedback
+-- FROM pump_fill_samples
+-- WHERE device_id = 'bdo_pump_01' AND fill_number = 1234 AND fill_start = '...'
+-- ORDER BY t_offset_ms;
+
+-- Pressure and weight trend (last 24 hours, per minute)
+-- SELECT bucket AS time, device_id, avg_pressure_pct, max_weight_lbs, state
+-- FROM pump_status_1m WHERE bucket >= NOW() - INTERVAL '24 hours' ORDER BY bucket;
 
 -- ============================================================================
 -- DONE!
@@ -266,18 +509,23 @@ GRANT ALL PRIVILEGES ON ALL SEQUENCES IN SCHEMA public TO telegraf;
 \echo '  - pump_fills (hypertable)'
 \echo '  - pump_events (hypertable)'
 \echo '  - pump_status (hypertable)'
+\echo '  - pump_status_latest (one row per device, trigger-maintained)'
+\echo '  - pump_fill_samples (hypertable, 10-50 Hz fill traces)'
 \echo ''
 \echo 'Created views:'
 \echo '  - latest_pump_status'
 \echo '  - daily_pump_summary'
 \echo ''
 \echo 'Created continuous aggregates:'
-\echo '  - pump_fills_hourly'
-\echo '  - pump_fills_daily'
+\echo '  - pump_fills_hourly (real-time)'
+\echo '  - pump_fills_daily (from pump_fills_hourly, real-time)'
+\echo '  - pump_status_1m (real-time)'
+\echo '  - pump_fill_sample_summary (per fill, real-time)'
 \echo ''
 \echo 'Configured:'
-\echo '  - Retention policies (90 days raw, 2 years aggregated)'
-\echo '  - Compression policies (compress after 7 days)'
+\echo '  - Retention policies (90 days raw, pump_status 30 days, pump_fill_samples 180 days;'
+\echo '    2 years aggregated, pump_status_1m 1 year)'
+\echo '  - Compression policies (after 7 days, pump_status 3 days, pump_fill_samples 1 day)'
 \echo '  - Indexes for fast queries'
 \echo ''
 \echo 'Ready to receive data from BDO Pump!'
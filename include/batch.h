@@ -0,0 +1,90 @@
+/**
+ * @file batch.h
+ * @brief Batch fill mode: a job of N drums at one target weight
+ *
+ * Drums are detected from the weight signal alone:
+ * - WAIT_DRUM: a steady reading between BATCH_DRUM_PRESENT_LBS and
+ *   BATCH_DRUM_MAX_TARE_LBS is an empty drum. Its weight is taken as the
+ *   tare (start_weight_lbs) and the fill starts at once.
+ * - RUNNING: safety checks, fill and settle run as for a single fill. The
+ *   first drum of a job runs every safety check, later drums only the
+ *   steps with SAFETY_SCOPE_DRUM.
+ * - WAIT_REMOVAL: after each fill, wait for a steady reading below
+ *   BATCH_DRUM_PRESENT_LBS before looking for the next drum.
+ *
+ * A cancelled or failed fill ends the job. batch_update() runs in the
+ * control task and does not allocate.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Batch job phase
+ */
+typedef enum {
+    BATCH_OFF = 0,          // No job (single fills)
+    BATCH_WAIT_DRUM,        // Waiting for an empty drum on the scale
+    BATCH_RUNNING,          // Checks, fill and settle of the current drum
+    BATCH_WAIT_REMOVAL      // Waiting for the filled drum to be taken off
+} batch_phase_t;
+
+/**
+ * @brief Batch job status
+ */
+typedef struct {
+    batch_phase_t phase;
+    uint16_t drums;             // Drums in the job
+    uint16_t done;              // Drums filled so far
+    float target_lbs;           // Net weight per drum
+    float tare_lbs;             // Tare of the current/last drum
+    uint32_t last_changeover_ms;// Previous fill end to this fill start (operator time)
+    bool aborted;               // Last job ended by cancel/error
+} batch_status_t;
+
+/**
+ * @brief Start a job (only while STATE_IDLE and no job is running)
+ * @param drums Number of drums (1..BATCH_MAX_DRUMS)
+ * @param target_lbs Net fill weight per drum
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE
+ */
+esp_err_t batch_start(uint16_t drums, float target_lbs);
+
+/**
+ * @brief End the job after the current drum (does not cancel a running fill)
+ */
+void batch_stop(void);
+
+/**
+ * @brief Advance the job (control task, every tick)
+ * @param now_us esp_timer time of this tick
+ */
+void batch_update(int64_t now_us);
+
+/**
+ * @brief Whether a job is running
+ */
+bool batch_active(void);
+
+/**
+ * @brief Whether the fill that is starting is a later drum of a job
+ * @return true to run only the per-drum safety steps (SAFETY_SCOPE_DRUM)
+ */
+bool batch_repeat_drum(void);
+
+/**
+ * @brief Copy the job status
+ * @param status Destination
+ */
+void batch_get_status(batch_status_t *status);
+
+/**
+ * @brief Phase name for JSON ("OFF", "WAIT_DRUM", ...)
+ */
+const char *batch_phase_to_string(batch_phase_t phase);
+
+#endif // BATCH_H
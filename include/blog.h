@@ -0,0 +1,96 @@
+/**
+ * @file blog.h
+ * @brief Binary deferred logger for hot paths
+ *
+ * BLOGn(id, ...) stores a timestamp, format ID and n raw 32-bit arguments
+ * in a lock-free multi-producer ring. Only a few hundred cycles are spent
+ * in the caller, with no formatting, locks or UART I/O. A low-priority
+ * drain task decodes the records against blog_formats.h and prints them
+ * through esp_log with their original timestamps.
+ *
+ * Safe to call from any task or ISR. When the ring is full new records are
+ * dropped and counted rather than blocking the caller.
+ */
+
+#ifndef BLOG_H
+#define BLOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "blog_formats.h"
+
+#define BLOG_MAX_ARGS 4
+
+typedef enum {
+#define BLOG_X_ENUM(id, level, tag, fmt) id,
+    BLOG_FORMATS(BLOG_X_ENUM)
+#undef BLOG_X_ENUM
+    BLOG_FORMAT_COUNT
+} blog_id_t;
+
+/**
+ * @brief Start the drain task
+ *
+ * Records written before this call are kept and printed once it runs.
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t blog_init(void);
+
+/**
+ * @brief Append one record (use the BLOGn macros)
+ * @param id Format ID
+ * @param nargs Number of valid entries in args
+ * @param args Raw 32-bit arguments
+ */
+void blog_write(blog_id_t id, uint32_t nargs, const uint32_t *args);
+
+/**
+ * @brief Number of records dropped because the ring was full
+ */
+uint32_t blog_dropped(void);
+
+/* Argument packing: floats by bit pattern, pointers and integers by value */
+static inline uint32_t blog_arg_f(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline uint32_t blog_arg_d(double d)
+{
+    return blog_arg_f((float)d);
+}
+
+static inline uint32_t blog_arg_p(const void *p)
+{
+    return (uint32_t)(uintptr_t)p;
+}
+
+static inline uint32_t blog_arg_i(uint32_t i)
+{
+    return i;
+}
+
+#define BLOG_U(x) _Generic((x),          \
+        float: blog_arg_f,               \
+        double: blog_arg_d,              \
+        char *: blog_arg_p,              \
+        const char *: blog_arg_p,        \
+        default: blog_arg_i)(x)
+
+#define BLOG0(id) \
+    blog_write((id), 0, NULL)
+#define BLOG1(id, a) \
+    blog_write((id), 1, (const uint32_t[]){BLOG_U(a)})
+#define BLOG2(id, a, b) \
+    blog_write((id), 2, (const uint32_t[]){BLOG_U(a), BLOG_U(b)})
+#define BLOG3(id, a, b, c) \
+    blog_write((id), 3, (const uint32_t[]){BLOG_U(a), BLOG_U(b), BLOG_U(c)})
+#define BLOG4(id, a, b, c, d) \
+    blog_write((id), 4, (const uint32_t[]){BLOG_U(a), BLOG_U(b), BLOG_U(c), BLOG_U(d)})
+
+#endif // BLOG_H
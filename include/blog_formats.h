@@ -0,0 +1,27 @@
+/**
+ * @file blog_formats.h
+ * @brief Format table for the binary deferred logger
+ *
+ * X(id, level, tag, format)
+ *
+ * Each argument is stored as one raw 32-bit word, so formats may only use
+ * 32-bit conversions without length modifiers: %d %i %u %x %X %c, %f %e %g
+ * (float), and %s for pointers to static strings (string literals, or the
+ * *_to_string() helpers). Append new entries at the end so IDs stay stable
+ * for off-device decoding.
+ */
+
+#ifndef BLOG_FORMATS_H
+#define BLOG_FORMATS_H
+
+#define BLOG_FORMATS(X) \
+    X(BLOG_ZONE_TRANSITION,  ESP_LOG_INFO, "MAIN",          "Zone transition: %s -> %s") \
+    X(BLOG_SCALE_READ_ERROR, ESP_LOG_WARN, "MAIN",          "Scale read error") \
+    X(BLOG_PID_RESET,        ESP_LOG_INFO, "PRESSURE_CTRL", "PID controller reset") \
+    X(BLOG_AUTOTUNE_PEAK,    ESP_LOG_INFO, "PRESSURE_CTRL", "Peak %d detected: %.2f lbs at %.2f sec") \
+    X(BLOG_DEADLINE_MISS,    ESP_LOG_WARN, "DEADLINE",      "Deadline miss: %s task %u us late") \
+    X(BLOG_BATCH_DRUM_PLACED, ESP_LOG_INFO, "BATCH",        "Drum %d/%d placed, tare %.2f lbs") \
+    X(BLOG_BATCH_DRUM_REMOVED, ESP_LOG_INFO, "BATCH",       "Drum removed, waiting for drum %d/%d") \
+    X(BLOG_BATCH_END,        ESP_LOG_INFO, "BATCH",         "Job ended: %d/%d drums filled%s")
+
+#endif // BLOG_FORMATS_H
@@ -20,6 +20,10 @@
 #define WIFI_SSID "YOUR_WIFI_SSID"
 #define WIFI_PASSWORD "YOUR_WIFI_PASSWORD"
 
+// Reconnect (see wifi_manager.h): cached AP first, then scan with backoff
+#define WIFI_BACKOFF_MIN_MS 250       // First delayed retry
+#define WIFI_BACKOFF_MAX_MS 30000     // Retry interval cap
+
 /* =============================================================================
  * MQTT CONFIGURATION
  * ===========================================================================*/
@@ -32,10 +36,15 @@
 #define MQTT_TOPIC_FILLS "factory/pump/fills"
 #define MQTT_TOPIC_EVENTS "factory/pump/events"
 #define MQTT_TOPIC_STATUS "factory/pump/status"
+#define MQTT_TOPIC_METRICS "factory/pump/metrics"
+#define MQTT_TOPIC_LINK "factory/pump/link"
+#define MQTT_TOPIC_ESTOP "factory/pump/estop"   // Subscribed: any message triggers the e-stop
 
 // MQTT Publishing intervals (milliseconds)
 #define MQTT_STATUS_INTERVAL_FILLING 5000   // 5 seconds during fill
 #define MQTT_STATUS_INTERVAL_IDLE 30000     // 30 seconds when idle
+#define MQTT_METRICS_INTERVAL 60000        // Task/stack metrics, any state
+#define MQTT_LINK_INTERVAL 10000           // WiFi RSSI/outages (also sent on reconnect)
 
 /* =============================================================================
  * NTP TIME SYNCHRONIZATION
@@ -73,6 +82,11 @@
 // ITV2030 PNP Feedback (pressure reached indicator)
 #define PIN_ITV_FEEDBACK 26 // NPN/PNP switch output from ITV2030
 
+// Emergency stop: NC mushroom switch from GPIO35 to GND, external 10k
+// pull-up to 3.3V (input-only pin, no internal pull). Open contact or a
+// broken wire reads high = stop.
+#define PIN_ESTOP 35
+
 // Note: Safety interlocks use LCD display + rotary encoder button
 // No separate safety buttons required - encoder SW pin (GPIO34) is used
 
@@ -101,6 +115,23 @@
 #define ZONE_SLOW_END 97.5f        // 85-97.5% of target
 #define ZONE_FINE_END 100.0f       // 97.5-100% of target
 
+// Pre-charge: while the last safety confirmation is pending, ramp the ITV to
+// a hold pressure below the pump's break-away pressure, so the air line is
+// charged when the fill starts but the pump does not stroke yet
+#define PRECHARGE_ENABLE 1         // 0 = DAC stays at 0 until STATE_FILLING
+#define PRECHARGE_PCT 15.0f        // Hold pressure (%); must be below pump break-away, verify on site
+#define PRECHARGE_RAMP_MS 500      // 0 to PRECHARGE_PCT ramp time
+#define FIRST_STROKE_LBS 0.3f      // Net weight rise that marks the first pump stroke (~0.5 lb/stroke)
+
+// Settle phase after cutoff (STATE_COMPLETED): the final weight is captured
+// as soon as the reading stops moving, not after a fixed hold
+#define SETTLE_BAND_LBS 0.1f       // Readings within ± this of each other are stable
+#define SETTLE_STABLE_MS 400       // Stable for this long = settled
+#define SETTLE_TIMEOUT_MS 3000     // Capture anyway after this (settle_stable = false)
+
+// Cancelled fill: pump off at once, "Fill cancelled" shown this long, then idle
+#define CANCEL_HOLD_MS 2000
+
 // Base pressure setpoints for each zone (percentage, 0-100%)
 // Based on real testing: 30 PSI min (2 pumps/sec) to 65 PSI max (5-6 pumps/sec)
 // Each pump = ~0.5 lb, so flow rates: 1.0-3.0 lb/sec
@@ -125,25 +156,185 @@
 // Control loop timing
 #define CONTROL_LOOP_INTERVAL_MS 100  // 10 Hz control loop
 
+// Control-path profiler (CPU cycle counter, per-stage histograms)
+#define CTRL_PROFILER_ENABLE 1        // 0 = instrumentation compiles out
+#define CTRL_PROFILER_HIST_BUCKETS 24 // log2(cycles) buckets, 1 cycle .. 16M cycles
+
+/* =============================================================================
+ * EMERGENCY STOP
+ * ===========================================================================*/
+// Input ISR and API/MQTT triggers zero the DAC register directly and latch
+// ERROR_ESTOP until reset (see estop.h)
+#define ESTOP_ACTIVE_LEVEL 1            // PIN_ESTOP level that means stop
+#define ESTOP_SELFTEST_RUNS 16          // Software-raised interrupts per latency self-test
+#define ESTOP_SELFTEST_TIMEOUT_US 1000  // A run fails if the ISR has not run by then
+
+/* =============================================================================
+ * ITV2030 RESPONSE MONITOR
+ * ===========================================================================*/
+// The feedback switch is timestamped by a GPIO interrupt: an upward DAC step
+// to the switch turning on is the pressure-reached latency (air supply
+// verification and PID dead time, see pressure_controller.h)
+#define ITV_STEP_MIN_PCT 5.0f           // DAC rise that starts a measured step
+#define ITV_RESPONSE_TIMEOUT_MS 3000    // Switch still off after this = no air supply
+#define ITV_RESPONSE_SLOW_MS 1000       // Response slower than this counts as degraded
+#define ITV_SLOW_STREAK_FAULT 3         // Consecutive degraded responses that raise ERROR_PRESSURE_FAULT
+#define ITV_DEAD_TIME_EWMA_SHIFT 2      // Dead-time average weight 1/4 per response
+
+/* =============================================================================
+ * DEADLINE SUPERVISION
+ * ===========================================================================*/
+// control_task and scale_task check in every period (see deadline_monitor.h);
+// a late check-in counts as a miss, a stopped task trips the task watchdog
+#define DEADLINE_CONTROL_SLACK_MS 20   // Control check-in lateness before it is a miss
+#define DEADLINE_SCALE_SLACK_MS 200    // Scale reads block on the UART for a frame
+#define DEADLINE_GUARD_PERIOD_MS 10    // DAC guard ISR period (gptimer)
+#define DEADLINE_GUARD_GRACE_MS 100    // Control lateness before the ISR zeroes the DAC
+
+// Worst case from the last control check-in to DAC = 0 (230 ms)
+#define DEADLINE_GUARD_BOUND_MS (CONTROL_LOOP_INTERVAL_MS + DEADLINE_CONTROL_SLACK_MS + \
+                                 DEADLINE_GUARD_GRACE_MS + DEADLINE_GUARD_PERIOD_MS)
+
+/* =============================================================================
+ * APPLICATION TASKS
+ * ===========================================================================*/
+// All application tasks use static stacks/TCBs (xTaskCreateStatic*), so
+// their RAM is fixed at link time and shows up in tools/mem_budget.
+// Stack sizes are in bytes; check margins on GET /metrics before shrinking.
+#define SCALE_TASK_STACK_SIZE 4096
+#define CONTROL_TASK_STACK_SIZE 4096
+#define DISPLAY_TASK_STACK_SIZE 4096
+#define MQTT_TASK_STACK_SIZE 6144
+
+// Startup: control-critical tasks first, network once they are ready
+// (see startup.h)
+#define STARTUP_READY_TIMEOUT_MS 5000  // Start the network anyway after this
+
+/* =============================================================================
+ * BINARY DEFERRED LOGGING
+ * ===========================================================================*/
+// Hot paths log format ID + raw args into a lock-free ring; a low-priority
+// task formats and prints them later (see blog.h / blog_formats.h)
+#define BLOG_RING_SIZE 128            // Records, must be a power of 2
+#define BLOG_DRAIN_INTERVAL_MS 100    // Drain task period
+#define BLOG_TASK_PRIORITY 1          // Below every control/network task
+#define BLOG_TASK_STACK_SIZE 3072
+
+/* =============================================================================
+ * FLIGHT RECORDER
+ * ===========================================================================*/
+// Every state/zone/safety/error transition goes into an RTC-retained ring,
+// which is saved to the flightrec partition on STATE_ERROR, panic or WDT reset
+#define FLIGHTREC_ENTRIES 64          // Ring entries (32 bytes each, RTC slow memory)
+#define FLIGHTREC_PARTITION_LABEL "flightrec"
+#define FLIGHTREC_TASK_PRIORITY 1     // Flash writes happen off the control path
+#define FLIGHTREC_TASK_STACK_SIZE 3072
+
+/* =============================================================================
+ * TASK MONITOR
+ * ===========================================================================*/
+// Per-task CPU %, per-core load and stack high-water marks from FreeRTOS
+// run-time stats (needs the trace/run-time options in sdkconfig.defaults)
+#define TASK_MONITOR_INTERVAL_MS 5000     // Sampling period (CPU % window)
+#define TASK_MONITOR_MAX_TASKS 32         // More tasks than this and sampling stops
+#define TASK_MONITOR_STACK_WARN_BYTES 512 // Log a warning below this much free stack
+#define TASK_MONITOR_TASK_PRIORITY 1
+#define TASK_MONITOR_TASK_STACK_SIZE 3072
+
+/* =============================================================================
+ * HEAP MONITOR
+ * ===========================================================================*/
+// Per-task allocation counts via heap hooks (CONFIG_HEAP_USE_HOOKS), sampled
+// with the task monitor
+#define HEAP_MONITOR_MAX_TASKS TASK_MONITOR_MAX_TASKS // Tasks with their own counters
+#define HEAP_MONITOR_MAX_GUARDED 4                 // Tasks that may call heap_monitor_forbid_alloc()
+#define HEAP_MONITOR_ASSERT_NO_ALLOC 0             // 1: abort on a guarded allocation (debug builds)
+#define HEAP_MONITOR_LARGEST_BLOCK_WARN_BYTES 8192 // Log a warning below this largest free block
+
+/* =============================================================================
+ * POWER MANAGEMENT
+ * ===========================================================================*/
+// Idle mode after a quiet spell in STATE_IDLE: DFS + automatic light sleep,
+// lower task rates; encoder or network command wakes it (see power_manager.h)
+#define POWER_IDLE_TIMEOUT_MS 60000          // Quiet time in STATE_IDLE before idle mode
+#define POWER_IDLE_CPU_FREQ_MHZ 80           // DFS floor (APB stays at 80 MHz for UART/I2C)
+#define POWER_IDLE_CONTROL_INTERVAL_MS 500   // Control loop period in idle mode
+#define POWER_IDLE_SCALE_INTERVAL_MS 1000    // Scale read period in idle mode
+#define POWER_IDLE_DISPLAY_INTERVAL_MS 1000  // Display redraw period in idle mode
+
+/* =============================================================================
+ * BATCH MODE
+ * ===========================================================================*/
+// Job of N drums: drum placement/removal from the weight signal, auto-tare,
+// per-drum safety checks only (see batch.h)
+#define BATCH_MAX_DRUMS 500
+#define BATCH_DRUM_PRESENT_LBS 10.0f   // Steady above this = a drum is on the scale
+#define BATCH_DRUM_MAX_TARE_LBS 60.0f  // Heavier than this is not an empty drum
+#define BATCH_STABLE_BAND_LBS 0.2f     // Readings within ± this are steady
+#define BATCH_STABLE_MS 1000           // Steady this long before placement/removal counts
+
+// Drums after the first of a job run only the checklist steps with
+// SAFETY_SCOPE_DRUM (default: tank position)
+
 /* =============================================================================
  * DISPLAY CONFIGURATION
  * ===========================================================================*/
 #define DISPLAY_UPDATE_INTERVAL_MS 200  // 5 Hz display update
 
+// LCD1602 over the PCF8574 backpack (4-bit mode). Frames are diffed against
+// a shadow of the glass and sent by a separate LCD task (see display_driver.h)
+#define LCD_COLS 16
+#define LCD_ROWS 2
+#define LCD_I2C_FREQ_HZ 400000          // PCF8574 fast mode
+#define LCD_I2C_TIMEOUT_MS 50           // Per frame transaction
+#define LCD_MERGE_GAP 1                 // Unchanged cells rewritten rather than a new cursor command
+#define LCD_TASK_PRIORITY 2             // Below display_task, which runs the safety sequence
+#define LCD_TASK_STACK_SIZE 2560
+
 // Menu system
 #define MENU_TIMEOUT_MS 30000  // Return to main screen after 30s inactivity
 
+// Rotary encoder (decoded by the PCNT peripheral, x4 quadrature)
+#define ENCODER_COUNTS_PER_DETENT 4     // KY-040: one full quadrature cycle per click
+#define ENCODER_GLITCH_NS 10000         // PCNT filter, pulses shorter than this are ignored
+#define ENCODER_PCNT_LIMIT 1000         // Hardware counter range, extended in software
+#define ENCODER_ACCEL_MID_DPS 8         // Detents/s from which each click counts ENCODER_ACCEL_MID_MULT
+#define ENCODER_ACCEL_MID_MULT 4
+#define ENCODER_ACCEL_FAST_DPS 20       // Detents/s from which each click counts ENCODER_ACCEL_FAST_MULT
+#define ENCODER_ACCEL_FAST_MULT 10
+
 /* =============================================================================
  * SAFETY SYSTEM CONFIGURATION
  * ===========================================================================*/
-#define SAFETY_CHECK_TIMEOUT_MS 30000  // 30 second timeout per check
-#define SAFETY_TOTAL_CHECKS 4          // 4-stage safety system
+// The checklist is loaded from NVS (NVS_KEY_SAFETY); these bound a site's table
+// and set the built-in default (see safety_system.h)
+#define SAFETY_CHECK_TIMEOUT_MS 30000  // Default step timeout
+#define SAFETY_STEP_TIMEOUT_MIN_MS 1000
+#define SAFETY_STEP_TIMEOUT_MAX_MS 300000
+#define SAFETY_ITV_HOLD_MS 300         // ITV feedback steady at the pre-charge before a step passes
+#define SAFETY_DEBOUNCE_MS 5           // Button line quiet this long before its level counts
+#define SAFETY_PRESS_QUEUE_LEN 4       // Debounced presses waiting for the display task
+#define SAFETY_STATE_POLL_MS 10        // State changes reach the LCD this fast during the checks
 
 /* =============================================================================
  * WEB SERVER CONFIGURATION
  * ===========================================================================*/
 #define WEBSERVER_PORT 80
 #define WEBSERVER_MAX_OPEN_SOCKETS 4
+#define WEBSERVER_MAX_URI_HANDLERS 20
+
+// Async request handling: handlers run on a small worker pool so a slow
+// client only ties up one worker, never the httpd task itself
+#define WEBSERVER_ASYNC_WORKERS 2          // Worker tasks serving deferred requests
+#define WEBSERVER_ASYNC_QUEUE_LEN 8        // Pending requests before 503 is returned
+#define WEBSERVER_WORKER_STACK_SIZE 6144
+#define WEBSERVER_WORKER_PRIORITY 3
+
+// Per-request time budgets
+#define WEBSERVER_RECV_TIMEOUT_S 2         // Socket recv timeout (per recv call)
+#define WEBSERVER_SEND_TIMEOUT_S 2         // Socket send timeout (per send call)
+#define WEBSERVER_REQUEST_BUDGET_MS 3000   // Total time allowed from accept to response
+#define WEBSERVER_MAX_BODY_LEN 256         // Largest accepted POST body (bytes)
 
 /* =============================================================================
  * DAC/AMPLIFIER CONFIGURATION
@@ -194,6 +385,10 @@
 #define NVS_KEY_KD "kd"
 #define NVS_KEY_TUNED "tuned"         // Flag: 0 = defaults, 1 = auto-tuned
 
+// NVS storage of the site's safety checklist
+#define NVS_SAFETY_NAMESPACE "safety"
+#define NVS_KEY_SAFETY "checklist"     // safety_checklist_t blob
+
 /* =============================================================================
  * POWER SYSTEM (24V)
  * ===========================================================================*/
@@ -0,0 +1,132 @@
+/**
+ * @file ctrl_profiler.h
+ * @brief Cycle-accurate control loop profiler
+ *
+ * Timestamps the stages of each control tick with the CPU cycle counter
+ * (Xtensa CCOUNT) and aggregates them into per-stage log2 histograms.
+ *
+ * Usage from the control task (pinned to one core, CCOUNT is per-core):
+ *
+ *   PROF_TICK_BEGIN();
+ *   ... read scale ...        PROF_MARK(PROF_STAGE_SAMPLE);
+ *   ... compute zone ...      PROF_MARK(PROF_STAGE_ZONE);
+ *   PROF_TICK_END();
+ *
+ * PROF_MARK() charges the cycles since the previous mark to the given stage.
+ * A stage marked several times in one tick is summed for that tick.
+ * All macros compile out when CTRL_PROFILER_ENABLE is 0.
+ *
+ * Cycles only convert to time at a known clock, and DFS lowers it in idle
+ * mode. Only ticks that ran wholly at the fastest clock seen are recorded;
+ * slower ticks (idle mode, a switch mid-tick) are counted as skipped. If a
+ * faster clock appears, the statistics restart at that clock.
+ */
+
+#ifndef CTRL_PROFILER_H
+#define CTRL_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "esp_err.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+typedef enum {
+    PROF_STAGE_SAMPLE = 0,    // Sample acquisition (weight snapshot)
+    PROF_STAGE_ESTIMATE,      // Progress / flow-rate estimation
+    PROF_STAGE_ZONE,          // Zone selection
+    PROF_STAGE_PID,           // PID / auto-tune compute
+    PROF_STAGE_DAC,           // DAC write
+    PROF_STAGE_TELEMETRY,     // Telemetry enqueue (MQTT)
+    PROF_STAGE_TICK,          // Whole control tick
+    PROF_STAGE_COUNT
+} prof_stage_t;
+
+/**
+ * @brief Aggregated statistics for one stage
+ */
+typedef struct {
+    uint32_t count;                               // Ticks in which the stage ran
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t hist[CTRL_PROFILER_HIST_BUCKETS];    // hist[i]: [2^i, 2^(i+1)) cycles
+} prof_stage_stats_t;
+
+/**
+ * @brief Profiler snapshot
+ */
+typedef struct {
+    uint32_t cpu_mhz;                             // Cycles per microsecond of the recorded ticks
+    uint32_t ticks;                               // Control ticks profiled
+    uint32_t skipped;                             // Ticks not at cpu_mhz (DFS), not recorded
+    uint32_t overruns;                            // Ticks longer than CONTROL_LOOP_INTERVAL_MS
+    prof_stage_stats_t stages[PROF_STAGE_COUNT];
+} prof_snapshot_t;
+
+/**
+ * @brief Get stage name for reports
+ */
+const char *ctrl_profiler_stage_name(prof_stage_t stage);
+
+/**
+ * @brief Copy current statistics
+ * @param out Destination snapshot
+ */
+void ctrl_profiler_snapshot(prof_snapshot_t *out);
+
+/**
+ * @brief Clear all statistics
+ */
+void ctrl_profiler_reset(void);
+
+/**
+ * @brief Serialize a snapshot as JSON
+ * @param snap Snapshot to serialize
+ * @param buf Destination buffer
+ * @param len Size of buf
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if buf is too small
+ */
+esp_err_t ctrl_profiler_to_json(const prof_snapshot_t *snap, char *buf, size_t len);
+
+/* Internal: used by the macros below */
+void ctrl_profiler_commit_tick(uint32_t tick_cycles);
+extern uint32_t g_prof_tick_start;
+extern uint32_t g_prof_tick_mhz;
+extern uint32_t g_prof_last_mark;
+extern uint32_t g_prof_tick_acc[PROF_STAGE_COUNT];
+extern uint32_t g_prof_tick_mask;
+
+static inline void ctrl_profiler_tick_begin(void)
+{
+    g_prof_tick_mhz = esp_rom_get_cpu_ticks_per_us();
+    g_prof_tick_start = esp_cpu_get_cycle_count();
+    g_prof_last_mark = g_prof_tick_start;
+    g_prof_tick_mask = 0;
+}
+
+static inline void ctrl_profiler_mark(prof_stage_t stage)
+{
+    uint32_t now = esp_cpu_get_cycle_count();
+    g_prof_tick_acc[stage] += now - g_prof_last_mark;
+    g_prof_tick_mask |= (1u << stage);
+    g_prof_last_mark = now;
+}
+
+static inline void ctrl_profiler_tick_end(void)
+{
+    ctrl_profiler_commit_tick(esp_cpu_get_cycle_count() - g_prof_tick_start);
+}
+
+#if CTRL_PROFILER_ENABLE
+#define PROF_TICK_BEGIN()   ctrl_profiler_tick_begin()
+#define PROF_MARK(stage)    ctrl_profiler_mark(stage)
+#define PROF_TICK_END()     ctrl_profiler_tick_end()
+#else
+#define PROF_TICK_BEGIN()   do { } while (0)
+#define PROF_MARK(stage)    do { } while (0)
+#define PROF_TICK_END()     do { } while (0)
+#endif
+
+#endif // CTRL_PROFILER_H
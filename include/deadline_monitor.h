@@ -0,0 +1,98 @@
+/**
+ * @file deadline_monitor.h
+ * @brief Deadline supervision of the real-time tasks
+ *
+ * Each real-time task checks in once per period with deadline_checkin().
+ * A check-in later than the previous period plus the task's slack counts
+ * as a deadline miss. Check-ins also feed the ESP-IDF task watchdog, which
+ * resets the chip (CONFIG_ESP_TASK_WDT_PANIC) if a task stops completely.
+ *
+ * The task watchdog takes seconds. The pump is covered faster by the DAC guard,
+ * a gptimer ISR in IRAM that runs every DEADLINE_GUARD_PERIOD_MS
+ * independently of the scheduler. If control_task misses its deadline by
+ * more than DEADLINE_GUARD_GRACE_MS, the ISR writes 0 to the DAC register
+ * directly. Pressure therefore stays applied for at most
+ * DEADLINE_GUARD_BOUND_MS after the last control check-in, even if the
+ * control task hangs in a loop with interrupts enabled.
+ */
+
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Supervised tasks
+ */
+typedef enum {
+    DEADLINE_TASK_CONTROL = 0,
+    DEADLINE_TASK_SCALE,
+    DEADLINE_TASK_COUNT
+} deadline_task_t;
+
+/**
+ * @brief Check-in statistics of one task (since boot)
+ */
+typedef struct {
+    uint32_t checkins;
+    uint32_t misses;
+    uint32_t last_gap_us;          // Time between the last two check-ins
+    uint32_t max_gap_us;
+    uint32_t max_late_us;          // Worst lateness past the deadline
+} deadline_task_stats_t;
+
+/**
+ * @brief Supervision statistics
+ */
+typedef struct {
+    deadline_task_stats_t tasks[DEADLINE_TASK_COUNT];
+    bool guard_armed;              // DAC guard ISR running
+    uint32_t guard_trips;          // Times the ISR zeroed the DAC
+} deadline_stats_t;
+
+/**
+ * @brief Create the DAC guard timer (started later by deadline_guard_arm())
+ * @return ESP_OK on success
+ */
+esp_err_t deadline_monitor_init(void);
+
+/**
+ * @brief Start supervising the calling task and subscribe it to the task watchdog
+ * @param task Which supervised task the caller is
+ * @param period_ms Time until its first check-in
+ * @return ESP_OK on success
+ */
+esp_err_t deadline_register(deadline_task_t task, uint32_t period_ms);
+
+/**
+ * @brief Check in once per period (calling task only)
+ * @param task Which supervised task the caller is
+ * @param period_ms Time until the next check-in (may change, e.g. in idle mode)
+ * @return true if the DAC guard tripped since the last check-in (control task)
+ */
+bool deadline_checkin(deadline_task_t task, uint32_t period_ms);
+
+/**
+ * @brief Start or stop the DAC guard ISR (control task)
+ *
+ * The running gptimer holds a PM lock, so the guard is disarmed in idle
+ * mode where the DAC is at zero anyway.
+ *
+ * @param armed Whether the guard should run
+ */
+void deadline_guard_arm(bool armed);
+
+/**
+ * @brief Copy the statistics
+ * @param stats Destination
+ */
+void deadline_get_stats(deadline_stats_t *stats);
+
+/**
+ * @brief Short name of a supervised task ("control", "scale")
+ */
+const char *deadline_task_name(deadline_task_t task);
+
+#endif // DEADLINE_MONITOR_H
@@ -1,6 +1,15 @@
 /**
  * @file display_driver.h
  * @brief LCD1602 display and rotary encoder driver
+ *
+ * display_update() renders into RAM and returns at once. A low-priority
+ * LCD task diffs each frame against what is on the glass and sends only
+ * the changed cells in one 400 kHz I2C transaction, so the display task
+ * (which also runs the safety sequence) never waits for the bus.
+ *
+ * The encoder is decoded in hardware by a PCNT unit (encoder.c), so turns
+ * between two display ticks are never lost. Faster spins step the target
+ * by a multiple of WEIGHT_INCREMENT_LBS (ENCODER_ACCEL_*).
  */
 
 #ifndef DISPLAY_DRIVER_H
@@ -8,22 +17,58 @@
 
 #include "esp_err.h"
 #include "system_state.h"
+#include <stdint.h>
 
 /**
- * @brief Initialize LCD display and rotary encoder
- * @return ESP_OK on success
+ * @brief LCD bus statistics (since boot)
+ */
+typedef struct {
+    uint32_t frames_rendered;      // display_update() calls
+    uint32_t frames_sent;          // Frames with at least one changed cell
+    uint32_t frames_unchanged;     // Frames identical to the glass (no bus traffic)
+    uint32_t cells_written;
+    uint32_t bytes_sent;           // PCF8574 bytes (4 per character or command)
+    uint32_t last_frame_us;        // Bus time of the last frame sent
+    uint32_t max_frame_us;
+    uint32_t full_frame_us;        // Bus time of the last full 32-cell rewrite
+    uint32_t i2c_errors;
+} display_stats_t;
+
+/**
+ * @brief Initialize the LCD I2C bus and controller, then start the LCD task
+ * @return ESP_OK on success, or the I2C error if the LCD does not respond
  */
 esp_err_t display_init(void);
 
+/**
+ * @brief Set up the PCNT unit for the rotary encoder
+ * @return ESP_OK on success
+ */
+esp_err_t display_encoder_init(void);
+
 /**
  * @brief Update display with current system state
+ *
+ * Renders the frame and queues it for the LCD task. A frame queued before
+ * the previous one was sent replaces it.
+ *
  * @param state Pointer to system state structure
- * @return ESP_OK on success
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if display_init() failed
  */
 esp_err_t display_update(system_state_t *state);
 
+/**
+ * @brief Copy the LCD bus statistics
+ * @param stats Destination
+ */
+void display_get_stats(display_stats_t *stats);
+
 /**
  * @brief Handle rotary encoder input
+ *
+ * Takes the detents counted since the last call. In STATE_IDLE they adjust
+ * the target weight; any turn updates last_interaction_ms.
+ *
  * @return ESP_OK on success
  */
 esp_err_t display_handle_encoder(void);
@@ -0,0 +1,104 @@
+/**
+ * @file estop.h
+ * @brief Emergency stop fast path
+ *
+ * Every trigger writes 0 straight to the DAC register and latches the stop,
+ * without waiting for any task:
+ * - PIN_ESTOP: a GPIO ISR in IRAM (runs while the flash cache is off).
+ * - POST /api/estop and MQTT_TOPIC_ESTOP: estop_trigger() in the caller's
+ *   task, inside a critical section.
+ *
+ * While latched, pressure_controller keeps the DAC at 0 whatever the
+ * control loop asks for, and control_task holds STATE_ERROR with
+ * ERROR_ESTOP. estop_reset() clears the latch once the input is released.
+ *
+ * estop_self_test() raises the GPIO interrupt in software and measures
+ * trigger-to-zero latency: from raising the interrupt to the DAC register
+ * write in the ISR.
+ */
+
+#ifndef ESTOP_H
+#define ESTOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief What tripped the stop
+ */
+typedef enum {
+    ESTOP_SOURCE_INPUT = 0,     // PIN_ESTOP
+    ESTOP_SOURCE_API,           // POST /api/estop
+    ESTOP_SOURCE_MQTT,          // Message on MQTT_TOPIC_ESTOP
+    ESTOP_SOURCE_COUNT
+} estop_source_t;
+
+/**
+ * @brief E-stop statistics (since boot)
+ */
+typedef struct {
+    bool latched;
+    estop_source_t source;              // Of the latched stop
+    uint32_t trips[ESTOP_SOURCE_COUNT];
+    uint32_t last_latency_us;           // Trigger to DAC zero, last stop
+    uint32_t max_latency_us;
+    uint32_t test_runs;                 // Self-test interrupts measured
+    uint32_t test_failures;             // Runs where the ISR did not fire in time
+    uint32_t test_min_us;
+    uint32_t test_max_us;
+} estop_stats_t;
+
+/**
+ * @brief Configure PIN_ESTOP and its ISR (latches at once if the input is asserted)
+ *
+ * Needs the GPIO ISR service, installed by app_main() before any driver.
+ * @return ESP_OK on success
+ */
+esp_err_t estop_init(void);
+
+/**
+ * @brief Zero the DAC and latch the stop (task context)
+ * @param source Trigger for the statistics
+ */
+void estop_trigger(estop_source_t source);
+
+/**
+ * @brief Whether a stop is latched
+ */
+bool estop_active(void);
+
+/**
+ * @brief Latch the stop if PIN_ESTOP is asserted (control task, every tick)
+ *
+ * Backstop for an edge missed while the chip was in light sleep.
+ */
+void estop_poll(void);
+
+/**
+ * @brief Clear the latch
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE while PIN_ESTOP is still asserted
+ */
+esp_err_t estop_reset(void);
+
+/**
+ * @brief Measure trigger-to-zero latency with ESTOP_SELFTEST_RUNS software interrupts
+ *
+ * Only while the pump is off (STATE_IDLE); the test does not latch a stop.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not idle, ESP_ERR_TIMEOUT if the ISR did not run
+ */
+esp_err_t estop_self_test(void);
+
+/**
+ * @brief Copy the statistics
+ * @param stats Destination
+ */
+void estop_get_stats(estop_stats_t *stats);
+
+/**
+ * @brief Source name for metrics ("input", "api", "mqtt")
+ */
+const char *estop_source_name(estop_source_t source);
+
+#endif // ESTOP_H
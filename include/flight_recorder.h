@@ -0,0 +1,121 @@
+/**
+ * @file flight_recorder.h
+ * @brief Always-on flight recorder of state transitions
+ *
+ * Every system state, fill zone, safety state and error transition is
+ * appended to a fixed-size ring with its esp_timer timestamp and the key
+ * process values at that moment. The ring lives in RTC slow memory that is
+ * not initialized on soft reset, so it survives panics, watchdog resets and
+ * esp_restart().
+ *
+ * The ring is saved to the flightrec partition when the system enters
+ * STATE_ERROR, and on the first boot after a panic or watchdog reset.
+ * Only the most recent dump is kept. Transitions are normally recorded
+ * through the setters in state_transition.h.
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef enum {
+    FLIGHTREC_BOOT = 0,       // Boot marker, to = esp_reset_reason_t
+    FLIGHTREC_STATE,          // system_state_enum_t
+    FLIGHTREC_ZONE,           // fill_zone_t
+    FLIGHTREC_SAFETY,         // safety_state_t
+    FLIGHTREC_ERROR           // error_code_t
+} flightrec_kind_t;
+
+typedef enum {
+    FLIGHTREC_TRIGGER_ERROR = 0,  // STATE_ERROR entered
+    FLIGHTREC_TRIGGER_PANIC,      // Previous boot ended in a panic
+    FLIGHTREC_TRIGGER_WDT         // Previous boot ended in a watchdog reset
+} flightrec_trigger_t;
+
+/**
+ * @brief One recorded transition (32 bytes)
+ */
+typedef struct {
+    int64_t timestamp_us;     // esp_timer time within its boot
+    uint32_t boot;            // Boot counter, increments on every reset
+    uint8_t kind;             // flightrec_kind_t
+    uint8_t from;             // Previous value
+    uint8_t to;               // New value
+    uint8_t reserved;
+    float weight_lbs;         // Scale reading at the transition
+    float pressure_pct;       // Pressure setpoint at the transition
+    float target_lbs;         // Fill target at the transition
+    uint32_t fill_number;     // Lifetime fill counter
+} flightrec_entry_t;
+
+/**
+ * @brief Header of a dump saved to flash
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t boot;            // Boot that wrote the dump
+    uint32_t trigger;         // flightrec_trigger_t
+    uint32_t count;           // Entries following the header, oldest first
+} flightrec_dump_header_t;
+
+/**
+ * @brief Validate the retained ring and save it if the last reset was a crash
+ *
+ * Call early in app_main. Transitions recorded before this call are ignored.
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t flightrec_init(void);
+
+/**
+ * @brief Append a transition, snapshotting weight/pressure/target
+ * @param kind Transition kind
+ * @param from Previous value
+ * @param to New value
+ */
+void flightrec_record(flightrec_kind_t kind, uint8_t from, uint8_t to);
+
+/**
+ * @brief Ask the recorder task to save the ring to flash
+ *
+ * Non-blocking; the flash write happens in a low-priority task.
+ *
+ * @param trigger Reason for the dump
+ */
+void flightrec_trigger_save(flightrec_trigger_t trigger);
+
+/**
+ * @brief Copy the live ring, oldest entry first
+ * @param out Destination array
+ * @param max Capacity of out
+ * @return Number of entries copied
+ */
+size_t flightrec_copy(flightrec_entry_t *out, size_t max);
+
+/**
+ * @brief Read the last dump saved to flash
+ * @param header Filled with the dump header
+ * @param out Destination array (FLIGHTREC_ENTRIES entries is always enough)
+ * @param max Capacity of out
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if no partition or no valid dump
+ */
+esp_err_t flightrec_load_saved(flightrec_dump_header_t *header, flightrec_entry_t *out, size_t max);
+
+/**
+ * @brief Format one entry as a JSON object
+ * @param entry Entry to format
+ * @param buf Output buffer (128 bytes is enough)
+ * @param len Buffer size
+ * @return ESP_OK, or ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t flightrec_entry_to_json(const flightrec_entry_t *entry, char *buf, size_t len);
+
+/**
+ * @brief Name of a dump trigger
+ */
+const char *flightrec_trigger_to_string(flightrec_trigger_t trigger);
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,78 @@
+/**
+ * @file heap_monitor.h
+ * @brief Heap allocation and fragmentation telemetry
+ *
+ * ESP-IDF heap hooks (CONFIG_HEAP_USE_HOOKS, see sdkconfig.defaults) count
+ * every allocation and free per calling task. heap_monitor_sample() adds
+ * free heap, the largest free block and their minimums since boot, so a
+ * slowly fragmenting heap shows up in the MQTT metrics and on GET /metrics
+ * long before an allocation fails.
+ *
+ * A task that calls heap_monitor_forbid_alloc() after its own startup
+ * must not allocate again. Violations are counted, and abort with a
+ * backtrace of the offending task when HEAP_MONITOR_ASSERT_NO_ALLOC is 1.
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stdint.h>
+#include "config.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @brief Allocation counters of one task (cumulative since boot)
+ */
+typedef struct {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t alloc_bytes;
+} heap_monitor_task_counts_t;
+
+/**
+ * @brief Heap state at one sample
+ */
+typedef struct {
+    uint32_t free_bytes;            // Internal 8-bit capable heap
+    uint32_t min_free_bytes;        // Low-water mark since boot
+    uint32_t largest_block;         // Largest single allocation possible now
+    uint32_t min_largest_block;     // Smallest largest_block seen by any sample
+    float fragmentation_pct;        // 100 - largest_block / free_bytes
+    uint32_t allocs;                // All tasks, since boot
+    uint32_t frees;
+    float alloc_rate;               // Allocations per second since the last sample
+    uint32_t guard_violations;      // Allocations by tasks after heap_monitor_forbid_alloc()
+    uint32_t untracked_allocs;      // Allocations by tasks beyond HEAP_MONITOR_MAX_TASKS
+} heap_monitor_stats_t;
+
+/**
+ * @brief Start allocation-rate tracking
+ * @return ESP_OK, or ESP_ERR_NOT_SUPPORTED if heap hooks are not enabled
+ */
+esp_err_t heap_monitor_init(void);
+
+/**
+ * @brief Mark the end of the calling task's startup: it must not allocate again
+ * @return ESP_OK, or ESP_ERR_NO_MEM if HEAP_MONITOR_MAX_GUARDED tasks are guarded
+ */
+esp_err_t heap_monitor_forbid_alloc(void);
+
+/**
+ * @brief Get the allocation counters of one task
+ * @param task Task handle
+ * @param counts Destination (zeroed if the task never allocated)
+ */
+void heap_monitor_task_counts(TaskHandle_t task, heap_monitor_task_counts_t *counts);
+
+/**
+ * @brief Sample the heap and update the minimums and allocation rate
+ *
+ * Meant to be called periodically from one task (the task monitor).
+ *
+ * @param stats Destination
+ */
+void heap_monitor_sample(heap_monitor_stats_t *stats);
+
+#endif // HEAP_MONITOR_H
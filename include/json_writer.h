@@ -0,0 +1,72 @@
+/**
+ * @file json_writer.h
+ * @brief Bounded JSON serialization into a caller-provided buffer
+ *
+ * printf-style appends for the *_to_json() serializers. The first append
+ * that does not fit marks the writer as overflowed and later appends do
+ * nothing, so a serializer appends unconditionally and checks the result
+ * once at the end:
+ *
+ *   json_writer_t w;
+ *   json_writer_init(&w, buf, len);
+ *   json_writer_append(&w, "{\"ticks\":%lu}", ticks);
+ *   return json_writer_status(&w);
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t pos;           // Bytes written, excluding the NUL
+    bool overflow;        // An append did not fit
+} json_writer_t;
+
+static inline void json_writer_init(json_writer_t *w, char *buf, size_t len)
+{
+    w->buf = buf;
+    w->len = len;
+    w->pos = 0;
+    w->overflow = (len == 0);
+    if (len > 0) {
+        buf[0] = '\0';
+    }
+}
+
+static inline void json_writer_append(json_writer_t *w, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static inline void json_writer_append(json_writer_t *w, const char *fmt, ...)
+{
+    if (w->overflow) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->pos, w->len - w->pos, fmt, args);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= w->len - w->pos) {
+        w->overflow = true;
+        return;
+    }
+    w->pos += n;
+}
+
+/**
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if an append did not fit
+ */
+static inline esp_err_t json_writer_status(const json_writer_t *w)
+{
+    return w->overflow ? ESP_ERR_INVALID_SIZE : ESP_OK;
+}
+
+#endif // JSON_WRITER_H
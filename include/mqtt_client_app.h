@@ -11,6 +11,10 @@
 
 /**
  * @brief Start MQTT client
+ *
+ * Subscribes to MQTT_TOPIC_ESTOP; any message there calls
+ * estop_trigger(ESTOP_SOURCE_MQTT) from the MQTT event handler.
+ *
  * @return ESP_OK on success
  */
 esp_err_t mqtt_app_start(void);
@@ -36,4 +40,18 @@ esp_err_t mqtt_publish_status(system_state_t *state);
  */
 esp_err_t mqtt_publish_event(const char *event, const char *details);
 
+/**
+ * @brief Publish task/stack metrics (JSON from task_monitor_to_json)
+ * @param json Payload for MQTT_TOPIC_METRICS
+ * @return ESP_OK on success
+ */
+esp_err_t mqtt_publish_metrics(const char *json);
+
+/**
+ * @brief Publish WiFi link statistics (JSON from wifi_manager_to_json)
+ * @param json Payload for MQTT_TOPIC_LINK
+ * @return ESP_OK on success
+ */
+esp_err_t mqtt_publish_link(const char *json);
+
 #endif // MQTT_CLIENT_APP_H
@@ -0,0 +1,95 @@
+/**
+ * @file power_manager.h
+ * @brief Idle-time power management
+ *
+ * After POWER_IDLE_TIMEOUT_MS in STATE_IDLE with no encoder input or
+ * network command, the controller enters idle mode: the CPU frequency
+ * lock is released so DFS drops to POWER_IDLE_CPU_FREQ_MHZ, automatic
+ * light sleep is allowed between ticks, and the control, scale and display
+ * tasks run at their POWER_IDLE_* intervals. Any activity leaves idle mode
+ * at once.
+ *
+ * Wake sources while asleep: the encoder GPIOs (so encoder edges are not
+ * lost), the FreeRTOS tick timer and WiFi (DTIM beacons). The scale UART
+ * (UART2) cannot wake the ESP32 from light sleep, so scale reads in idle
+ * mode hold a no-sleep lock for the duration of the read.
+ *
+ * Needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE (see
+ * sdkconfig.defaults); without them only the lower task rates apply.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief What ended idle mode
+ */
+typedef enum {
+    POWER_WAKE_STATE = 0,       // System left STATE_IDLE
+    POWER_WAKE_ENCODER,         // Encoder turned or pressed
+    POWER_WAKE_NETWORK,         // WebUI/API command
+    POWER_WAKE_COUNT
+} power_wake_source_t;
+
+/**
+ * @brief Power management statistics
+ */
+typedef struct {
+    bool idle;                      // Currently in idle mode
+    uint32_t idle_entries;
+    uint32_t idle_time_ms;          // Total time in idle mode since boot
+    uint32_t wakes[POWER_WAKE_COUNT];
+    uint32_t last_response_us;      // Activity to first full-rate display refresh
+    uint32_t max_response_us;
+    uint32_t max_tick_lateness_us;  // Worst display tick delay in idle mode (sleep exit)
+} power_stats_t;
+
+/**
+ * @brief Configure DFS/light sleep and wake sources; starts in active mode
+ * @return ESP_OK, or ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE
+ */
+esp_err_t power_manager_init(void);
+
+/**
+ * @brief Report activity: leaves idle mode and restarts the idle timeout
+ * @param source What happened
+ */
+void power_manager_activity(power_wake_source_t source);
+
+/**
+ * @brief Periodic check from the control task: enter idle mode when due
+ */
+void power_manager_update(void);
+
+/**
+ * @brief Whether idle mode is active
+ */
+bool power_manager_is_idle(void);
+
+/**
+ * @brief Keep the chip out of light sleep (counted; pair with _end)
+ */
+void power_manager_stay_awake_begin(void);
+void power_manager_stay_awake_end(void);
+
+/**
+ * @brief Record the display tick timing (display task, every loop)
+ *
+ * Closes a pending wake-to-response measurement, and in idle mode tracks
+ * how late the tick ran because of light-sleep exit.
+ *
+ * @param lateness_us How much later than scheduled this tick started
+ */
+void power_manager_display_tick(uint32_t lateness_us);
+
+/**
+ * @brief Copy the statistics
+ * @param stats Destination
+ */
+void power_manager_get_stats(power_stats_t *stats);
+
+#endif // POWER_MANAGER_H
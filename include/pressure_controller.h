@@ -1,6 +1,21 @@
 /**
  * @file pressure_controller.h
  * @brief ITV2030 pressure controller (DAC output 0-10V) with PID control
+ *
+ * The ITV2030 switch output (PIN_ITV_FEEDBACK) turns on when the outlet
+ * pressure is within band of the setpoint. A GPIO interrupt timestamps
+ * its edges. A DAC write that raises the output by ITV_STEP_MIN_PCT or
+ * more starts a measured step; the next rising edge ends it, and the time
+ * between is the pressure-reached latency. That latency is used three ways:
+ * - Air supply verification: no response within ITV_RESPONSE_TIMEOUT_MS
+ *   (a miss), or ITV_SLOW_STREAK_FAULT slow responses in a row within one
+ *   fill sequence, is reported by pressure_controller_check_air().
+ * - Safety ITV steps take the switch-on time from the interrupt.
+ * - Dead time: its running average holds the PID integral after each
+ *   step, so the integral does not wind up on error the ITV has not had
+ *   time to act on.
+ * A step that never takes the switch off (the new setpoint was within
+ * the band) is dropped at the timeout as in-band.
  */
 
 #ifndef PRESSURE_CONTROLLER_H
@@ -8,9 +23,27 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief ITV response statistics (since boot)
+ */
+typedef struct {
+    uint32_t steps;                 // Measured upward steps
+    uint32_t reached;               // Switch turned on
+    uint32_t missed;                // Still off at ITV_RESPONSE_TIMEOUT_MS
+    uint32_t in_band;               // Switch never left the band
+    uint32_t last_response_us;      // DAC step to switch on
+    uint32_t max_response_us;
+    uint32_t dead_time_us;          // Running average (ITV_DEAD_TIME_EWMA_SHIFT)
+    uint32_t slow_streak;           // Consecutive responses over ITV_RESPONSE_SLOW_MS, this fill
+    uint32_t faults;                // Reported by pressure_controller_check_air()
+} itv_stats_t;
 
 /**
  * @brief Initialize DAC and pressure control
+ *
+ * Needs the GPIO ISR service (ITV feedback), installed by app_main().
  * @return ESP_OK on success
  */
 esp_err_t pressure_controller_init(void);
@@ -28,6 +61,38 @@ esp_err_t pressure_controller_set_percent(float percent);
  */
 bool pressure_controller_get_feedback(void);
 
+/**
+ * @brief When the ITV feedback switch last turned on
+ * @return esp_timer time of the rising edge, or 0 if the switch is off
+ */
+int64_t pressure_controller_feedback_on_since_us(void);
+
+/**
+ * @brief Check the air supply from the ITV response (control task)
+ *
+ * Closes a step that has been pending for ITV_RESPONSE_TIMEOUT_MS (miss or
+ * in-band) and reports a degraded supply once; the slow streak restarts
+ * after it is reported.
+ *
+ * @return ESP_OK, ESP_ERR_TIMEOUT on a miss, ESP_ERR_INVALID_RESPONSE after
+ *         ITV_SLOW_STREAK_FAULT slow responses in a row
+ */
+esp_err_t pressure_controller_check_air(void);
+
+/**
+ * @brief Restart the slow-response streak for a new fill sequence
+ *
+ * Called by safety_begin(), so slow responses from earlier fills never add
+ * up to a fault.
+ */
+void pressure_controller_itv_new_sequence(void);
+
+/**
+ * @brief Copy the ITV response statistics
+ * @param stats Destination
+ */
+void pressure_controller_get_itv_stats(itv_stats_t *stats);
+
 /**
  * @brief Set PID parameters
  * @param kp Proportional gain
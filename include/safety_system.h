@@ -1,15 +1,22 @@
 /**
  * @file safety_system.h
- * @brief 4-stage safety interlock system using LCD prompts
+ * @brief Table-driven safety checklist using LCD prompts
  *
- * Safety checks displayed on LCD, confirmed with rotary encoder button.
- * Sequence:
- *   1. Air line connection check
- *   2. Fill hose connection check
- *   3. Tank/valve position check
- *   4. Final start confirmation
+ * The checklist is a table of up to SAFETY_MAX_STEPS steps, loaded from
+ * NVS at boot (built-in default: the 4-stage air line / fill hose / tank
+ * position / start sequence). Each step has:
+ * - a prompt for LCD line 2;
+ * - how it is confirmed: the encoder button, or the ITV2030 feedback
+ *   switch reporting the pre-charge pressure (air supply verified by the
+ *   instrument, no operator action);
+ * - a scope: every drum, or once per batch job (first drum only);
+ * - its own timeout.
  *
- * Each check shows prompt on LCD and waits for encoder button press.
+ * Step n of the table runs as safety_state SAFETY_STEP_1 + n. Presses are
+ * detected by a GPIO interrupt and debounced by a gptimer, so a
+ * confirmation takes effect within a few ms instead of at the next display
+ * tick. Only presses made while a prompt is shown count. Steps outside the
+ * sequence's scope are passed over silently.
  */
 
 #ifndef SAFETY_SYSTEM_H
@@ -17,28 +24,170 @@
 
 #include "esp_err.h"
 #include "system_state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SAFETY_PROMPT_CHARS 16          // One LCD line
+#define SAFETY_CHECKLIST_VERSION 1      // Layout of safety_checklist_t in NVS
+
+/**
+ * @brief How a step is confirmed
+ */
+typedef enum {
+    SAFETY_CONFIRM_BUTTON = 0,          // Operator presses the encoder button
+    SAFETY_CONFIRM_ITV_FEEDBACK,        // ITV switch on at the pre-charge pressure
+    SAFETY_CONFIRM_COUNT
+} safety_confirm_t;
+
+/**
+ * @brief Which sequences run a step
+ */
+typedef enum {
+    SAFETY_SCOPE_DRUM = 0,              // Every fill
+    SAFETY_SCOPE_BATCH,                 // Single fills and the first drum of a batch job
+    SAFETY_SCOPE_COUNT
+} safety_scope_t;
+
+/**
+ * @brief One checklist step (fixed layout, stored in NVS)
+ */
+typedef struct {
+    char prompt[SAFETY_PROMPT_CHARS + 1];
+    uint8_t confirm;                    // safety_confirm_t
+    uint8_t scope;                      // safety_scope_t
+    uint8_t reserved;
+    uint32_t timeout_ms;
+} safety_step_t;
+
+/**
+ * @brief Checklist table (fixed layout, stored in NVS as one blob)
+ */
+typedef struct {
+    uint8_t version;                    // SAFETY_CHECKLIST_VERSION
+    uint8_t count;                      // Steps in use, 1 .. SAFETY_MAX_STEPS
+    uint8_t reserved[2];
+    safety_step_t steps[SAFETY_MAX_STEPS];
+} safety_checklist_t;
+
+/**
+ * @brief Safety sequence statistics (since boot)
+ */
+typedef struct {
+    uint32_t presses;              // Presses that confirmed a step
+    uint32_t last_latency_us;      // First button edge to step advanced
+    uint32_t max_latency_us;
+    uint32_t auto_confirms;        // Steps confirmed by an instrument
+    uint32_t sequences;            // Sequences that passed
+    uint32_t last_sequence_ms;     // safety_begin() to the last step confirmed
+} safety_stats_t;
 
 /**
- * @brief Initialize safety system
+ * @brief Initialize safety system and load the checklist from NVS
+ *
+ * Needs the GPIO ISR service (button), installed by app_main().
  * @return ESP_OK on success
  */
 esp_err_t safety_init(void);
 
+/**
+ * @brief Whether safety_init() succeeded with a checklist loaded
+ *
+ * Fills must not be started otherwise: safety_run_checks() fails every
+ * sequence (ESP_FAIL) until then.
+ */
+bool safety_ready(void);
+
+/**
+ * @brief Arm a new check sequence (back to SAFETY_IDLE)
+ *
+ * Call when the system enters STATE_SAFETY_CHECK, so a sequence never
+ * inherits SAFETY_COMPLETE from the previous fill. A checklist set with
+ * safety_set_checklist() takes effect here.
+ *
+ * @param repeat_drum Run only SAFETY_SCOPE_DRUM steps (batch drums after the first)
+ */
+void safety_begin(bool repeat_drum);
+
+/**
+ * @brief End the sequence started by safety_begin()
+ *
+ * Call when the system leaves STATE_SAFETY_CHECK. Stops the debounce
+ * timer (it blocks light sleep while enabled) and drops queued presses.
+ */
+void safety_end(void);
+
+/**
+ * @brief Block until a button press is queued or the timeout expires
+ *
+ * Used by the display task instead of a fixed delay during the checks, so
+ * safety_run_checks() runs as soon as the operator presses. The press stays
+ * queued until safety_run_checks() takes it (button steps) or drops it
+ * (ITV feedback steps).
+ *
+ * @param timeout_ms Longest wait
+ * @return true if a press is waiting
+ */
+bool safety_wait_press(uint32_t timeout_ms);
+
 /**
  * @brief Run safety check sequence (non-blocking state machine)
  *
  * Call this repeatedly from display task. Updates g_system_state.safety_state.
- * Displays prompts on LCD and waits for encoder button confirmation.
+ * Displays prompts on LCD and waits for each step's confirmation.
  *
  * @return ESP_OK if all checks complete, ESP_FAIL on timeout/cancel
  */
 esp_err_t safety_run_checks(void);
 
+/**
+ * @brief Whether the control task should pre-charge the ITV now
+ *
+ * True during the last step of the sequence and during ITV feedback
+ * steps, which need the pre-charge pressure (PRECHARGE_*).
+ */
+bool safety_precharge_pending(void);
+
 /**
  * @brief Cancel safety check sequence
  */
 void safety_cancel(void);
 
+/**
+ * @brief Copy the checklist in use (or pending for the next sequence)
+ * @param checklist Destination
+ */
+void safety_get_checklist(safety_checklist_t *checklist);
+
+/**
+ * @brief Validate a checklist, save it to NVS and use it from the next sequence
+ *
+ * Rejected unless every step has a prompt, a known confirm/scope and a
+ * timeout within SAFETY_STEP_TIMEOUT_MIN_MS .. SAFETY_STEP_TIMEOUT_MAX_MS,
+ * and at least one button step is left: a single fill or batch job never
+ * starts without an operator at the machine. ITV steps need
+ * PRECHARGE_ENABLE.
+ *
+ * @param checklist New table
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if rejected, or the NVS error
+ */
+esp_err_t safety_set_checklist(const safety_checklist_t *checklist);
+
+/**
+ * @brief Copy the sequence statistics
+ * @param stats Destination
+ */
+void safety_get_stats(safety_stats_t *stats);
+
+/**
+ * @brief Name of a confirmation type ("button", "itv")
+ */
+const char *safety_confirm_name(safety_confirm_t confirm);
+
+/**
+ * @brief Name of a scope ("drum", "batch")
+ */
+const char *safety_scope_name(safety_scope_t scope);
+
 /**
  * @brief Get current safety check prompt text
  * @param line1 Buffer for LCD line 1 (16 chars + null)
@@ -0,0 +1,69 @@
+/**
+ * @file startup.h
+ * @brief Dependency-aware startup sequencing
+ *
+ * The control-critical tasks (scale, control, display/safety) are created
+ * first and initialize their peripherals in parallel. Each one reports
+ * completion with startup_stage_done(), which sets its EVENT_*_READY bit in
+ * g_system_events, and waits with startup_wait() for the stages it depends
+ * on before entering its loop. app_main() waits for EVENT_SYSTEM_READY and
+ * only then brings up WiFi, MQTT and the web server, so network start-up
+ * never delays the first fill after a power blip.
+ *
+ * "Finished" and "healthy" are kept apart: the ready bit only says a stage
+ * is done, startup_faults() says whether its init failed. Fills are only
+ * accepted while startup_healthy().
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "system_state.h"
+
+/**
+ * @brief Mark a startup stage as finished
+ *
+ * The ready bit is set even if init failed, so dependent stages still run
+ * (and report the fault) instead of blocking; the failure is logged and
+ * recorded in startup_faults().
+ *
+ * @param ready_bit EVENT_*_READY bit of the stage
+ * @param result Result of the stage's init function
+ */
+void startup_stage_done(EventBits_t ready_bit, esp_err_t result);
+
+/**
+ * @brief Wait for startup stages
+ * @param ready_bits EVENT_*_READY bits to wait for (all of them)
+ * @param timeout_ms Maximum wait
+ * @return true if all stages are done, false on timeout
+ */
+bool startup_wait(EventBits_t ready_bits, uint32_t timeout_ms);
+
+/**
+ * @brief Stages whose init failed
+ * @return EVENT_*_READY bits of the failed stages (0 if none)
+ */
+EventBits_t startup_faults(void);
+
+/**
+ * @brief Whether every EVENT_SYSTEM_READY stage finished and none failed
+ */
+bool startup_healthy(void);
+
+/**
+ * @brief Name of a stage ("scale", "control", "display")
+ * @param ready_bit EVENT_*_READY bit of the stage
+ */
+const char *startup_stage_name(EventBits_t ready_bit);
+
+/**
+ * @brief Time from boot (esp_timer start) until all of EVENT_SYSTEM_READY
+ * @return Milliseconds, or 0 if the system is not ready yet or a stage failed
+ */
+uint32_t startup_boot_to_ready_ms(void);
+
+#endif // STARTUP_H
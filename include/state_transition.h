@@ -0,0 +1,81 @@
+/**
+ * @file state_transition.h
+ * @brief Setters for the state fields of g_system_state
+ *
+ * All changes to state, active_zone, safety_state and error go through
+ * these functions so every transition is captured by the flight recorder.
+ * Setting a field to its current value does nothing.
+ *
+ * A system state change is also posted to g_system_events, so consumers
+ * wake at once instead of noticing it on their next period:
+ * - EVENT_STATE_CHANGED_CONTROL / _DISPLAY on every change. control_task
+ *   waits on its bit between ticks and zeroes the DAC as soon as a stop or
+ *   error is posted.
+ * - EVENT_FILL_START on entering STATE_FILLING, EVENT_ERROR on entering
+ *   STATE_ERROR (latched until mqtt_task consumes them).
+ * - EVENT_SAFETY_COMPLETE while safety_state is SAFETY_COMPLETE.
+ */
+
+#ifndef STATE_TRANSITION_H
+#define STATE_TRANSITION_H
+
+#include "system_state.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Transition statistics (since boot)
+ */
+typedef struct {
+    uint32_t transitions;          // System state changes
+    uint32_t stops;                // Stop/error posted by another task, acted on by control_task
+    uint32_t last_stop_us;         // Stop/error posted to DAC at zero
+    uint32_t max_stop_us;
+} state_transition_stats_t;
+
+/**
+ * @brief Change the system state machine state
+ *
+ * Entering STATE_ERROR also saves the flight recorder to flash; leaving it
+ * clears the error code.
+ */
+void state_set_system(system_state_enum_t state);
+
+/**
+ * @brief Change the active fill zone
+ */
+void state_set_zone(fill_zone_t zone);
+
+/**
+ * @brief Change the safety check state
+ */
+void state_set_safety(safety_state_t state);
+
+/**
+ * @brief Change the current error code
+ */
+void state_set_error(error_code_t error);
+
+/**
+ * @brief esp_timer time of the last system state change
+ */
+int64_t state_changed_us(void);
+
+/**
+ * @brief Whether the calling task made the last system state change
+ */
+bool state_changed_by_caller(void);
+
+/**
+ * @brief Record how long a stop/error took to reach the DAC (control task)
+ * @param latency_us State change to DAC write
+ */
+void state_record_stop_latency(uint32_t latency_us);
+
+/**
+ * @brief Copy the transition statistics
+ * @param stats Destination
+ */
+void state_get_stats(state_transition_stats_t *stats);
+
+#endif // STATE_TRANSITION_H
@@ -40,12 +40,18 @@ typedef enum {
  * SAFETY CHECK STATE
  * ===========================================================================*/
 
+#define SAFETY_MAX_STEPS 8      // Checklist table size (safety_system.h)
+
 typedef enum {
     SAFETY_IDLE = 0,
-    SAFETY_AIR_CHECK,
-    SAFETY_HOSE_CHECK,
-    SAFETY_POSITION_CHECK,
-    SAFETY_START_CHECK,
+    SAFETY_STEP_1,              // Step n of the checklist is SAFETY_STEP_1 + n
+    SAFETY_STEP_2,
+    SAFETY_STEP_3,
+    SAFETY_STEP_4,
+    SAFETY_STEP_5,
+    SAFETY_STEP_6,
+    SAFETY_STEP_7,
+    SAFETY_STEP_8,
     SAFETY_COMPLETE,
     SAFETY_TIMEOUT,
     SAFETY_CANCELLED
@@ -65,7 +71,9 @@ typedef enum {
     ERROR_OVERFILL,
     ERROR_WIFI_DISCONNECTED,
     ERROR_AUTOTUNE_TIMEOUT,
-    ERROR_AUTOTUNE_FAILED
+    ERROR_AUTOTUNE_FAILED,
+    ERROR_CONTROL_STALL,            // Control task missed its deadline, DAC guard tripped
+    ERROR_ESTOP                     // Emergency stop latched (estop.h)
 } error_code_t;
 
 /* =============================================================================
@@ -98,7 +106,13 @@ typedef struct {
     float target_weight_lbs;
     float current_weight_lbs;
     float start_weight_lbs;
-    float actual_dispensed_lbs;
+    float actual_dispensed_lbs;     // Settled weight - start weight (last fill)
+    float cutoff_weight_lbs;        // Weight when the pump was stopped (last fill)
+    float spill_lbs;                // In-flight material after cutoff (settled - cutoff)
+    uint32_t settle_time_ms;        // Cutoff to settled weight
+    bool settle_stable;             // false if the settle phase timed out
+    bool precharged;                // ITV was at the pre-charge hold when the fill started
+    uint32_t first_stroke_ms;       // Start confirmation to first weight rise (0 = none yet)
     float pressure_setpoint_pct;
 
     // Fill tracking
@@ -149,10 +163,21 @@ typedef struct {
 #define EVENT_WIFI_CONNECTED (1 << 0)
 #define EVENT_MQTT_CONNECTED (1 << 1)
 #define EVENT_SCALE_READY (1 << 2)
-#define EVENT_FILL_START (1 << 3)
-#define EVENT_FILL_COMPLETE (1 << 4)
-#define EVENT_SAFETY_COMPLETE (1 << 5)
-#define EVENT_ERROR (1 << 6)
+#define EVENT_FILL_START (1 << 3)         // Entered STATE_FILLING (latched for mqtt_task)
+#define EVENT_FILL_COMPLETE (1 << 4)      // Fill settled and counted (latched for mqtt_task)
+#define EVENT_SAFETY_COMPLETE (1 << 5)    // Level: safety_state is SAFETY_COMPLETE
+#define EVENT_ERROR (1 << 6)              // Entered STATE_ERROR (latched for mqtt_task)
+#define EVENT_CONTROL_READY (1 << 7)
+#define EVENT_DISPLAY_READY (1 << 8)
+
+/* System state changed, one bit per consumer so each clears only its own
+ * (set by state_set_system(), see state_transition.h) */
+#define EVENT_STATE_CHANGED_CONTROL (1 << 9)
+#define EVENT_STATE_CHANGED_DISPLAY (1 << 10)
+#define EVENT_STATE_CHANGED (EVENT_STATE_CHANGED_CONTROL | EVENT_STATE_CHANGED_DISPLAY)
+
+/* Control-critical path is up: the pump can fill (see startup.h) */
+#define EVENT_SYSTEM_READY (EVENT_SCALE_READY | EVENT_CONTROL_READY | EVENT_DISPLAY_READY)
 
 /* =============================================================================
  * GLOBAL VARIABLES (extern declarations)
@@ -196,6 +221,28 @@ static inline const char* zone_to_string(fill_zone_t zone)
     }
 }
 
+/**
+ * @brief Convert safety state enum to string
+ */
+static inline const char* safety_to_string(safety_state_t state)
+{
+    switch (state) {
+        case SAFETY_IDLE: return "IDLE";
+        case SAFETY_STEP_1: return "STEP_1";
+        case SAFETY_STEP_2: return "STEP_2";
+        case SAFETY_STEP_3: return "STEP_3";
+        case SAFETY_STEP_4: return "STEP_4";
+        case SAFETY_STEP_5: return "STEP_5";
+        case SAFETY_STEP_6: return "STEP_6";
+        case SAFETY_STEP_7: return "STEP_7";
+        case SAFETY_STEP_8: return "STEP_8";
+        case SAFETY_COMPLETE: return "COMPLETE";
+        case SAFETY_TIMEOUT: return "TIMEOUT";
+        case SAFETY_CANCELLED: return "CANCELLED";
+        default: return "UNKNOWN";
+    }
+}
+
 /**
  * @brief Convert error code to string
  */
@@ -212,6 +259,8 @@ static inline const char* error_to_string(error_code_t error)
         case ERROR_WIFI_DISCONNECTED: return "WIFI_DISCONNECTED";
         case ERROR_AUTOTUNE_TIMEOUT: return "AUTOTUNE_TIMEOUT";
         case ERROR_AUTOTUNE_FAILED: return "AUTOTUNE_FAILED";
+        case ERROR_CONTROL_STALL: return "CONTROL_STALL";
+        case ERROR_ESTOP: return "ESTOP";
         default: return "UNKNOWN";
     }
 }
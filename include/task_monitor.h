@@ -0,0 +1,76 @@
+/**
+ * @file task_monitor.h
+ * @brief FreeRTOS task runtime and stack telemetry
+ *
+ * Samples uxTaskGetSystemState() every TASK_MONITOR_INTERVAL_MS and keeps
+ * the latest per-task CPU % (of one core, over the last interval), per-core
+ * load, stack high-water marks, heap statistics and deadline misses. Published on MQTT_TOPIC_METRICS and
+ * served as Prometheus text on GET /metrics.
+ *
+ * Requires CONFIG_FREERTOS_USE_TRACE_FACILITY,
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS and
+ * CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID (see sdkconfig.defaults).
+ */
+
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "esp_err.h"
+#include "heap_monitor.h"
+#include "deadline_monitor.h"
+
+#define TASK_MONITOR_MAX_CORES 2
+#define TASK_MONITOR_NO_AFFINITY 0xff
+
+/**
+ * @brief One task in a sample
+ */
+typedef struct {
+    char name[16];
+    uint8_t core;              // Pinned core, or TASK_MONITOR_NO_AFFINITY
+    uint8_t priority;          // Current priority
+    float cpu_pct;             // Share of one core over the last interval
+    uint32_t stack_free_bytes; // Minimum free stack since the task started
+    uint32_t allocs;           // Heap allocations since boot (heap_monitor.h)
+    uint32_t alloc_bytes;
+} task_monitor_task_t;
+
+/**
+ * @brief Latest sample of all tasks
+ */
+typedef struct {
+    int64_t sample_time_us;                       // esp_timer time of the sample
+    uint32_t interval_us;                         // Run-time counter span covered
+    uint32_t task_count;
+    uint32_t tasks_dropped;                       // Tasks beyond TASK_MONITOR_MAX_TASKS (no sample)
+    float core_load_pct[TASK_MONITOR_MAX_CORES];  // 100 - idle task share
+    heap_monitor_stats_t heap;                    // Heap sampled at the same time
+    deadline_stats_t deadlines;                   // RT task check-ins (deadline_monitor.h)
+    task_monitor_task_t tasks[TASK_MONITOR_MAX_TASKS];
+} task_monitor_snapshot_t;
+
+/**
+ * @brief Start the sampling task
+ * @return ESP_OK on success
+ */
+esp_err_t task_monitor_init(void);
+
+/**
+ * @brief Copy the latest sample
+ * @param snap Destination (task_count is 0 until the first full interval)
+ */
+void task_monitor_snapshot(task_monitor_snapshot_t *snap);
+
+/**
+ * @brief Format a sample as compact JSON for MQTT
+ * @param snap Sample to format
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return ESP_OK, or ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t task_monitor_to_json(const task_monitor_snapshot_t *snap, char *buf, size_t len);
+
+#endif // TASK_MONITOR_H
@@ -0,0 +1,60 @@
+/**
+ * @file wifi_manager.h
+ * @brief WiFi station connection manager
+ *
+ * Keeps the station connected to WIFI_SSID and tracks link quality:
+ * - Fast rejoin: the BSSID and channel of the last AP are cached in NVS and
+ *   the first attempt after boot or a drop goes straight to that AP without
+ *   a full scan.
+ * - If that fails (the AP is gone, or we roamed), the next attempt scans
+ *   all channels and joins the strongest AP, then retries back off
+ *   exponentially from WIFI_BACKOFF_MIN_MS to WIFI_BACKOFF_MAX_MS.
+ * - g_system_state.wifi_connected and EVENT_WIFI_CONNECTED follow the
+ *   link (set on got-IP, cleared on disconnect).
+ */
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * @brief Link statistics
+ */
+typedef struct {
+    bool connected;
+    int8_t rssi_dbm;               // Current RSSI, 0 if not connected
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t reconnect_count;      // Successful reconnects since boot
+    uint32_t last_outage_ms;       // Duration of the most recent outage
+    uint32_t max_outage_ms;        // Longest outage since boot
+    uint32_t total_outage_ms;      // Sum of all outages since boot
+    uint32_t current_outage_ms;    // Time since the link dropped, 0 if connected
+} wifi_manager_stats_t;
+
+/**
+ * @brief Initialize netif/WiFi, register event handlers and start connecting
+ * @return ESP_OK on success
+ */
+esp_err_t wifi_manager_init(void);
+
+/**
+ * @brief Read the current link statistics (RSSI sampled now)
+ * @param stats Destination
+ */
+void wifi_manager_get_stats(wifi_manager_stats_t *stats);
+
+/**
+ * @brief Format link statistics as compact JSON for MQTT
+ * @param stats Statistics to format
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return ESP_OK, or ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t wifi_manager_to_json(const wifi_manager_stats_t *stats, char *buf, size_t len);
+
+#endif // WIFI_MANAGER_H
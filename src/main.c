@@ -21,17 +21,17 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_log.h"
-#include "esp_event.h"
 #include "esp_timer.h"
 #include "nvs_flash.h"
-#include "esp_netif.h"
-#include "esp_wifi.h"
+#include "driver/uart.h"
+#include "driver/gpio.h"
 
 #include "config.h"
 #include "system_state.h"
@@ -41,6 +41,18 @@
 #include "safety_system.h"
 #include "webserver.h"
 #include "mqtt_client_app.h"
+#include "ctrl_profiler.h"
+#include "blog.h"
+#include "state_transition.h"
+#include "flight_recorder.h"
+#include "task_monitor.h"
+#include "heap_monitor.h"
+#include "startup.h"
+#include "wifi_manager.h"
+#include "power_manager.h"
+#include "deadline_monitor.h"
+#include "estop.h"
+#include "batch.h"
 
 static const char *TAG = "MAIN";
 
@@ -58,14 +70,42 @@ system_state_t g_system_state = {
 
 /* Event group for system coordination */
 EventGroupHandle_t g_system_events;
+static StaticEventGroup_t s_system_events_buf;
 
 /* Task handles */
 static TaskHandle_t task_scale = NULL;
 static TaskHandle_t task_control = NULL;
 static TaskHandle_t task_display = NULL;
-static TaskHandle_t task_webserver = NULL;
 static TaskHandle_t task_mqtt = NULL;
 
+/* Static task stacks and TCBs: no task memory comes from the heap */
+static StaticTask_t s_scale_tcb;
+static StaticTask_t s_control_tcb;
+static StaticTask_t s_display_tcb;
+static StaticTask_t s_mqtt_tcb;
+static StackType_t s_scale_stack[SCALE_TASK_STACK_SIZE];
+static StackType_t s_control_stack[CONTROL_TASK_STACK_SIZE];
+static StackType_t s_display_stack[DISPLAY_TASK_STACK_SIZE];
+static StackType_t s_mqtt_stack[MQTT_TASK_STACK_SIZE];
+
+static void control_task_fill_logic(void);
+static void control_task_settle(int64_t now_us);
+static void control_task_precharge(int64_t now_us);
+static void control_task_wait(TickType_t *last_wake_time, uint32_t period_ms);
+
+/* Pre-charge of the current safety sequence (control task only) */
+static struct {
+    int64_t since_us;           // Ramp start, 0 if not pre-charging
+    float pct;                  // Level reached (read at fill start)
+} s_precharge;
+
+/* Settle phase state (control task only) */
+static struct {
+    int64_t cutoff_us;          // Pump stopped
+    int64_t stable_since_us;    // Reading has stayed within SETTLE_BAND_LBS of ref since
+    float ref_weight;
+} s_settle;
+
 /**
  * @brief Scale reading task
  *
@@ -76,20 +116,40 @@ static void scale_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Scale task started");
 
-    scale_init();
+    startup_stage_done(EVENT_SCALE_READY, scale_init());
+
+    // Check in every read; the watchdog subscription allocates, so before the guard
+    deadline_register(DEADLINE_TASK_SCALE, SCALE_READ_INTERVAL_MS);
+
+    // UART driver is installed; reading the scale must not touch the heap
+    heap_monitor_forbid_alloc();
 
     while (1) {
         float weight = 0.0f;
+        bool idle = power_manager_is_idle();
+
+        if (idle) {
+            // UART2 cannot wake the chip and loses bytes in light sleep:
+            // stay awake for this read and drop any partial frame
+            power_manager_stay_awake_begin();
+            uart_flush_input(SCALE_UART_NUM);
+        }
 
         if (scale_read_weight(&weight) == ESP_OK) {
             g_system_state.current_weight_lbs = weight;
             g_system_state.scale_online = true;
         } else {
             g_system_state.scale_online = false;
-            ESP_LOGW(TAG, "Scale read error");
+            BLOG0(BLOG_SCALE_READ_ERROR);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(SCALE_READ_INTERVAL_MS));
+        if (idle) {
+            power_manager_stay_awake_end();
+        }
+
+        uint32_t period_ms = idle ? POWER_IDLE_SCALE_INTERVAL_MS : SCALE_READ_INTERVAL_MS;
+        deadline_checkin(DEADLINE_TASK_SCALE, period_ms);
+        vTaskDelay(pdMS_TO_TICKS(period_ms));
     }
 }
 
@@ -102,23 +162,57 @@ static void control_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Control task started");
 
-    pressure_controller_init();
+    startup_stage_done(EVENT_CONTROL_READY, pressure_controller_init());
+
+    // The fill logic needs weight readings
+    if (!startup_wait(EVENT_SCALE_READY, STARTUP_READY_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "Scale not ready, control loop starting without it");
+    }
+    deadline_register(DEADLINE_TASK_CONTROL, CONTROL_LOOP_INTERVAL_MS);
+    heap_monitor_forbid_alloc();
 
     TickType_t last_wake_time = xTaskGetTickCount();
 
     while (1) {
+        PROF_TICK_BEGIN();
+
         // Update uptime
-        g_system_state.uptime_seconds = esp_timer_get_time() / 1000000;
+        int64_t now_us = esp_timer_get_time();
+        g_system_state.uptime_seconds = now_us / 1000000;
+
+        // The e-stop ISR has already zeroed the DAC: hold the fault until reset
+        estop_poll();
+        if (estop_active() && g_system_state.state != STATE_ERROR) {
+            state_set_error(ERROR_ESTOP);
+            state_set_system(STATE_ERROR);
+        }
+
+        // Pre-charge and fill steps must reach pressure: no air or a
+        // degraded supply stops the sequence (ITV feedback timing)
+        if ((g_system_state.state == STATE_SAFETY_CHECK || g_system_state.state == STATE_FILLING) &&
+            pressure_controller_check_air() != ESP_OK) {
+            pressure_controller_set_percent(0.0f);
+            state_set_error(ERROR_PRESSURE_FAULT);
+            state_set_system(STATE_ERROR);
+        }
+
+        // A new safety sequence ramps the pre-charge from 0 again
+        if (g_system_state.state != STATE_SAFETY_CHECK) {
+            s_precharge.since_us = 0;
+        }
 
         // State machine
         switch (g_system_state.state) {
             case STATE_IDLE:
                 // Wait for start command
                 pressure_controller_set_percent(0.0f);
+                PROF_MARK(PROF_STAGE_DAC);
                 break;
 
             case STATE_SAFETY_CHECK:
-                // Safety system handles this
+                // Display task runs the checks; pre-charge during the last one
+                control_task_precharge(now_us);
+                PROF_MARK(PROF_STAGE_DAC);
                 break;
 
             case STATE_FILLING:
@@ -126,12 +220,13 @@ static void control_task(void *pvParameters)
                 if (pressure_controller_is_autotuning()) {
                     // Run auto-tune state machine
                     esp_err_t result = pressure_controller_run_autotune(g_system_state.current_weight_lbs);
+                    PROF_MARK(PROF_STAGE_PID);
 
                     if (result == ESP_OK) {
                         // Auto-tune complete
                         ESP_LOGI(TAG, "Auto-tune completed successfully");
                         pressure_controller_set_percent(0.0f);
-                        g_system_state.state = STATE_IDLE;
+                        state_set_system(STATE_IDLE);
 
                         // Results are stored in g_system_state.autotune_kp/ki/kd
                         // User can save via menu
@@ -139,7 +234,7 @@ static void control_task(void *pvParameters)
                         // Auto-tune failed
                         ESP_LOGE(TAG, "Auto-tune failed");
                         pressure_controller_set_percent(0.0f);
-                        g_system_state.state = STATE_ERROR;
+                        state_set_system(STATE_ERROR);
                     }
                     // ESP_ERR_INVALID_STATE means still in progress
                 } else {
@@ -149,9 +244,8 @@ static void control_task(void *pvParameters)
                 break;
 
             case STATE_COMPLETED:
-                // Hold briefly, then return to idle
-                vTaskDelay(pdMS_TO_TICKS(2000));
-                g_system_state.state = STATE_IDLE;
+                // Pump is off: capture the final weight once it settles
+                control_task_settle(now_us);
                 break;
 
             case STATE_ERROR:
@@ -159,12 +253,88 @@ static void control_task(void *pvParameters)
                 pressure_controller_set_percent(0.0f);
                 break;
 
+            case STATE_CANCELLED:
+                // Drop any fill or pre-charge pressure, then accept new fills
+                pressure_controller_set_percent(0.0f);
+                if (now_us - state_changed_us() >= (int64_t)CANCEL_HOLD_MS * 1000) {
+                    state_set_system(STATE_IDLE);
+                }
+                break;
+
             default:
                 break;
         }
 
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONTROL_LOOP_INTERVAL_MS));
+        PROF_TICK_END();
+
+        // Batch job: drum placement/removal, auto-tare and next-drum start
+        batch_update(now_us);
+        if (batch_active()) {
+            power_manager_activity(POWER_WAKE_STATE);   // Detect the next drum at full rate
+        }
+
+        // Enter idle mode after a quiet spell in STATE_IDLE, leave it otherwise
+        power_manager_update();
+        bool idle = power_manager_is_idle();
+        uint32_t period_ms = idle ? POWER_IDLE_CONTROL_INTERVAL_MS : CONTROL_LOOP_INTERVAL_MS;
+
+        // The DAC guard ISR zeroes the output if the next check-in is late
+        deadline_guard_arm(!idle);
+        if (deadline_checkin(DEADLINE_TASK_CONTROL, period_ms)) {
+            ESP_LOGE(TAG, "Control task stalled, DAC guard cut the pressure");
+            pressure_controller_set_percent(0.0f);
+            state_set_error(ERROR_CONTROL_STALL);
+            state_set_system(STATE_ERROR);
+        }
+
+        control_task_wait(&last_wake_time, period_ms);
+    }
+}
+
+/**
+ * @brief Act on a posted state change between control ticks
+ *
+ * A stop or error from another task (web handler, display task) reaches
+ * the DAC here, one context switch after state_set_system(), instead of
+ * at the next tick. The latency is recorded in the transition statistics;
+ * stops this task made itself (e-stop, air fault, stall) are not, as they
+ * zeroed the DAC in the same tick.
+ */
+static void control_task_on_transition(void)
+{
+    system_state_enum_t state = g_system_state.state;
+    if (state == STATE_FILLING || state == STATE_SAFETY_CHECK) {
+        return;  // Pressure is set by the next tick
+    }
+
+    pressure_controller_set_percent(0.0f);
+    if ((state == STATE_CANCELLED || state == STATE_ERROR) && !state_changed_by_caller()) {
+        state_record_stop_latency((uint32_t)(esp_timer_get_time() - state_changed_us()));
+    }
+}
+
+/**
+ * @brief Wait for the next control tick (vTaskDelayUntil semantics)
+ *
+ * Blocks on EVENT_STATE_CHANGED_CONTROL rather than a plain delay, so
+ * state changes are handled as soon as they are posted.
+ */
+static void control_task_wait(TickType_t *last_wake_time, uint32_t period_ms)
+{
+    TickType_t next_wake = *last_wake_time + pdMS_TO_TICKS(period_ms);
+
+    while (1) {
+        TickType_t remaining = next_wake - xTaskGetTickCount();
+        if ((int32_t)remaining <= 0) {
+            break;  // Tick due (or overrun)
+        }
+        EventBits_t bits = xEventGroupWaitBits(g_system_events, EVENT_STATE_CHANGED_CONTROL,
+                                               pdTRUE, pdFALSE, remaining);
+        if (bits & EVENT_STATE_CHANGED_CONTROL) {
+            control_task_on_transition();
+        }
     }
+    *last_wake_time = next_wake;
 }
 
 /**
@@ -174,9 +344,34 @@ static void control_task_fill_logic(void)
 {
     static float prev_weight = 0.0f;
     static uint64_t prev_time_us = 0;
+    static uint32_t fill_start_ms = 0;     // Fill this tick belongs to
+    static float start_net = 0.0f;         // Net weight at the start confirmation
+
+    // Snapshot the scale reading once so every stage of this tick agrees
+    // (net of the drum tare in batch mode, start_weight_lbs = 0 otherwise)
+    float gross = g_system_state.current_weight_lbs;
+    float weight = gross - g_system_state.start_weight_lbs;
+    PROF_MARK(PROF_STAGE_SAMPLE);
+
+    // Start-of-fill lag: confirmation (fill_start_time_ms) to first stroke
+    if (g_system_state.fill_start_time_ms != fill_start_ms) {
+        fill_start_ms = g_system_state.fill_start_time_ms;
+        start_net = weight;
+        g_system_state.first_stroke_ms = 0;
+        g_system_state.precharged = (s_precharge.pct >= PRECHARGE_PCT);
+        s_precharge.pct = 0.0f;
+    }
+    if (g_system_state.first_stroke_ms == 0 && weight - start_net >= FIRST_STROKE_LBS) {
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        g_system_state.first_stroke_ms = now_ms - fill_start_ms;
+        if (g_system_state.first_stroke_ms == 0) {
+            g_system_state.first_stroke_ms = 1;
+        }
+    }
 
-    float remaining = g_system_state.target_weight_lbs - g_system_state.current_weight_lbs;
-    float percent_complete = (g_system_state.current_weight_lbs / g_system_state.target_weight_lbs) * 100.0f;
+    float remaining = g_system_state.target_weight_lbs - weight;
+    float percent_complete = (weight / g_system_state.target_weight_lbs) * 100.0f;
+    PROF_MARK(PROF_STAGE_ESTIMATE);
 
     // Determine zone based on updated thresholds
     fill_zone_t new_zone;
@@ -199,24 +394,26 @@ static void control_task_fill_logic(void)
         new_zone = ZONE_FINE;
         zone_setpoint = PRESSURE_FINE;
     } else {
-        // COMPLETE
+        // COMPLETE: stop the pump, statistics follow once the weight settles
+        PROF_MARK(PROF_STAGE_ZONE);
         pressure_controller_set_percent(0.0f);
-        g_system_state.state = STATE_COMPLETED;
-        g_system_state.fill_number++;
-        g_system_state.fills_today++;
-        g_system_state.total_lbs_today += g_system_state.current_weight_lbs;
-
-        // Publish fill complete event to MQTT
-        mqtt_publish_fill_complete();
+        PROF_MARK(PROF_STAGE_DAC);
+
+        int64_t now_us = esp_timer_get_time();
+        g_system_state.cutoff_weight_lbs = gross;
+        s_settle.cutoff_us = now_us;
+        s_settle.stable_since_us = now_us;
+        s_settle.ref_weight = gross;
+        state_set_system(STATE_COMPLETED);
         return;
     }
 
     // Track zone transitions
     if (new_zone != g_system_state.active_zone) {
         g_system_state.zone_transitions++;
-        ESP_LOGI(TAG, "Zone transition: %s -> %s",
-                 zone_to_string(g_system_state.active_zone),
-                 zone_to_string(new_zone));
+        BLOG2(BLOG_ZONE_TRANSITION,
+              zone_to_string(g_system_state.active_zone),
+              zone_to_string(new_zone));
 
         // Reset PID on zone change for hybrid mode
         if (g_system_state.pid_enabled) {
@@ -224,8 +421,9 @@ static void control_task_fill_logic(void)
         }
     }
 
-    g_system_state.active_zone = new_zone;
+    state_set_zone(new_zone);
     g_system_state.pressure_setpoint_pct = zone_setpoint;
+    PROF_MARK(PROF_STAGE_ZONE);
 
     // Choose control mode
     if (g_system_state.pid_enabled) {
@@ -239,8 +437,9 @@ static void control_task_fill_logic(void)
 
         if (dt > 0.001f && dt < 1.0f) {
             // Calculate current flow rate
-            float weight_delta = g_system_state.current_weight_lbs - prev_weight;
+            float weight_delta = weight - prev_weight;
             float flow_rate = weight_delta / dt;  // lbs/sec
+            PROF_MARK(PROF_STAGE_ESTIMATE);
 
             // Target flow rates based on real testing data
             // 30 PSI = 2 pumps/sec = 1.0 lb/sec
@@ -266,19 +465,120 @@ static void control_task_fill_logic(void)
             // Clamp to reasonable bounds
             if (output < 0.0f) output = 0.0f;
             if (output > 100.0f) output = 100.0f;
+            PROF_MARK(PROF_STAGE_PID);
 
             pressure_controller_set_percent(output);
+            PROF_MARK(PROF_STAGE_DAC);
         } else {
             // First iteration or timeout - use zone setpoint
             pressure_controller_set_percent(zone_setpoint);
+            PROF_MARK(PROF_STAGE_DAC);
         }
 
-        prev_weight = g_system_state.current_weight_lbs;
+        prev_weight = weight;
         prev_time_us = now_us;
 
     } else {
         // SIMPLE ZONE CONTROL (original behavior)
         pressure_controller_set_percent(zone_setpoint);
+        PROF_MARK(PROF_STAGE_DAC);
+    }
+}
+
+/**
+ * @brief Pre-charge during STATE_SAFETY_CHECK
+ *
+ * While the last selected step awaits confirmation, or an ITV feedback
+ * step awaits the pressure, ramp the ITV to PRECHARGE_PCT over
+ * PRECHARGE_RAMP_MS. The hold is below the pump's break-away pressure, so
+ * the air line fills but the pump stays still. Other steps (and
+ * PRECHARGE_ENABLE 0) keep the DAC at 0.
+ */
+static void control_task_precharge(int64_t now_us)
+{
+    if (!PRECHARGE_ENABLE || !safety_precharge_pending()) {
+        s_precharge.since_us = 0;
+        s_precharge.pct = 0.0f;
+        pressure_controller_set_percent(0.0f);
+        return;
+    }
+
+    if (s_precharge.since_us == 0) {
+        s_precharge.since_us = now_us;
+    }
+    float pct = PRECHARGE_PCT * (float)(now_us - s_precharge.since_us) / (PRECHARGE_RAMP_MS * 1000.0f);
+    if (pct > PRECHARGE_PCT) {
+        pct = PRECHARGE_PCT;
+    }
+    s_precharge.pct = pct;
+    g_system_state.pressure_setpoint_pct = pct;
+    pressure_controller_set_percent(pct);
+}
+
+/**
+ * @brief Settle phase after cutoff (STATE_COMPLETED)
+ *
+ * Material still in the hose lands after the pump stops. The settled weight
+ * is taken once readings stay within SETTLE_BAND_LBS for SETTLE_STABLE_MS,
+ * or at SETTLE_TIMEOUT_MS. Then the fill statistics are updated, mqtt_task
+ * publishes the fill, and the state returns to idle.
+ */
+static void control_task_settle(int64_t now_us)
+{
+    float weight = g_system_state.current_weight_lbs;
+    bool stable = false;
+
+    if (!g_system_state.scale_online || fabsf(weight - s_settle.ref_weight) > SETTLE_BAND_LBS) {
+        s_settle.ref_weight = weight;
+        s_settle.stable_since_us = now_us;
+    } else {
+        stable = (now_us - s_settle.stable_since_us >= (int64_t)SETTLE_STABLE_MS * 1000);
+    }
+
+    bool timed_out = (now_us - s_settle.cutoff_us >= (int64_t)SETTLE_TIMEOUT_MS * 1000);
+    if (!stable && !timed_out) {
+        return;
+    }
+
+    g_system_state.actual_dispensed_lbs = weight - g_system_state.start_weight_lbs;
+    g_system_state.spill_lbs = weight - g_system_state.cutoff_weight_lbs;
+    g_system_state.settle_time_ms = (uint32_t)((now_us - s_settle.cutoff_us) / 1000);
+    g_system_state.settle_stable = stable;
+    g_system_state.fill_number++;
+    g_system_state.fills_today++;
+    g_system_state.total_lbs_today += g_system_state.actual_dispensed_lbs;
+
+    // MQTT publish allocates: hand it to mqtt_task instead of doing it here
+    xEventGroupSetBits(g_system_events, EVENT_FILL_COMPLETE);
+    PROF_MARK(PROF_STAGE_TELEMETRY);
+
+    state_set_system(STATE_IDLE);
+}
+
+/**
+ * @brief Wait for the next display tick during the safety checks
+ *
+ * A button press wakes the task at once. The press queue and the event
+ * group cannot be waited on together, so a posted state change (e.g. a
+ * web stop) is picked up between slices of SAFETY_STATE_POLL_MS.
+ */
+static void display_wait_safety(uint32_t timeout_ms)
+{
+    int64_t end_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+
+    while (1) {
+        EventBits_t bits = xEventGroupClearBits(g_system_events, EVENT_STATE_CHANGED_DISPLAY);
+        if (bits & EVENT_STATE_CHANGED_DISPLAY) {
+            return;
+        }
+        int64_t left_ms = (end_us - esp_timer_get_time()) / 1000;
+        if (left_ms <= 0) {
+            return;
+        }
+        uint32_t slice_ms = left_ms < SAFETY_STATE_POLL_MS ? (uint32_t)left_ms : SAFETY_STATE_POLL_MS;
+        if (safety_wait_press(slice_ms)) {
+            return;
+        }
     }
 }
 
@@ -292,50 +592,82 @@ static void display_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Display task started");
 
-    display_init();
-    safety_init();
+    esp_err_t ret = display_init();
+    if (ret == ESP_OK) {
+        ret = display_encoder_init();
+    }
+    // The checklist gates every fill: load it even without an LCD or encoder
+    esp_err_t safety_ret = safety_init();
+    if (ret == ESP_OK) {
+        ret = safety_ret;
+    }
+    startup_stage_done(EVENT_DISPLAY_READY, ret);
+
+    // No fill can be started from the encoder before the control path is up
+    startup_wait(EVENT_SYSTEM_READY, STARTUP_READY_TIMEOUT_MS);
+
+    uint32_t last_interaction_ms = g_system_state.last_interaction_ms;
+    system_state_enum_t prev_state = g_system_state.state;
+    int64_t next_tick_us = esp_timer_get_time();
+    int64_t last_redraw_us = 0;
 
     while (1) {
+        int64_t now_us = esp_timer_get_time();
+        uint32_t lateness_us = now_us > next_tick_us ? (uint32_t)(now_us - next_tick_us) : 0;
+
+        // New check sequence on every entry (batch drums after the first
+        // run only the per-drum checks)
+        system_state_enum_t state = g_system_state.state;
+        if (state == STATE_SAFETY_CHECK && prev_state != STATE_SAFETY_CHECK) {
+            safety_begin(batch_repeat_drum());
+        } else if (state != STATE_SAFETY_CHECK && prev_state == STATE_SAFETY_CHECK) {
+            safety_end();
+        }
+        prev_state = state;
+
         // If in safety check mode, run safety sequence
-        if (g_system_state.state == STATE_SAFETY_CHECK) {
+        if (state == STATE_SAFETY_CHECK) {
             esp_err_t result = safety_run_checks();
 
             if (result == ESP_OK) {
                 // All safety checks passed, proceed to filling
-                g_system_state.state = STATE_FILLING;
+                // Start time first: control_task wakes on the transition
                 g_system_state.fill_start_time_ms = esp_timer_get_time() / 1000;
-                mqtt_publish_event("fill_start", "Safety checks passed, fill starting");
+                state_set_system(STATE_FILLING);   // mqtt_task publishes fill_start
             } else if (result == ESP_FAIL) {
                 // Safety checks failed or cancelled
-                g_system_state.state = STATE_CANCELLED;
+                state_set_system(STATE_CANCELLED);
                 mqtt_publish_event("safety_check_failed", "Safety checks cancelled or timeout");
             }
             // ESP_ERR_INVALID_STATE means checks still in progress
         }
 
-        // Update LCD display based on current state
-        display_update(&g_system_state);
-
-        // Handle rotary encoder input
+        // Take the detents counted by the PCNT since the last tick (the
+        // encoder GPIOs also wake the chip from light sleep)
         display_handle_encoder();
+        if (g_system_state.last_interaction_ms != last_interaction_ms) {
+            last_interaction_ms = g_system_state.last_interaction_ms;
+            power_manager_activity(POWER_WAKE_ENCODER);
+        }
 
-        vTaskDelay(pdMS_TO_TICKS(DISPLAY_UPDATE_INTERVAL_MS));
-    }
-}
-
-/**
- * @brief Web server task
- *
- * Serves WebUI and handles HTTP API requests
- */
-static void webserver_task(void *pvParameters)
-{
-    ESP_LOGI(TAG, "Web server task started");
-
-    webserver_init();
+        // Update LCD display based on current state (slower in idle mode)
+        if (!power_manager_is_idle() ||
+            now_us - last_redraw_us >= (int64_t)POWER_IDLE_DISPLAY_INTERVAL_MS * 1000) {
+            display_update(&g_system_state);
+            last_redraw_us = now_us;
+        }
+        power_manager_display_tick(lateness_us);
 
-    // Web server runs its own event loop
-    vTaskDelete(NULL);
+        next_tick_us = esp_timer_get_time() + (int64_t)DISPLAY_UPDATE_INTERVAL_MS * 1000;
+        if (g_system_state.state == STATE_SAFETY_CHECK) {
+            // Woken early by a button press or a state change
+            display_wait_safety(DISPLAY_UPDATE_INTERVAL_MS);
+        } else {
+            // Woken early by a state change so the LCD follows it at once
+            xEventGroupWaitBits(g_system_events, EVENT_STATE_CHANGED_DISPLAY, pdTRUE, pdFALSE,
+                                pdMS_TO_TICKS(DISPLAY_UPDATE_INTERVAL_MS));
+        }
+    }
 }
 
 /**
@@ -350,6 +682,15 @@ static void mqtt_task(void *pvParameters)
     mqtt_app_start();
 
     uint32_t last_status_publish = 0;
+    uint32_t last_metrics_publish = 0;
+    uint32_t last_link_publish = 0;
+    uint32_t last_reconnects = 0;
+    static task_monitor_snapshot_t metrics_snap;
+    static char metrics_json[4096];
+    wifi_manager_stats_t link;
+    char link_json[256];
+    deadline_stats_t deadlines;
+    uint32_t last_guard_trips = 0;
 
     while (1) {
         uint32_t now = esp_timer_get_time() / 1000; // milliseconds
@@ -359,40 +700,55 @@ static void mqtt_task(void *pvParameters)
                            MQTT_STATUS_INTERVAL_FILLING :
                            MQTT_STATUS_INTERVAL_IDLE;
 
+        // Fill and error events latched by the control path (which must not allocate)
+        EventBits_t posted = xEventGroupClearBits(g_system_events,
+                                                  EVENT_FILL_START | EVENT_FILL_COMPLETE | EVENT_ERROR);
+        if (posted & EVENT_FILL_START) {
+            mqtt_publish_event("fill_start", "Safety checks passed, fill starting");
+        }
+        if (posted & EVENT_FILL_COMPLETE) {
+            mqtt_publish_fill_complete();
+        }
+        if (posted & EVENT_ERROR) {
+            mqtt_publish_event("error", error_to_string(g_system_state.error));
+        }
+
+        // Report a control stall as soon as the guard has cut the pressure
+        deadline_get_stats(&deadlines);
+        if (deadlines.guard_trips != last_guard_trips) {
+            mqtt_publish_event("control_stall", "Control task missed its deadline, DAC guard zeroed pressure");
+            last_guard_trips = deadlines.guard_trips;
+        }
+
         if (now - last_status_publish >= interval) {
             mqtt_publish_status(&g_system_state);
             last_status_publish = now;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
-}
+        if (now - last_metrics_publish >= MQTT_METRICS_INTERVAL) {
+            task_monitor_snapshot(&metrics_snap);
+            if (metrics_snap.task_count > 0 &&
+                task_monitor_to_json(&metrics_snap, metrics_json, sizeof(metrics_json)) == ESP_OK) {
+                mqtt_publish_metrics(metrics_json);
+            }
+            last_metrics_publish = now;
+        }
 
-/**
- * @brief WiFi initialization
- */
-static void wifi_init(void)
-{
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
-
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-    wifi_config_t wifi_config = {
-        .sta = {
-            .ssid = WIFI_SSID,
-            .password = WIFI_PASSWORD,
-            .threshold.authmode = WIFI_AUTH_WPA2_PSK,
-        },
-    };
-
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
-
-    ESP_LOGI(TAG, "WiFi connecting to %s...", WIFI_SSID);
+        // Link quality, and the outage as soon as MQTT is back after a reconnect
+        wifi_manager_get_stats(&link);
+        bool reconnected = (link.reconnect_count != last_reconnects && g_system_state.mqtt_connected);
+        if (reconnected || now - last_link_publish >= MQTT_LINK_INTERVAL) {
+            if (wifi_manager_to_json(&link, link_json, sizeof(link_json)) == ESP_OK) {
+                mqtt_publish_link(link_json);
+            }
+            last_reconnects = link.reconnect_count;
+            last_link_publish = now;
+        }
+
+        // Next round after 1 s, or as soon as an event is posted
+        xEventGroupWaitBits(g_system_events, EVENT_FILL_START | EVENT_FILL_COMPLETE | EVENT_ERROR,
+                            pdFALSE, pdFALSE, pdMS_TO_TICKS(1000));
+    }
 }
 
 /**
@@ -414,18 +770,68 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    // Start deferred log drain before any hot-path task runs
+    ESP_ERROR_CHECK(blog_init());
+
+    // Restore the transition ring and save it if the last reset was a crash
+    ESP_ERROR_CHECK(flightrec_init());
+
     // Create event group
-    g_system_events = xEventGroupCreate();
+    g_system_events = xEventGroupCreateStatic(&s_system_events_buf);
+
+    // Count heap allocations per task; sampled with the task monitor
+    heap_monitor_init();
+
+    // DFS/light sleep for idle mode; tasks start in active mode
+    power_manager_init();
+
+    // Deadline supervision and the DAC guard timer (armed by control_task)
+    ESP_ERROR_CHECK(deadline_monitor_init());
+
+    // Shared GPIO ISR service (IRAM) for the e-stop, ITV feedback and button ISRs
+    ESP_ERROR_CHECK(gpio_install_isr_service(ESP_INTR_FLAG_IRAM));
+
+    // E-stop input ISR; measure trigger-to-zero while the pump is still off
+    ESP_ERROR_CHECK(estop_init());
+    estop_self_test();
+
+    // Control-critical path first: peripherals come up in parallel in their tasks
+    task_scale = xTaskCreateStaticPinnedToCore(scale_task, "scale_task", SCALE_TASK_STACK_SIZE,
+                                               NULL, 5, s_scale_stack, &s_scale_tcb, 0);
+    task_control = xTaskCreateStaticPinnedToCore(control_task, "control_task", CONTROL_TASK_STACK_SIZE,
+                                                 NULL, 5, s_control_stack, &s_control_tcb, 0);
+    task_display = xTaskCreateStaticPinnedToCore(display_task, "display_task", DISPLAY_TASK_STACK_SIZE,
+                                                 NULL, 4, s_display_stack, &s_display_tcb, 1);
 
-    // Initialize WiFi
-    wifi_init();
+    if (startup_wait(EVENT_SYSTEM_READY, STARTUP_READY_TIMEOUT_MS)) {
+        EventBits_t faults = startup_faults();
+        if (faults == 0) {
+            ESP_LOGI(TAG, "Ready to fill %lu ms after boot",
+                     (unsigned long)startup_boot_to_ready_ms());
+        } else {
+            ESP_LOGE(TAG, "Startup finished with faults, fills disabled (scale:%d control:%d display:%d)",
+                     !!(faults & EVENT_SCALE_READY), !!(faults & EVENT_CONTROL_READY),
+                     !!(faults & EVENT_DISPLAY_READY));
+        }
+    } else {
+        EventBits_t bits = xEventGroupGetBits(g_system_events);
+        ESP_LOGE(TAG, "Startup incomplete after %d ms (scale:%d control:%d display:%d)",
+                 STARTUP_READY_TIMEOUT_MS, !!(bits & EVENT_SCALE_READY),
+                 !!(bits & EVENT_CONTROL_READY), !!(bits & EVENT_DISPLAY_READY));
+    }
+
+    // Network and telemetry after the pump is usable
+    wifi_manager_init();
+
+    task_mqtt = xTaskCreateStaticPinnedToCore(mqtt_task, "mqtt_task", MQTT_TASK_STACK_SIZE,
+                                              NULL, 3, s_mqtt_stack, &s_mqtt_tcb, 1);
+
+    // Web server: httpd plus its static worker pool (no setup task needed)
+    ESP_LOGI(TAG, "Starting web server");
+    webserver_init();
 
-    // Create FreeRTOS tasks
-    xTaskCreatePinnedToCore(scale_task, "scale_task", 4096, NULL, 5, &task_scale, 0);
-    xTaskCreatePinnedToCore(control_task, "control_task", 4096, NULL, 5, &task_control, 0);
-    xTaskCreatePinnedToCore(display_task, "display_task", 4096, NULL, 4, &task_display, 1);
-    xTaskCreatePinnedToCore(webserver_task, "webserver_task", 8192, NULL, 3, &task_webserver, 1);
-    xTaskCreatePinnedToCore(mqtt_task, "mqtt_task", 6144, NULL, 3, &task_mqtt, 1);
+    // Sample task CPU/stack/heap usage for MQTT and /metrics
+    task_monitor_init();
 
     ESP_LOGI(TAG, "All tasks created successfully");
     ESP_LOGI(TAG, "System initialized and running");
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Fetch the control-loop profile from the pump controller and print it.
+
+Reads GET /api/profile (per-stage CPU cycle histograms, see ctrl_profiler.h)
+and prints min/avg/max and histogram-estimated p50/p99 per stage, in
+microseconds. Optionally saves the raw JSON or a CSV of the histograms.
+
+Usage:
+    ctrl_profile.py <host[:port]> [--json out.json] [--csv out.csv] [--reset]
+"""
+
+import argparse
+import csv
+import json
+import sys
+import urllib.request
+
+
+def bucket_upper_us(bucket, cpu_mhz):
+    """Upper bound of log2 bucket `bucket` (cycles in [2^b, 2^(b+1))) in us."""
+    return (2 ** (bucket + 1)) / cpu_mhz
+
+
+def hist_percentile_us(hist, pct, cpu_mhz):
+    total = sum(hist)
+    if total == 0:
+        return 0.0
+    threshold = total * pct / 100.0
+    running = 0
+    for bucket, count in enumerate(hist):
+        running += count
+        if running >= threshold:
+            return bucket_upper_us(bucket, cpu_mhz)
+    return bucket_upper_us(len(hist) - 1, cpu_mhz)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("host", help="controller address, e.g. 192.168.1.50 or localhost:8080")
+    parser.add_argument("--json", help="write raw profile JSON to this file")
+    parser.add_argument("--csv", help="write per-stage histograms to this CSV file")
+    parser.add_argument("--reset", action="store_true", help="clear the profile after reading")
+    args = parser.parse_args()
+
+    base = "http://" + args.host
+    with urllib.request.urlopen(base + "/api/profile", timeout=5) as resp:
+        profile = json.load(resp)
+
+    mhz = profile["cpu_mhz"] or 1
+    print(f"ticks={profile['ticks']} skipped={profile.get('skipped', 0)} overruns={profile['overruns']} "
+          f"budget={profile['budget_us'] / 1000:.0f} ms cpu={mhz} MHz")
+    print(f"{'stage':<10} {'count':>8} {'min_us':>10} {'avg_us':>10} "
+          f"{'p50_us':>10} {'p99_us':>10} {'max_us':>10}")
+    for st in profile["stages"]:
+        print(f"{st['name']:<10} {st['count']:>8} {st['min_us']:>10.2f} {st['avg_us']:>10.2f} "
+              f"{min(hist_percentile_us(st['hist'], 50, mhz), st['max_us']):>10.2f} "
+              f"{min(hist_percentile_us(st['hist'], 99, mhz), st['max_us']):>10.2f} "
+              f"{st['max_us']:>10.2f}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(profile, f, indent=2)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["stage", "bucket", "upper_us", "count"])
+            for st in profile["stages"]:
+                for bucket, count in enumerate(st["hist"]):
+                    writer.writerow([st["name"], bucket,
+                                     f"{bucket_upper_us(bucket, mhz):.3f}", count])
+
+    if args.reset:
+        req = urllib.request.Request(base + "/api/profile/reset", method="POST")
+        urllib.request.urlopen(req, timeout=5).close()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,14 @@
+-- Median wall time of a query over a number of runs (tools/db_bench scripts)
+CREATE OR REPLACE FUNCTION bench_median_ms(query TEXT, runs INT) RETURNS DOUBLE PRECISION AS $$
+DECLARE
+    t0 TIMESTAMPTZ;
+    samples DOUBLE PRECISION[] := '{}';
+BEGIN
+    FOR i IN 1..runs LOOP
+        t0 := clock_timestamp();
+        EXECUTE query;
+        samples := samples || extract(epoch FROM clock_timestamp() - t0) * 1000;
+    END LOOP;
+    RETURN (SELECT percentile_cont(0.5) WITHIN GROUP (ORDER BY x) FROM unnest(samples) x);
+END;
+$$ LANGUAGE plpgsql;
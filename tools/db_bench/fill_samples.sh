@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+#
+# Benchmark fetching one fill's trace from months of pump_fill_samples
+#
+# Creates a scratch database from database/init-bdo-pump.sql and loads
+# synthetic traces: one 180 s fill every 30 minutes per device at RATE Hz,
+# going back DAYS days. Chunks older than a day are compressed as the
+# policy does. For a recent, a mid-range and the oldest fill it reports,
+# from EXPLAIN ANALYZE of the curve query:
+#   rows     - samples returned
+#   ms       - execution time (median of runs for the timing column)
+#   chunks   - compressed chunks decompressed
+#   batches  - compressed batches read
+#   single   - batches equal that fill's own batch count, i.e. only its
+#              segment was decompressed
+# Each fill is fetched with fill_start (from pump_fill_sample_summary, one
+# chunk) and by device and fill number alone (every chunk probed, still one
+# segment decompressed).
+#
+# Requires psql and a TimescaleDB 2.9+ server the user can create databases
+# on (e.g. PSQL="docker exec -i dosing-timescaledb psql -U telegraf").
+#
+# Usage: tools/db_bench/fill_samples.sh [devices] [runs]
+
+set -euo pipefail
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+ROOT="$(cd "$HERE/../.." && pwd)"
+PSQL="${PSQL:-psql}"
+DB="${BENCH_DB:-bdo_bench}"
+DEVICES="${1:-2}"
+RUNS="${2:-20}"
+DAYS="${DAYS:-90}"
+RATE="${RATE:-10}"
+
+q() { $PSQL -X -q -v ON_ERROR_STOP=1 -d "$DB" "$@"; }
+
+echo "Creating scratch database $DB..."
+$PSQL -X -q -v ON_ERROR_STOP=1 -d postgres <<SQL
+DROP DATABASE IF EXISTS $DB;
+CREATE DATABASE $DB;
+DO \$\$ BEGIN
+    IF NOT EXISTS (SELECT FROM pg_roles WHERE rolname = 'telegraf') THEN
+        CREATE ROLE telegraf;
+    END IF;
+END \$\$;
+SQL
+q < "$ROOT/database/init-bdo-pump.sql" > /dev/null
+q < "$HERE/bench_median.sql"
+
+echo "Loading $DAYS days of $RATE Hz fill traces for $DEVICES devices..."
+q -v devices="$DEVICES" -v days="$DAYS" -v rate="$RATE" > /dev/null <<'SQL'
+-- Background jobs would compress, refresh or drop the history mid-run
+SELECT alter_job(job_id, scheduled => false) FROM timescaledb_information.jobs
+WHERE job_id >= 1000;
+
+-- Fill k started k half-hours ago; numbers count up to the newest
+WITH f AS (
+    SELECT k, d, date_trunc('minute', now()) - k * INTERVAL '30 minutes'
+                 - d * INTERVAL '7 seconds' AS fill_start
+    FROM generate_series(1, :days * 48) k, generate_series(1, :'devices'::int) d
+)
+INSERT INTO pump_fill_samples (fill_start, device_id, fill_number, t_offset_ms,
+                               weight_lbs, flow_lbs_s, dac_pct, zone, itv_feedback)
+SELECT f.fill_start, 'bdo_pump_' || f.d, :days * 48 - f.k + 1, i * 1000 / :rate,
+       200.0 * i / (180 * :rate) + random() * 0.05,
+       CASE WHEN i < 150 * :rate THEN 1.2 ELSE 0.4 END + random() * 0.1,
+       CASE WHEN i < 150 * :rate THEN 60 WHEN i < 170 * :rate THEN 35 ELSE 20 END,
+       CASE WHEN i < 150 * :rate THEN 'FAST' WHEN i < 170 * :rate THEN 'MODERATE' ELSE 'FINE' END,
+       i * 1000 / :rate >= 400
+FROM f, generate_series(0, 180 * :rate - 1) i;
+
+SELECT count(compress_chunk(c, if_not_compressed => true))
+FROM show_chunks('pump_fill_samples', older_than => INTERVAL '1 day') c;
+CALL refresh_continuous_aggregate('pump_fill_sample_summary', NULL, now() - INTERVAL '30 minutes');
+ANALYZE;
+
+-- rows, execution time, compressed chunks and batches read by one query
+CREATE FUNCTION bench_plan(query TEXT)
+RETURNS TABLE (rows BIGINT, ms DOUBLE PRECISION, chunks BIGINT, batches BIGINT) AS $$
+DECLARE
+    plan JSONB;
+BEGIN
+    EXECUTE 'EXPLAIN (ANALYZE, FORMAT JSON) ' || query INTO plan;
+    rows := (plan->0->'Plan'->>'Actual Rows')::bigint;
+    ms := (plan->0->>'Execution Time')::double precision;
+    SELECT count(*), COALESCE(sum((n->'Plans'->0->>'Actual Rows')::bigint
+                                  * (n->'Plans'->0->>'Actual Loops')::bigint), 0)
+    INTO chunks, batches
+    FROM jsonb_path_query(plan, 'lax $.**') n
+    WHERE n->>'Custom Plan Provider' = 'DecompressChunk';
+    RETURN NEXT;
+END;
+$$ LANGUAGE plpgsql;
+SQL
+
+# run_case <name> <age of the fill>
+run_case() {
+    q -At -F ' ' -v runs="$RUNS" -v name="$1" -v age="$2" <<'SQL' |
+SELECT fill_start, fill_number FROM pump_fill_sample_summary
+WHERE device_id = 'bdo_pump_1' AND fill_start <= now() - :'age'::interval
+ORDER BY fill_start DESC LIMIT 1 \gset
+\set by_start 'SELECT fill_start + t_offset_ms * INTERVAL ''1 millisecond'' AS time, weight_lbs, flow_lbs_s, dac_pct, itv_feedback FROM pump_fill_samples WHERE device_id = ''bdo_pump_1'' AND fill_number = ' :fill_number ' AND fill_start = ''' :fill_start ''' ORDER BY t_offset_ms'
+\set by_number 'SELECT fill_start + t_offset_ms * INTERVAL ''1 millisecond'' AS time, weight_lbs, flow_lbs_s, dac_pct, itv_feedback FROM pump_fill_samples WHERE device_id = ''bdo_pump_1'' AND fill_number = ' :fill_number ' ORDER BY t_offset_ms'
+SELECT :'name' || '/' || v.how, p.rows, round(bench_median_ms(v.query, :'runs')::numeric, 3),
+       p.chunks, p.batches,
+       CASE WHEN p.chunks = 0 THEN '-'
+            WHEN p.batches = ceil(p.rows / 1000.0) THEN 'yes' ELSE 'NO' END
+FROM (VALUES ('start', :'by_start'), ('number', :'by_number')) v(how, query),
+     LATERAL bench_plan(v.query) p;
+SQL
+    while read -r name rows ms chunks batches single; do
+        printf '%-20s %8s %10s %8s %8s %7s\n' "$name" "$rows" "$ms" "$chunks" "$batches" "$single"
+    done
+}
+
+printf '\n%-20s %8s %10s %8s %8s %7s\n' "fill" "rows" "ms" "chunks" "batches" "single"
+run_case recent "1 hour"
+run_case mid "$(( DAYS / 2 )) days"
+run_case oldest "$(( DAYS - 1 )) days"
+
+echo
+echo "Leaving $DB in place; drop it with: $PSQL -d postgres -c 'DROP DATABASE $DB'"
@@ -0,0 +1,97 @@
+#!/usr/bin/env bash
+#
+# Benchmark the current-status query against growing pump_status history
+#
+# Creates a scratch database from database/init-bdo-pump.sql, then grows
+# pump_status backwards in time (5 s snapshots per device, as the firmware
+# publishes while filling) and compresses chunks older than 3 days like the
+# compression policy does. At each history length it reports the median
+# time of:
+#   distinct_on - the old view, DISTINCT ON (device_id) over the hypertable
+#   latest      - latest_pump_status, read from pump_status_latest
+# and checks that both return the same rows.
+#
+# Requires psql and a TimescaleDB server the user can create databases on
+# (e.g. PSQL="docker exec -i dosing-timescaledb psql -U telegraf").
+#
+# Usage: tools/db_bench/latest_status.sh [devices] [runs] [days...]
+
+set -euo pipefail
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+ROOT="$(cd "$HERE/../.." && pwd)"
+PSQL="${PSQL:-psql}"
+DB="${BENCH_DB:-bdo_bench}"
+DEVICES="${1:-4}"
+RUNS="${2:-20}"
+shift $(( $# > 2 ? 2 : $# ))
+if [ $# -gt 0 ]; then DAYS=("$@"); else DAYS=(1 3 7 14 30); fi
+
+q() { $PSQL -X -q -v ON_ERROR_STOP=1 -d "$DB" "$@"; }
+
+echo "Creating scratch database $DB..."
+$PSQL -X -q -v ON_ERROR_STOP=1 -d postgres <<SQL
+DROP DATABASE IF EXISTS $DB;
+CREATE DATABASE $DB;
+DO \$\$ BEGIN
+    IF NOT EXISTS (SELECT FROM pg_roles WHERE rolname = 'telegraf') THEN
+        CREATE ROLE telegraf;
+    END IF;
+END \$\$;
+SQL
+q < "$ROOT/database/init-bdo-pump.sql" > /dev/null
+q < "$HERE/bench_median.sql"
+ANCHOR="$(q -At -c "SELECT now()")"
+
+q -v devices="$DEVICES" -v anchor="$ANCHOR" > /dev/null <<'SQL'
+-- Background jobs would compress, refresh or drop the history mid-run
+SELECT alter_job(job_id, scheduled => false) FROM timescaledb_information.jobs
+WHERE job_id >= 1000;
+
+-- Newest snapshot per device first; older history is added under it
+INSERT INTO pump_status (time, device_id, state, current_weight_lbs, target_weight_lbs,
+                         progress_pct, current_pressure_pct, active_zone, fill_elapsed_ms,
+                         fills_today, total_lbs_today, uptime_seconds)
+SELECT :'anchor'::timestamptz, 'bdo_pump_' || d, 'IDLE', 0, 200, 0, 0, 'IDLE', 0, 0, 0, 0
+FROM generate_series(1, :'devices'::int) d;
+SQL
+
+# The old view, verbatim
+DISTINCT_ON="SELECT DISTINCT ON (device_id) time, device_id, state, current_weight_lbs,
+    target_weight_lbs, progress_pct, current_pressure_pct, active_zone, fills_today,
+    total_lbs_today, uptime_seconds
+FROM pump_status ORDER BY device_id, time DESC"
+LATEST="SELECT * FROM latest_pump_status"
+
+printf '\n%8s %12s %16s %12s %6s\n' "days" "rows" "distinct_on_ms" "latest_ms" "match"
+have=0
+for days in "${DAYS[@]}"; do
+    q -v devices="$DEVICES" -v anchor="$ANCHOR" -v from="$have" -v to="$days" <<'SQL'
+INSERT INTO pump_status (time, device_id, state, current_weight_lbs, target_weight_lbs,
+                         progress_pct, current_pressure_pct, active_zone, fill_elapsed_ms,
+                         fills_today, total_lbs_today, uptime_seconds)
+SELECT :'anchor'::timestamptz - s * INTERVAL '5 seconds', 'bdo_pump_' || d,
+       CASE WHEN s % 60 < 36 THEN 'FILLING' ELSE 'IDLE' END,
+       random() * 200, 200, random() * 100, random() * 65, 'FAST',
+       (s % 60) * 5000, s / 720, random() * 4000, s * 5
+FROM generate_series(:from * 17280 + 1, :to * 17280) s,
+     generate_series(1, :'devices'::int) d;
+
+SELECT count(compress_chunk(c, if_not_compressed => true))
+FROM show_chunks('pump_status', older_than => INTERVAL '3 days') c \g /dev/null
+ANALYZE pump_status;
+SQL
+    have="$days"
+    q -At -F ' ' -v runs="$RUNS" -v d="$DISTINCT_ON" -v l="$LATEST" -v days="$days" <<'SQL' |
+SELECT :'days', (SELECT count(*) FROM pump_status),
+       round(bench_median_ms(:'d', :'runs')::numeric, 3),
+       round(bench_median_ms(:'l', :'runs')::numeric, 3),
+       CASE WHEN EXISTS ((:d) EXCEPT (:l)) OR EXISTS ((:l) EXCEPT (:d)) THEN 'NO' ELSE 'yes' END;
+SQL
+    while read -r d rows distinct_ms latest_ms match; do
+        printf '%8s %12s %16s %12s %6s\n' "$d" "$rows" "$distinct_ms" "$latest_ms" "$match"
+    done
+done
+
+echo
+echo "Leaving $DB in place; drop it with: $PSQL -d postgres -c 'DROP DATABASE $DB'"
@@ -0,0 +1,159 @@
+#!/usr/bin/env bash
+#
+# Benchmark the Grafana dashboard queries: raw hypertables vs continuous aggregates
+#
+# Creates a scratch database from database/init-bdo-pump.sql and loads a
+# year of synthetic fills (one every 3 minutes per device) plus a month of
+# 5 s status snapshots. Old chunks are compressed as the policies would, and
+# the aggregates are materialized up to the policies' end offsets, so the
+# newest buckets are answered by real-time aggregation. For each dashboard
+# query it reports the median time of the former raw-table form and of the
+# form in the README, and checks that both give the same numbers.
+#
+# Requires psql and a TimescaleDB 2.9+ server the user can create databases
+# on (e.g. PSQL="docker exec -i dosing-timescaledb psql -U telegraf").
+#
+# Usage: tools/db_bench/rollups.sh [devices] [runs]
+
+set -euo pipefail
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+ROOT="$(cd "$HERE/../.." && pwd)"
+PSQL="${PSQL:-psql}"
+DB="${BENCH_DB:-bdo_bench}"
+DEVICES="${1:-4}"
+RUNS="${2:-20}"
+FILL_DAYS="${FILL_DAYS:-365}"
+STATUS_DAYS="${STATUS_DAYS:-30}"
+
+q() { $PSQL -X -q -v ON_ERROR_STOP=1 -d "$DB" "$@"; }
+
+echo "Creating scratch database $DB..."
+$PSQL -X -q -v ON_ERROR_STOP=1 -d postgres <<SQL
+DROP DATABASE IF EXISTS $DB;
+CREATE DATABASE $DB;
+ALTER DATABASE $DB SET timezone = 'UTC';
+DO \$\$ BEGIN
+    IF NOT EXISTS (SELECT FROM pg_roles WHERE rolname = 'telegraf') THEN
+        CREATE ROLE telegraf;
+    END IF;
+END \$\$;
+SQL
+q < "$ROOT/database/init-bdo-pump.sql" > /dev/null
+q < "$HERE/bench_median.sql"
+
+echo "Loading $FILL_DAYS days of fills and $STATUS_DAYS days of status for $DEVICES devices..."
+q -v devices="$DEVICES" -v fill_days="$FILL_DAYS" -v status_days="$STATUS_DAYS" > /dev/null <<'SQL'
+-- Background jobs would compress, refresh or drop the history mid-run
+SELECT alter_job(job_id, scheduled => false) FROM timescaledb_information.jobs
+WHERE job_id >= 1000;
+
+-- 92 % success, 5 % cancelled, 3 % error; error within +/-1 lb
+WITH g AS (
+    SELECT s, d, (random() - 0.5) * 2 AS e, random() AS r
+    FROM generate_series(1, :fill_days * 480) s, generate_series(1, :'devices'::int) d
+)
+INSERT INTO pump_fills (time, device_id, target_lbs, actual_lbs, error_lbs, fill_time_ms,
+                        fill_number, pressure_avg_pct, zone_transitions, completion_status)
+SELECT now() - s * INTERVAL '3 minutes' - d * INTERVAL '7 seconds', 'bdo_pump_' || d,
+       200, 200 + e, e, 175000 + (r * 10000)::bigint, s, 50 + r * 10, 3,
+       CASE WHEN r < 0.92 THEN 'success' WHEN r < 0.97 THEN 'cancelled' ELSE 'error' END
+FROM g;
+
+INSERT INTO pump_status (time, device_id, state, current_weight_lbs, target_weight_lbs,
+                         progress_pct, current_pressure_pct, active_zone, fill_elapsed_ms,
+                         fills_today, total_lbs_today, uptime_seconds)
+SELECT now() - s * INTERVAL '5 seconds', 'bdo_pump_' || d,
+       CASE WHEN s % 60 < 36 THEN 'FILLING' ELSE 'IDLE' END,
+       random() * 200, 200, random() * 100, random() * 65, 'FAST',
+       (s % 60) * 5000, s / 720, random() * 4000, s * 5
+FROM generate_series(1, :status_days * 17280) s, generate_series(1, :'devices'::int) d;
+
+SELECT count(compress_chunk(c, if_not_compressed => true))
+FROM show_chunks('pump_fills', older_than => INTERVAL '7 days') c;
+SELECT count(compress_chunk(c, if_not_compressed => true))
+FROM show_chunks('pump_status', older_than => INTERVAL '3 days') c;
+
+-- Materialized up to the policies' end offsets; the rest is real-time
+CALL refresh_continuous_aggregate('pump_fills_hourly', NULL, now() - INTERVAL '1 hour');
+CALL refresh_continuous_aggregate('pump_fills_daily', NULL, now() - INTERVAL '1 day');
+CALL refresh_continuous_aggregate('pump_status_1m', NULL, now() - INTERVAL '1 minute');
+ANALYZE;
+SQL
+
+# run_case <name> <raw query> <rollup query> <check expression over raw r and rollup h>
+run_case() {
+    q -At -F ' ' -v runs="$RUNS" -v name="$1" -v raw="$2" -v rollup="$3" -v check="$4" <<'SQL' |
+SELECT :'name', t.raw_ms, t.rollup_ms, round(t.raw_ms / NULLIF(t.rollup_ms, 0), 1),
+       CASE WHEN :check THEN 'yes' ELSE 'NO' END
+FROM (SELECT round(bench_median_ms(:'raw', :'runs')::numeric, 3) AS raw_ms,
+             round(bench_median_ms(:'rollup', :'runs')::numeric, 3) AS rollup_ms) t;
+SQL
+    while read -r name raw_ms rollup_ms speedup match; do
+        printf '%-20s %12s %12s %9sx %6s\n' "$name" "$raw_ms" "$rollup_ms" "$speedup" "$match"
+    done
+}
+
+printf '\n%-20s %12s %12s %10s %6s\n' "query" "raw_ms" "rollup_ms" "speedup" "match"
+
+run_case fills_today \
+    "SELECT COUNT(*) AS n FROM pump_fills
+     WHERE time >= CURRENT_DATE AND completion_status = 'success'" \
+    "SELECT COALESCE(SUM(fill_count), 0) AS n FROM pump_fills_hourly
+     WHERE bucket >= CURRENT_DATE AND completion_status = 'success'" \
+    "(SELECT COUNT(*) FROM pump_fills WHERE time >= CURRENT_DATE AND completion_status = 'success')
+     = (SELECT COALESCE(SUM(fill_count), 0) FROM pump_fills_hourly
+        WHERE bucket >= CURRENT_DATE AND completion_status = 'success')"
+
+ACC_RAW="SELECT time_bucket('1 hour', time) AS time, AVG(error_lbs) AS avg_error FROM pump_fills
+     WHERE time >= NOW() - INTERVAL '24 hours' AND completion_status = 'success'
+     GROUP BY 1 ORDER BY 1"
+ACC_ROLLUP="SELECT bucket AS time, SUM(sum_error_lbs) / NULLIF(SUM(error_count), 0) AS avg_error
+     FROM pump_fills_hourly
+     WHERE bucket >= NOW() - INTERVAL '24 hours' AND completion_status = 'success'
+     GROUP BY bucket ORDER BY bucket"
+run_case accuracy_24h "$ACC_RAW" "$ACC_ROLLUP" \
+    "NOT EXISTS (SELECT FROM ($ACC_RAW) r JOIN ($ACC_ROLLUP) h USING (time)
+                 WHERE abs(r.avg_error - h.avg_error) > 1e-9)"
+
+RATE_RAW="SELECT time_bucket('1 hour', time) AS time, COUNT(*) AS fills FROM pump_fills
+     WHERE time >= NOW() - INTERVAL '7 days' GROUP BY 1 ORDER BY 1"
+RATE_ROLLUP="SELECT bucket AS time, SUM(fill_count) AS fills FROM pump_fills_hourly
+     WHERE bucket >= NOW() - INTERVAL '7 days' GROUP BY bucket ORDER BY bucket"
+run_case fills_per_hour_7d "$RATE_RAW" "$RATE_ROLLUP" \
+    "NOT EXISTS (SELECT FROM ($RATE_RAW) r JOIN ($RATE_ROLLUP) h USING (time)
+                 WHERE r.fills <> h.fills)"
+
+# The former daily_pump_summary view, verbatim
+DAILY_RAW="SELECT DATE(time) as date, device_id,
+    COUNT(*) FILTER (WHERE completion_status = 'success') as successful_fills,
+    COUNT(*) FILTER (WHERE completion_status = 'error') as error_fills,
+    COUNT(*) FILTER (WHERE completion_status = 'cancelled') as cancelled_fills,
+    SUM(actual_lbs) FILTER (WHERE completion_status = 'success') as total_lbs_dispensed,
+    AVG(actual_lbs) FILTER (WHERE completion_status = 'success') as avg_fill_lbs,
+    AVG(error_lbs) FILTER (WHERE completion_status = 'success') as avg_error_lbs,
+    STDDEV(error_lbs) FILTER (WHERE completion_status = 'success') as stddev_error_lbs,
+    AVG(fill_time_ms) FILTER (WHERE completion_status = 'success') / 1000.0 as avg_fill_time_sec,
+    MIN(error_lbs) as min_error, MAX(error_lbs) as max_error
+FROM pump_fills GROUP BY DATE(time), device_id ORDER BY date DESC"
+DAILY_ROLLUP="SELECT * FROM daily_pump_summary"
+run_case daily_summary_1y "$DAILY_RAW" "$DAILY_ROLLUP" \
+    "NOT EXISTS (SELECT FROM ($DAILY_RAW) r JOIN ($DAILY_ROLLUP) h USING (date, device_id)
+                 WHERE r.successful_fills <> h.successful_fills
+                    OR r.error_fills <> h.error_fills
+                    OR abs(r.avg_error_lbs - h.avg_error_lbs) > 1e-9
+                    OR abs(r.stddev_error_lbs - h.stddev_error_lbs) > 1e-6
+                    OR r.max_error <> h.max_error)"
+
+TREND_RAW="SELECT time_bucket('1 minute', time) AS time, device_id,
+     AVG(current_pressure_pct) AS avg_pressure_pct, MAX(current_weight_lbs) AS max_weight_lbs
+     FROM pump_status WHERE time >= NOW() - INTERVAL '7 days' GROUP BY 1, 2 ORDER BY 1"
+TREND_ROLLUP="SELECT bucket AS time, device_id, avg_pressure_pct, max_weight_lbs
+     FROM pump_status_1m WHERE bucket >= NOW() - INTERVAL '7 days' ORDER BY bucket"
+run_case status_trend_7d "$TREND_RAW" "$TREND_ROLLUP" \
+    "NOT EXISTS (SELECT FROM ($TREND_RAW) r JOIN ($TREND_ROLLUP) h USING (time, device_id)
+                 WHERE abs(r.avg_pressure_pct - h.avg_pressure_pct) > 1e-9
+                    OR r.max_weight_lbs <> h.max_weight_lbs)"
+
+echo
+echo "Leaving $DB in place; drop it with: $PSQL -d postgres -c 'DROP DATABASE $DB'"
@@ -0,0 +1,316 @@
+/**
+ * @file http_load.c
+ * @brief Minimal HTTP load generator for the pump controller WebUI/API
+ *
+ * Runs on Linux against the firmware (or a host build of the webserver
+ * component). Opens N concurrent client threads hammering one URI and,
+ * optionally, M "slow" clients that trickle a POST body one byte per second
+ * to verify that stalled clients cannot starve the UI.
+ *
+ * Build:
+ *   gcc -O2 -pthread -o http_load tools/http_load/http_load.c
+ *
+ * Usage:
+ *   ./http_load -h 192.168.1.50 [-p 80] [-c 4] [-d 10] [-u /api/status] [-s 2]
+ *
+ * Reports requests/s, error and non-2xx counts, and p50/p90/p99/max latency.
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SAMPLES_PER_THREAD 200000
+#define RESPONSE_BUF_SIZE 16384
+
+typedef struct {
+    const char *host;
+    const char *port;
+    const char *uri;
+    int connections;
+    int duration_s;
+    int slow_clients;
+} load_config_t;
+
+typedef struct {
+    pthread_t thread;
+    uint32_t *latencies_us;
+    size_t count;
+    uint32_t errors;
+    uint32_t non_2xx;
+} worker_t;
+
+static load_config_t s_cfg = {
+    .host = NULL,
+    .port = "80",
+    .uri = "/api/status",
+    .connections = 4,
+    .duration_s = 10,
+    .slow_clients = 0,
+};
+
+static atomic_bool s_running = true;
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int connect_to_server(void)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo *res = NULL;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(s_cfg.host, s_cfg.port, &hints, &res) != 0) {
+        return -1;
+    }
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return -1;
+    }
+
+    // Never let the load generator itself hang on a dead peer
+    struct timeval tv = {.tv_sec = 10, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    if (connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+
+/**
+ * @brief Issue one GET request and read the full response
+ * @return HTTP status code, or -1 on error
+ */
+static int do_request(void)
+{
+    char buf[RESPONSE_BUF_SIZE];
+    int fd = connect_to_server();
+    if (fd < 0) {
+        return -1;
+    }
+
+    int len = snprintf(buf, sizeof(buf),
+                       "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                       s_cfg.uri, s_cfg.host);
+    if (send(fd, buf, len, 0) != len) {
+        close(fd);
+        return -1;
+    }
+
+    // Read until the server closes the connection
+    int status = -1;
+    size_t total = 0;
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf) - 1, 0)) > 0) {
+        if (total == 0) {
+            buf[n] = '\0';
+            if (sscanf(buf, "HTTP/1.%*d %d", &status) != 1) {
+                status = -1;
+            }
+        }
+        total += n;
+    }
+
+    close(fd);
+    return (n < 0) ? -1 : status;
+}
+
+static void *worker_thread(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+
+    while (atomic_load(&s_running)) {
+        uint64_t start = now_us();
+        int status = do_request();
+        uint64_t elapsed = now_us() - start;
+
+        if (status < 0) {
+            w->errors++;
+            continue;
+        }
+        if (status < 200 || status >= 300) {
+            w->non_2xx++;
+        }
+        if (w->count < MAX_SAMPLES_PER_THREAD) {
+            w->latencies_us[w->count++] = (uint32_t)elapsed;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Slow client: declares a body and sends it one byte per second
+ */
+static void *slow_client_thread(void *arg)
+{
+    (void)arg;
+    static const char body[] = "{\"target\":200.0}";
+    char hdr[256];
+
+    while (atomic_load(&s_running)) {
+        int fd = connect_to_server();
+        if (fd < 0) {
+            sleep(1);
+            continue;
+        }
+
+        int len = snprintf(hdr, sizeof(hdr),
+                           "POST /api/set_target HTTP/1.1\r\nHost: %s\r\n"
+                           "Content-Type: application/json\r\nContent-Length: %zu\r\n\r\n",
+                           s_cfg.host, sizeof(body) - 1);
+        if (send(fd, hdr, len, MSG_NOSIGNAL) == len) {
+            for (size_t i = 0; i < sizeof(body) - 1 && atomic_load(&s_running); i++) {
+                if (send(fd, &body[i], 1, MSG_NOSIGNAL) != 1) {
+                    break;  // Server dropped us, which is the point
+                }
+                sleep(1);
+            }
+        }
+        close(fd);
+    }
+
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t n, double p)
+{
+    if (n == 0) {
+        return 0;
+    }
+    size_t idx = (size_t)(p / 100.0 * (double)(n - 1) + 0.5);
+    return sorted[idx];
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -h host [-p port] [-c connections] [-d seconds] [-u uri] [-s slow_clients]\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:c:d:u:s:")) != -1) {
+        switch (opt) {
+            case 'h': s_cfg.host = optarg; break;
+            case 'p': s_cfg.port = optarg; break;
+            case 'c': s_cfg.connections = atoi(optarg); break;
+            case 'd': s_cfg.duration_s = atoi(optarg); break;
+            case 'u': s_cfg.uri = optarg; break;
+            case 's': s_cfg.slow_clients = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (s_cfg.host == NULL || s_cfg.connections <= 0 || s_cfg.duration_s <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("Target: http://%s:%s%s\n", s_cfg.host, s_cfg.port, s_cfg.uri);
+    printf("Connections: %d, slow clients: %d, duration: %d s\n",
+           s_cfg.connections, s_cfg.slow_clients, s_cfg.duration_s);
+
+    worker_t *workers = calloc(s_cfg.connections, sizeof(worker_t));
+    pthread_t *slow = calloc(s_cfg.slow_clients > 0 ? s_cfg.slow_clients : 1, sizeof(pthread_t));
+    if (workers == NULL || slow == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    // Start slow clients first so they grab sockets before the measured load
+    for (int i = 0; i < s_cfg.slow_clients; i++) {
+        pthread_create(&slow[i], NULL, slow_client_thread, NULL);
+    }
+    if (s_cfg.slow_clients > 0) {
+        sleep(1);
+    }
+
+    uint64_t start = now_us();
+    for (int i = 0; i < s_cfg.connections; i++) {
+        workers[i].latencies_us = malloc(MAX_SAMPLES_PER_THREAD * sizeof(uint32_t));
+        if (workers[i].latencies_us == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        pthread_create(&workers[i].thread, NULL, worker_thread, &workers[i]);
+    }
+
+    sleep(s_cfg.duration_s);
+    atomic_store(&s_running, false);
+
+    for (int i = 0; i < s_cfg.connections; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    double elapsed_s = (now_us() - start) / 1e6;
+
+    for (int i = 0; i < s_cfg.slow_clients; i++) {
+        pthread_join(slow[i], NULL);
+    }
+
+    // Merge samples
+    size_t total = 0;
+    uint32_t errors = 0;
+    uint32_t non_2xx = 0;
+    for (int i = 0; i < s_cfg.connections; i++) {
+        total += workers[i].count;
+        errors += workers[i].errors;
+        non_2xx += workers[i].non_2xx;
+    }
+
+    uint32_t *all = malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+    if (all == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    size_t pos = 0;
+    for (int i = 0; i < s_cfg.connections; i++) {
+        memcpy(&all[pos], workers[i].latencies_us, workers[i].count * sizeof(uint32_t));
+        pos += workers[i].count;
+        free(workers[i].latencies_us);
+    }
+    qsort(all, total, sizeof(uint32_t), cmp_u32);
+
+    printf("\nRequests:     %zu completed, %u errors, %u non-2xx\n", total, errors, non_2xx);
+    printf("Throughput:   %.1f req/s\n", total / elapsed_s);
+    printf("Latency p50:  %.2f ms\n", percentile(all, total, 50.0) / 1000.0);
+    printf("Latency p90:  %.2f ms\n", percentile(all, total, 90.0) / 1000.0);
+    printf("Latency p99:  %.2f ms\n", percentile(all, total, 99.0) / 1000.0);
+    printf("Latency max:  %.2f ms\n", total ? all[total - 1] / 1000.0 : 0.0);
+
+    free(all);
+    free(workers);
+    free(slow);
+    return (errors > 0 && total == 0) ? 1 : 0;
+}
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Report static RAM use per subsystem from the linker map and check budgets.
+
+Parses the GNU ld map file of the firmware build, sums .bss/.data (DRAM),
+.iram and RTC input sections per component archive, groups them into the
+subsystems defined in budget.json and fails if any subsystem, or the DRAM
+total, is over budget. Task stacks, queues and buffers are all static (see
+config.h "APPLICATION TASKS"), so what this reports is what the firmware
+uses before the heap is touched.
+
+Usage:
+    mem_budget.py <firmware.map> [--budget budget.json] [--top N] [--warn-only]
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+
+# Input section prefix -> memory region
+REGIONS = [
+    (".rtc_noinit", "rtc"),
+    (".rtc.", "rtc"),
+    (".iram", "iram"),
+    (".bss", "dram"),
+    (".sbss", "dram"),
+    ("COMMON", "dram"),
+    (".data", "dram"),
+    (".sdata", "dram"),
+    (".dram1", "dram"),
+]
+
+ENTRY_RE = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$")
+ARCHIVE_RE = re.compile(r"lib([^/\\]+)\.a\(")
+SEGMENT_RE = re.compile(r"^(\w+)\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)")
+
+
+def region_for(section):
+    for prefix, region in REGIONS:
+        if section.startswith(prefix):
+            return region
+    return None
+
+
+def component_for(path):
+    match = ARCHIVE_RE.search(path)
+    if match:
+        return match.group(1)
+    return os.path.basename(path.split("(")[0])
+
+
+def symbol_for(section):
+    """'.bss.s_scale_stack' -> 's_scale_stack'."""
+    parts = section.split(".", 2)
+    return parts[2] if len(parts) == 3 else section
+
+
+def parse_map(path):
+    """Yield (region, component, symbol, size) for every placed RAM input section."""
+    segments = {}
+    entries = []
+    in_memory_config = False
+    in_memory_map = False
+    pending = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+
+            if line.startswith("Memory Configuration"):
+                in_memory_config = True
+                continue
+            if line.startswith("Linker script and memory map"):
+                in_memory_config = False
+                in_memory_map = True
+                continue
+
+            if in_memory_config:
+                match = SEGMENT_RE.match(line)
+                if match:
+                    segments[match.group(1)] = int(match.group(3), 16)
+                continue
+            if not in_memory_map:
+                continue
+
+            # Input sections are indented; long names wrap onto the next line
+            stripped = line.strip()
+            if line.startswith(" ") and stripped and " " not in stripped and pending is None:
+                if region_for(stripped):
+                    pending = stripped
+                continue
+
+            match = ENTRY_RE.match(line)
+            if pending is not None:
+                section = pending
+                pending = None
+                if not match:
+                    continue
+                size, where = int(match.group(2), 16), match.group(3)
+            else:
+                parts = stripped.split(None, 3)
+                if not line.startswith(" ") or len(parts) != 4 or not parts[1].startswith("0x"):
+                    continue
+                section = parts[0]
+                try:
+                    size = int(parts[2], 16)
+                except ValueError:
+                    continue
+                where = parts[3]
+
+            region = region_for(section)
+            if region is None or size == 0 or section.startswith("*fill*"):
+                continue
+            entries.append((region, component_for(where), symbol_for(section), size))
+
+    return entries, segments
+
+
+def load_budget(path):
+    with open(path) as f:
+        budget = json.load(f)
+    for name, sub in budget["subsystems"].items():
+        sub["symbol_re"] = [re.compile(p) for p in sub.get("symbols", [])]
+        sub.setdefault("components", [])
+    return budget
+
+
+def classify(budget, component, symbol):
+    # The app component holds several subsystems' task stacks: split it by symbol
+    if component in budget.get("app_components", []):
+        for name, sub in budget["subsystems"].items():
+            if any(r.search(symbol) for r in sub["symbol_re"]):
+                return name
+    for name, sub in budget["subsystems"].items():
+        if component in sub["components"]:
+            return name
+    return budget.get("default_subsystem", "platform")
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("map", help="linker map file, e.g. .pio/build/esp32dev/firmware.map")
+    parser.add_argument("--budget", default=os.path.join(here, "budget.json"))
+    parser.add_argument("--top", type=int, default=5, help="largest symbols listed per subsystem")
+    parser.add_argument("--warn-only", action="store_true", help="never fail")
+    args = parser.parse_args()
+
+    budget = load_budget(args.budget)
+    entries, segments = parse_map(args.map)
+    if not entries:
+        print(f"mem_budget: no RAM sections found in {args.map}", file=sys.stderr)
+        return 1
+
+    totals = defaultdict(lambda: defaultdict(int))
+    symbols = defaultdict(list)
+    region_totals = defaultdict(int)
+    for region, component, symbol, size in entries:
+        sub = classify(budget, component, symbol)
+        totals[sub][region] += size
+        region_totals[region] += size
+        if region in ("dram", "rtc"):
+            symbols[sub].append((size, f"{component}:{symbol}"))
+
+    over = []
+    print("Static RAM by subsystem (bytes)")
+    print(f"{'subsystem':<14} {'dram':>8} {'budget':>8} {'use%':>6} {'iram':>8} {'rtc':>6}")
+    names = list(budget["subsystems"]) + [n for n in totals if n not in budget["subsystems"]]
+    for name in names:
+        t = totals.get(name, {})
+        limit = budget["subsystems"].get(name, {}).get("dram_budget")
+        use = f"{100.0 * t.get('dram', 0) / limit:5.1f}" if limit else "    -"
+        print(f"{name:<14} {t.get('dram', 0):>8} {limit or '-':>8} {use:>6} "
+              f"{t.get('iram', 0):>8} {t.get('rtc', 0):>6}")
+        if limit and t.get("dram", 0) > limit:
+            over.append(f"{name}: {t['dram']} > {limit}")
+
+    dram_total = region_totals["dram"]
+    dram_limit = budget.get("dram_total_budget")
+    print(f"{'TOTAL':<14} {dram_total:>8} {dram_limit or '-':>8} {'':>6} "
+          f"{region_totals['iram']:>8} {region_totals['rtc']:>6}")
+    if dram_limit and dram_total > dram_limit:
+        over.append(f"DRAM total: {dram_total} > {dram_limit}")
+    for seg in ("dram0_0_seg", "rtc_slow_seg"):
+        if seg in segments:
+            print(f"  {seg}: {segments[seg]} bytes")
+
+    if args.top > 0:
+        print()
+        for name in budget["subsystems"]:
+            largest = sorted(symbols.get(name, []), reverse=True)[:args.top]
+            if largest:
+                print(f"{name}: " + ", ".join(f"{sym} {size}" for size, sym in largest))
+
+    if over:
+        print("\nOVER BUDGET:\n  " + "\n  ".join(over), file=sys.stderr)
+        return 0 if args.warn_only else 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,25 @@
+"""
+PlatformIO post-link hook: run mem_budget.py on the firmware map.
+
+Enabled from platformio.ini:
+    extra_scripts = post:tools/mem_budget/pio_mem_budget.py
+"""
+
+import os
+import subprocess
+import sys
+
+Import("env")  # noqa: F821 (provided by SCons)
+
+
+def check_mem_budget(source, target, env):
+    script = os.path.join(env.subst("$PROJECT_DIR"), "tools", "mem_budget", "mem_budget.py")
+    map_file = env.subst("$BUILD_DIR/${PROGNAME}.map")
+    if not os.path.isfile(map_file):
+        print(f"mem_budget: {map_file} not found, skipping")
+        return
+    if subprocess.call([sys.executable, script, map_file]) != 0:
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_mem_budget)  # noqa: F821
@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+#
+# Build the webserver component for Linux and benchmark it
+#
+# Compiles components/webserver/webserver.c against the shims in shim/,
+# with g_system_state driven by the plant simulator, then measures
+# requests/s and p50/p99 latency of /api/status and / with tools/http_load.
+#
+# Requires only gcc.
+#
+# Usage: tools/webserver_host/bench.sh [connections] [seconds] [slow_clients]
+
+set -euo pipefail
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+ROOT="$(cd "$HERE/../.." && pwd)"
+OUT="${OUT:-$ROOT/.host_build}"
+PORT="${PORT:-8080}"
+CONNECTIONS="${1:-4}"
+DURATION="${2:-10}"
+SLOW="${3:-0}"
+
+mkdir -p "$OUT"
+
+echo "Building webserver host binary..."
+gcc -O2 -g -Wall -pthread \
+    -I"$HERE/shim" -I"$ROOT/include" -I"$ROOT/components/webserver" \
+    "$ROOT/components/webserver/webserver.c" \
+    "$ROOT/components/ctrl_profiler/ctrl_profiler.c" \
+    "$ROOT/components/flight_recorder/flight_recorder.c" \
+    "$ROOT/components/state_transition/state_transition.c" \
+    "$ROOT/components/task_monitor/task_monitor.c" \
+    "$ROOT/components/heap_monitor/heap_monitor.c" \
+    "$ROOT/components/startup/startup.c" \
+    "$HERE/httpd_shim.c" "$HERE/freertos_shim.c" "$HERE/plant_sim.c" "$HERE/host_main.c" \
+    -lm \
+    -o "$OUT/webserver_host"
+
+echo "Building load generator..."
+gcc -O2 -Wall -pthread "$ROOT/tools/http_load/http_load.c" -o "$OUT/http_load"
+
+"$OUT/webserver_host" -p "$PORT" -x 10 > "$OUT/webserver_host.log" 2>&1 &
+SERVER_PID=$!
+trap 'kill $SERVER_PID 2>/dev/null || true' EXIT
+sleep 1
+
+for uri in /api/status /; do
+    echo
+    echo "=== $uri ==="
+    "$OUT/http_load" -h 127.0.0.1 -p "$PORT" -c "$CONNECTIONS" -d "$DURATION" -u "$uri" -s "$SLOW"
+done
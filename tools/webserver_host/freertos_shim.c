@@ -0,0 +1,474 @@
+/**
+ * @file freertos_shim.c
+ * @brief pthread implementation of the FreeRTOS/esp_timer subset (host build)
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =============================================================================
+ * TIME
+ * ===========================================================================*/
+
+static int64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static int64_t s_boot_us = 0;
+
+int64_t esp_timer_get_time(void)
+{
+    if (s_boot_us == 0) {
+        s_boot_us = monotonic_us();
+    }
+    return monotonic_us() - s_boot_us;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Absolute CLOCK_REALTIME deadline for pthread_cond_timedwait
+ */
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+/* =============================================================================
+ * CRITICAL SECTIONS
+ * ===========================================================================*/
+
+static pthread_mutex_t s_critical = PTHREAD_MUTEX_INITIALIZER;
+
+void host_enter_critical(void)
+{
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_exit_critical(void)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+/* =============================================================================
+ * TASKS
+ * ===========================================================================*/
+
+#define HOST_MAX_TASKS 32
+
+struct host_task {
+    bool used;
+    pthread_t thread;
+    char name[16];
+    UBaseType_t priority;
+    uint32_t stack_depth;
+    BaseType_t core_id;
+    UBaseType_t number;
+};
+
+/* Task registry for uxTaskGetSystemState(), guarded by s_tasks_lock */
+static struct host_task s_tasks[HOST_MAX_TASKS];
+static pthread_mutex_t s_tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static UBaseType_t s_task_number = 0;
+
+typedef struct {
+    TaskFunction_t fn;
+    void *param;
+    struct host_task *task;
+} task_start_t;
+
+static void unregister_self(void)
+{
+    pthread_mutex_lock(&s_tasks_lock);
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        if (s_tasks[i].used && pthread_equal(s_tasks[i].thread, pthread_self())) {
+            s_tasks[i].used = false;
+        }
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+}
+
+static void *task_trampoline(void *arg)
+{
+    task_start_t start = *(task_start_t *)arg;
+    free(arg);
+    start.fn(start.param);
+    unregister_self();
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *param, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core_id)
+{
+    task_start_t *start = malloc(sizeof(task_start_t));
+    if (start == NULL) {
+        return pdFAIL;
+    }
+    start->fn = fn;
+    start->param = param;
+
+    // Hold the lock until the thread ID is stored, so the task cannot exit first
+    pthread_mutex_lock(&s_tasks_lock);
+    struct host_task *task = NULL;
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        if (!s_tasks[i].used) {
+            task = &s_tasks[i];
+            break;
+        }
+    }
+    if (task == NULL) {
+        pthread_mutex_unlock(&s_tasks_lock);
+        free(start);
+        return pdFAIL;
+    }
+    start->task = task;
+
+    if (pthread_create(&task->thread, NULL, task_trampoline, start) != 0) {
+        pthread_mutex_unlock(&s_tasks_lock);
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+
+    task->used = true;
+    strncpy(task->name, name, sizeof(task->name) - 1);
+    task->name[sizeof(task->name) - 1] = '\0';
+    task->priority = priority;
+    task->stack_depth = stack_depth;
+    task->core_id = (core_id < 0) ? tskNO_AFFINITY : core_id;
+    task->number = ++s_task_number;
+    pthread_mutex_unlock(&s_tasks_lock);
+
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, param, priority, handle, -1);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                           void *param, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *tcb, BaseType_t core_id)
+{
+    (void)stack;
+    (void)tcb;
+
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(fn, name, stack_depth, param, priority, &handle, core_id);
+    return handle;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                               void *param, UBaseType_t priority, StackType_t *stack,
+                               StaticTask_t *tcb)
+{
+    return xTaskCreateStaticPinnedToCore(fn, name, stack_depth, param, priority, stack, tcb, -1);
+}
+
+void vTaskDelete(TaskHandle_t handle)
+{
+    if (handle == NULL) {
+        unregister_self();
+        pthread_exit(NULL);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    TaskHandle_t handle = NULL;
+    pthread_mutex_lock(&s_tasks_lock);
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        if (s_tasks[i].used && pthread_equal(s_tasks[i].thread, pthread_self())) {
+            handle = &s_tasks[i];
+        }
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+    return handle;
+}
+
+char *pcTaskGetName(TaskHandle_t handle)
+{
+    struct host_task *task = handle ? handle : xTaskGetCurrentTaskHandle();
+    return task ? task->name : "main";
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    UBaseType_t count = 0;
+    pthread_mutex_lock(&s_tasks_lock);
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        count += s_tasks[i].used ? 1 : 0;
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+    return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t max, uint32_t *total_runtime)
+{
+    UBaseType_t count = 0;
+
+    pthread_mutex_lock(&s_tasks_lock);
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        struct host_task *task = &s_tasks[i];
+        if (!task->used) {
+            continue;
+        }
+        if (count == max) {
+            count = 0;  // Like FreeRTOS: nothing is reported if the array is too small
+            break;
+        }
+
+        uint32_t cpu_us = 0;
+        clockid_t clock;
+        struct timespec ts;
+        if (pthread_getcpuclockid(task->thread, &clock) == 0 && clock_gettime(clock, &ts) == 0) {
+            cpu_us = (uint32_t)((int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000);
+        }
+
+        status[count++] = (TaskStatus_t){
+            .xHandle = task,
+            .pcTaskName = task->name,
+            .xTaskNumber = task->number,
+            .eCurrentState = eBlocked,
+            .uxCurrentPriority = task->priority,
+            .uxBasePriority = task->priority,
+            .ulRunTimeCounter = cpu_us,
+            .usStackHighWaterMark = task->stack_depth,
+            .xCoreID = task->core_id,
+        };
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+
+    if (total_runtime) {
+        *total_runtime = (uint32_t)esp_timer_get_time();
+    }
+    return count;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+/* =============================================================================
+ * QUEUES
+ * ===========================================================================*/
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t storage[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t q = calloc(1, sizeof(struct host_queue) + (size_t)length * item_size);
+    if (q == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage,
+                                 StaticQueue_t *queue_buf)
+{
+    (void)storage;
+    (void)queue_buf;
+    return xQueueCreate(length, item_size);
+}
+
+static bool wait_on(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks,
+                    const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (!wait_on(&q->not_full, &q->lock, ticks_to_wait, &deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(&q->storage[(size_t)tail * q->item_size], item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks_to_wait)
+{
+    struct timespec deadline = deadline_after(ticks_to_wait);
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (!wait_on(&q->not_empty, &q->lock, ticks_to_wait, &deadline)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, &q->storage[(size_t)q->head * q->item_size], q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t spaces = q->length - q->count;
+    pthread_mutex_unlock(&q->lock);
+    return spaces;
+}
+
+/* =============================================================================
+ * EVENT GROUPS
+ * ===========================================================================*/
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    EventGroupHandle_t g = calloc(1, sizeof(struct host_event_group));
+    if (g) {
+        pthread_mutex_init(&g->lock, NULL);
+    }
+    return g;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *group_buf)
+{
+    (void)group_buf;
+    return xEventGroupCreate();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->lock);
+    g->bits |= bits;
+    EventBits_t now = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    pthread_mutex_lock(&g->lock);
+    EventBits_t before = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return before;
+}
+
+/* Polls: nothing on the host waits on event bits in a hot path */
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    TickType_t waited = 0;
+
+    while (1) {
+        pthread_mutex_lock(&g->lock);
+        EventBits_t now = g->bits;
+        bool done = wait_for_all ? ((now & bits) == bits) : ((now & bits) != 0);
+        if (done && clear_on_exit) {
+            g->bits &= ~bits;
+        }
+        pthread_mutex_unlock(&g->lock);
+
+        if (done || waited >= ticks_to_wait) {
+            return now;
+        }
+        vTaskDelay(1);
+        waited++;
+    }
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g)
+{
+    pthread_mutex_lock(&g->lock);
+    EventBits_t now = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
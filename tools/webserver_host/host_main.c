@@ -0,0 +1,60 @@
+/**
+ * @file host_main.c
+ * @brief Linux host build of the webserver component
+ *
+ * Compiles components/webserver/webserver.c unchanged against the shims in
+ * shim/ and serves it on a local port, with g_system_state driven by the
+ * plant simulator. Used to measure UI/API performance without hardware.
+ *
+ * Usage:
+ *   ./webserver_host [-p port] [-m] [-x time_scale]
+ *     -p  listen port (default 8080)
+ *     -m  manual mode: no automatic fill cycling
+ *     -x  simulation speed-up factor (default 1.0)
+ *
+ * See bench.sh for the build command and benchmark.
+ */
+
+#include "webserver.h"
+#include "plant_sim.h"
+#include "task_monitor.h"
+#include "esp_http_server.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Bound port; webserver.c keeps WEBSERVER_PORT from config.h (see httpd_shim.c) */
+extern uint16_t g_host_http_port;
+
+int main(int argc, char **argv)
+{
+    bool auto_cycle = true;
+    float time_scale = 1.0f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:mx:")) != -1) {
+        switch (opt) {
+            case 'p': g_host_http_port = (uint16_t)atoi(optarg); break;
+            case 'm': auto_cycle = false; break;
+            case 'x': time_scale = strtof(optarg, NULL); break;
+            default:
+                fprintf(stderr, "Usage: %s [-p port] [-m] [-x time_scale]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    plant_sim_start(auto_cycle, time_scale);
+    task_monitor_init();
+
+    if (webserver_init() != ESP_OK) {
+        return 1;
+    }
+
+    printf("Serving WebUI on http://127.0.0.1:%u/\n", g_host_http_port);
+    fflush(stdout);
+
+    while (1) {
+        pause();
+    }
+}
@@ -0,0 +1,412 @@
+/**
+ * @file httpd_shim.c
+ * @brief POSIX implementation of the esp_http_server subset (host build)
+ */
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char *TAG = "HTTPD_SHIM";
+
+/* Port actually bound on the host (config.server_port is the device's 80) */
+uint16_t g_host_http_port = 8080;
+
+#define MAX_HANDLERS 16
+#define HEADER_BUF_SIZE 2048
+
+typedef struct {
+    int listen_fd;
+    httpd_config_t config;
+    httpd_uri_t handlers[MAX_HANDLERS];
+    size_t handler_count;
+    pthread_t thread;
+    volatile bool running;
+} host_server_t;
+
+/* Per-request connection state, hung off httpd_req_t.aux */
+typedef struct {
+    int fd;
+    char status[40];
+    char type[64];
+    char extra_hdrs[256];
+    char pending[HEADER_BUF_SIZE];  // Body bytes read along with the headers
+    size_t pending_len;
+    size_t pending_off;
+    size_t body_remaining;
+    bool chunked;                   // Chunked response in progress
+} host_req_aux_t;
+
+static int send_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int send_headers(httpd_req_t *r, long content_len)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    char hdr[512];
+    int len;
+
+    if (content_len >= 0) {
+        len = snprintf(hdr, sizeof(hdr),
+                       "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %ld\r\n%s"
+                       "Connection: close\r\n\r\n",
+                       aux->status, aux->type, content_len, aux->extra_hdrs);
+    } else {
+        len = snprintf(hdr, sizeof(hdr),
+                       "HTTP/1.1 %s\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n%s"
+                       "Connection: close\r\n\r\n",
+                       aux->status, aux->type, aux->extra_hdrs);
+    }
+    return send_all(aux->fd, hdr, len);
+}
+
+static void free_req(httpd_req_t *r)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    shutdown(aux->fd, SHUT_WR);
+    close(aux->fd);
+    free(aux);
+    free(r);
+}
+
+static const httpd_uri_t *find_handler(host_server_t *srv, const char *uri, int method,
+                                       bool *uri_known)
+{
+    *uri_known = false;
+    for (size_t i = 0; i < srv->handler_count; i++) {
+        if (strcmp(srv->handlers[i].uri, uri) == 0) {
+            *uri_known = true;
+            if ((int)srv->handlers[i].method == method) {
+                return &srv->handlers[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Read and parse request line + headers, then dispatch
+ */
+static void serve_connection(host_server_t *srv, int fd)
+{
+    httpd_req_t *r = calloc(1, sizeof(httpd_req_t));
+    host_req_aux_t *aux = calloc(1, sizeof(host_req_aux_t));
+    if (r == NULL || aux == NULL) {
+        free(r);
+        free(aux);
+        close(fd);
+        return;
+    }
+
+    aux->fd = fd;
+    strcpy(aux->status, "200 OK");
+    strcpy(aux->type, "text/html");
+    r->aux = aux;
+    r->handle = srv;
+
+    struct timeval tv = {.tv_sec = srv->config.recv_wait_timeout, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv.tv_sec = srv->config.send_wait_timeout;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Read until end of headers
+    char buf[HEADER_BUF_SIZE];
+    size_t len = 0;
+    char *hdr_end = NULL;
+    while (hdr_end == NULL && len < sizeof(buf) - 1) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) {
+            free_req(r);
+            return;
+        }
+        len += n;
+        buf[len] = '\0';
+        hdr_end = strstr(buf, "\r\n\r\n");
+    }
+    if (hdr_end == NULL) {
+        free_req(r);
+        return;
+    }
+
+    char method[8] = {0};
+    char uri[HTTPD_MAX_URI_LEN + 1] = {0};
+    if (sscanf(buf, "%7s %512s", method, uri) != 2) {
+        free_req(r);
+        return;
+    }
+    char *query = strchr(uri, '?');
+    if (query) {
+        *query = '\0';
+    }
+    memcpy((char *)r->uri, uri, sizeof(uri));
+    r->method = (strcmp(method, "POST") == 0) ? HTTP_POST : HTTP_GET;
+
+    for (char *line = strstr(buf, "\r\n"); line && line < hdr_end; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, "Content-Length:", 15) == 0) {
+            r->content_len = strtoul(line + 17, NULL, 10);
+        }
+    }
+
+    // Anything after the blank line is the start of the body
+    size_t hdr_len = (hdr_end + 4) - buf;
+    aux->pending_len = len - hdr_len;
+    memcpy(aux->pending, hdr_end + 4, aux->pending_len);
+    aux->body_remaining = r->content_len;
+
+    bool uri_known;
+    const httpd_uri_t *h = find_handler(srv, r->uri, r->method, &uri_known);
+    if (h == NULL) {
+        httpd_resp_send_err(r, uri_known ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND,
+                            "Not found");
+        free_req(r);
+        return;
+    }
+
+    r->user_ctx = h->user_ctx;
+    h->handler(r);
+
+    // aux may already be freed by a worker: only r itself is still ours
+    if (r->aux != NULL) {
+        free_req(r);
+    } else {
+        free(r);  // The async copy owns aux and the socket
+    }
+}
+
+static void *server_thread(void *arg)
+{
+    host_server_t *srv = (host_server_t *)arg;
+
+    while (srv->running) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        serve_connection(srv, fd);
+    }
+
+    return NULL;
+}
+
+/* =============================================================================
+ * SERVER LIFECYCLE
+ * ===========================================================================*/
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    host_server_t *srv = calloc(1, sizeof(host_server_t));
+    if (srv == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    srv->config = *config;
+
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(g_host_http_port);
+
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(srv->listen_fd, config->max_open_sockets) != 0) {
+        ESP_LOGE(TAG, "Cannot listen on port %u: %s", g_host_http_port, strerror(errno));
+        close(srv->listen_fd);
+        free(srv);
+        return ESP_FAIL;
+    }
+
+    srv->running = true;
+    pthread_create(&srv->thread, NULL, server_thread, srv);
+
+    *handle = srv;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    host_server_t *srv = (host_server_t *)handle;
+    srv->running = false;
+    shutdown(srv->listen_fd, SHUT_RDWR);
+    close(srv->listen_fd);
+    pthread_join(srv->thread, NULL);
+    free(srv);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    host_server_t *srv = (host_server_t *)handle;
+    if (srv->handler_count >= MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    srv->handlers[srv->handler_count++] = *uri_handler;
+    return ESP_OK;
+}
+
+/* =============================================================================
+ * REQUEST API
+ * ===========================================================================*/
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+
+    if (aux->body_remaining == 0) {
+        return 0;
+    }
+    if (buf_len > aux->body_remaining) {
+        buf_len = aux->body_remaining;
+    }
+
+    if (aux->pending_off < aux->pending_len) {
+        size_t n = aux->pending_len - aux->pending_off;
+        if (n > buf_len) {
+            n = buf_len;
+        }
+        memcpy(buf, aux->pending + aux->pending_off, n);
+        aux->pending_off += n;
+        aux->body_remaining -= n;
+        return (int)n;
+    }
+
+    ssize_t n = recv(aux->fd, buf, buf_len, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return HTTPD_SOCK_ERR_TIMEOUT;
+    }
+    if (n <= 0) {
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    aux->body_remaining -= n;
+    return (int)n;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out)
+{
+    httpd_req_t *copy = malloc(sizeof(httpd_req_t));
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, r, sizeof(httpd_req_t));
+    r->aux = NULL;  // The original must not be used to respond any more
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r)
+{
+    free_req(r);
+    return ESP_OK;
+}
+
+/* =============================================================================
+ * RESPONSE API
+ * ===========================================================================*/
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    snprintf(aux->status, sizeof(aux->status), "%s", status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    snprintf(aux->type, sizeof(aux->type), "%s", type);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    size_t used = strlen(aux->extra_hdrs);
+    snprintf(aux->extra_hdrs + used, sizeof(aux->extra_hdrs) - used, "%s: %s\r\n", field, value);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = (buf != NULL) ? (ssize_t)strlen(buf) : 0;
+    }
+    if (send_headers(r, buf_len) != 0 || (buf_len > 0 && send_all(aux->fd, buf, buf_len) != 0)) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    host_req_aux_t *aux = (host_req_aux_t *)r->aux;
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = (buf != NULL) ? (ssize_t)strlen(buf) : 0;
+    }
+
+    if (!aux->chunked) {
+        if (send_headers(r, -1) != 0) {
+            return ESP_FAIL;
+        }
+        aux->chunked = true;
+    }
+
+    char size_line[16];
+    int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", (size_t)buf_len);
+    if (send_all(aux->fd, size_line, n) != 0 ||
+        (buf_len > 0 && send_all(aux->fd, buf, buf_len) != 0) ||
+        send_all(aux->fd, "\r\n", 2) != 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send_chunk(r, str, (str != NULL) ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg)
+{
+    static const char *const status[] = {
+        [HTTPD_400_BAD_REQUEST] = "400 Bad Request",
+        [HTTPD_404_NOT_FOUND] = "404 Not Found",
+        [HTTPD_405_METHOD_NOT_ALLOWED] = "405 Method Not Allowed",
+        [HTTPD_408_REQ_TIMEOUT] = "408 Request Timeout",
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = "500 Internal Server Error",
+    };
+    httpd_resp_set_status(r, status[error]);
+    httpd_resp_set_type(r, "text/plain");
+    return httpd_resp_sendstr(r, msg);
+}
@@ -0,0 +1,359 @@
+/**
+ * @file plant_sim.c
+ * @brief Fake g_system_state driven by a simple fill plant simulator
+ *
+ * Stands in for the firmware tasks in the webserver host build. Runs the
+ * fill state machine at the control loop rate using the zone thresholds and
+ * pressure setpoints from config.h, and a flow model from the real testing
+ * data (30 PSI ~ 1.0 lb/s, 65 PSI ~ 3.0 lb/s) plus scale noise.
+ *
+ * With auto-cycle enabled the simulator starts a new fill whenever it is
+ * idle, so status responses keep changing during benchmarks. Fills started
+ * from the API skip the encoder confirmations after a short delay.
+ */
+
+#include "plant_sim.h"
+#include "config.h"
+#include "system_state.h"
+#include "state_transition.h"
+#include "flight_recorder.h"
+#include "startup.h"
+#include "wifi_manager.h"
+#include "power_manager.h"
+#include "deadline_monitor.h"
+#include "batch.h"
+#include "safety_system.h"
+#include "estop.h"
+#include "pressure_controller.h"
+#include "display_driver.h"
+#include "esp_timer.h"
+#include "ctrl_profiler.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Global system state (normally defined in main.c) */
+system_state_t g_system_state = {
+    .state = STATE_IDLE,
+    .target_weight_lbs = DEFAULT_TARGET_WEIGHT_LBS,
+    .scale_online = true,
+    .mqtt_connected = true,
+    .wifi_connected = true,
+};
+
+EventGroupHandle_t g_system_events;
+
+#define SIM_IDLE_HOLD_MS 2000
+#define SIM_SAFETY_HOLD_MS 1000
+#define SIM_COMPLETE_HOLD_MS SETTLE_STABLE_MS   // Stable at once, then the settle window
+#define SIM_NOISE_LBS 0.05f
+
+static bool s_auto_cycle = true;
+static float s_time_scale = 1.0f;
+
+/**
+ * @brief Flow rate for a given pressure (lbs/sec), linear over 30-65 PSI
+ */
+static float flow_for_pressure(float pct)
+{
+    if (pct < PRESSURE_FINE) {
+        return 0.0f;
+    }
+    return 1.0f + (pct - PRESSURE_FINE) * (2.0f / (PRESSURE_FAST - PRESSURE_FINE));
+}
+
+static float scale_noise(void)
+{
+    return ((float)rand() / (float)RAND_MAX - 0.5f) * 2.0f * SIM_NOISE_LBS;
+}
+
+static void select_zone(float percent_complete)
+{
+    if (percent_complete < ZONE_FAST_END) {
+        state_set_zone(ZONE_FAST);
+        g_system_state.pressure_setpoint_pct = PRESSURE_FAST;
+    } else if (percent_complete < ZONE_MODERATE_END) {
+        state_set_zone(ZONE_MODERATE);
+        g_system_state.pressure_setpoint_pct = PRESSURE_MODERATE;
+    } else if (percent_complete < ZONE_SLOW_END) {
+        state_set_zone(ZONE_SLOW);
+        g_system_state.pressure_setpoint_pct = PRESSURE_SLOW;
+    } else {
+        state_set_zone(ZONE_FINE);
+        g_system_state.pressure_setpoint_pct = PRESSURE_FINE;
+    }
+}
+
+static void plant_sim_task(void *pvParameters)
+{
+    float true_weight = 0.0f;
+    int64_t state_entered_us = esp_timer_get_time();
+    system_state_enum_t last_state = g_system_state.state;
+    const float dt = (CONTROL_LOOP_INTERVAL_MS / 1000.0f) * s_time_scale;
+
+    while (1) {
+        PROF_TICK_BEGIN();
+
+        int64_t now_us = esp_timer_get_time();
+        if (g_system_state.state != last_state) {
+            last_state = g_system_state.state;
+            state_entered_us = now_us;
+        }
+        uint32_t in_state_ms = (uint32_t)((now_us - state_entered_us) / 1000 * s_time_scale);
+
+        if (estop_active() && g_system_state.state != STATE_ERROR) {
+            g_system_state.pressure_setpoint_pct = 0.0f;
+            state_set_error(ERROR_ESTOP);
+            state_set_system(STATE_ERROR);
+        }
+
+        switch (g_system_state.state) {
+            case STATE_IDLE:
+                g_system_state.pressure_setpoint_pct = 0.0f;
+                state_set_zone(ZONE_IDLE);
+                if (s_auto_cycle && in_state_ms > SIM_IDLE_HOLD_MS) {
+                    state_set_system(STATE_SAFETY_CHECK);
+                }
+                break;
+
+            case STATE_SAFETY_CHECK:
+                // Operator confirms all checks
+                if (in_state_ms > SIM_SAFETY_HOLD_MS) {
+                    true_weight = 0.0f;
+                    g_system_state.zone_transitions = 0;
+                    g_system_state.fill_start_time_ms = now_us / 1000;
+                    state_set_system(STATE_FILLING);
+                }
+                break;
+
+            case STATE_FILLING: {
+                PROF_MARK(PROF_STAGE_SAMPLE);
+                float pct = (true_weight / g_system_state.target_weight_lbs) * 100.0f;
+                PROF_MARK(PROF_STAGE_ESTIMATE);
+                if (pct >= ZONE_FINE_END) {
+                    g_system_state.pressure_setpoint_pct = 0.0f;
+                    g_system_state.cutoff_weight_lbs = true_weight;
+                    state_set_system(STATE_COMPLETED);
+                    break;
+                }
+                fill_zone_t prev_zone = g_system_state.active_zone;
+                select_zone(pct);
+                if (prev_zone != g_system_state.active_zone) {
+                    g_system_state.zone_transitions++;
+                }
+                PROF_MARK(PROF_STAGE_ZONE);
+                true_weight += flow_for_pressure(g_system_state.pressure_setpoint_pct) * dt;
+                g_system_state.fill_elapsed_ms = now_us / 1000 - g_system_state.fill_start_time_ms;
+                break;
+            }
+
+            case STATE_COMPLETED:
+                // Settle: no hose spill in the model, so the weight is stable at once
+                if (in_state_ms > SIM_COMPLETE_HOLD_MS) {
+                    g_system_state.actual_dispensed_lbs = true_weight;
+                    g_system_state.spill_lbs = true_weight - g_system_state.cutoff_weight_lbs;
+                    g_system_state.settle_time_ms = in_state_ms;
+                    g_system_state.settle_stable = true;
+                    g_system_state.fill_number++;
+                    g_system_state.fills_today++;
+                    g_system_state.total_lbs_today += true_weight;
+                    true_weight = 0.0f;
+                    state_set_system(STATE_IDLE);
+                }
+                break;
+
+            case STATE_ERROR:
+                // A latched e-stop holds the error until /api/estop/reset
+                g_system_state.pressure_setpoint_pct = 0.0f;
+                if (!estop_active()) {
+                    state_set_system(STATE_IDLE);
+                }
+                break;
+
+            case STATE_CANCELLED:
+            default:
+                g_system_state.pressure_setpoint_pct = 0.0f;
+                state_set_system(STATE_IDLE);
+                break;
+        }
+
+        g_system_state.current_weight_lbs = true_weight + scale_noise();
+        g_system_state.uptime_seconds = now_us / 1000000;
+
+        PROF_TICK_END();
+
+        vTaskDelay(pdMS_TO_TICKS(CONTROL_LOOP_INTERVAL_MS));
+    }
+}
+
+/* The host is always "connected" with a fixed link (wifi_manager.c needs esp_wifi) */
+void wifi_manager_get_stats(wifi_manager_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->connected = true;
+    stats->rssi_dbm = -55;
+    stats->channel = 6;
+}
+
+/* The host never enters idle mode (power_manager.c needs esp_pm) */
+void power_manager_activity(power_wake_source_t source)
+{
+    (void)source;
+}
+
+void power_manager_get_stats(power_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* The simulated plant has no deadline supervision (deadline_monitor.c needs gptimer) */
+void deadline_get_stats(deadline_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+const char *deadline_task_name(deadline_task_t task)
+{
+    return (task == DEADLINE_TASK_CONTROL) ? "control" : "scale";
+}
+
+/* API fills skip the encoder confirmations, so no presses are counted */
+void safety_get_stats(safety_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* Checklist kept in memory (safety_system.c needs NVS and the button ISR) */
+static safety_checklist_t s_checklist = {
+    .version = SAFETY_CHECKLIST_VERSION,
+    .count = 4,
+    .steps = {
+        {"Air line OK?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Fill hose OK?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Tank position?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_DRUM, 0, SAFETY_CHECK_TIMEOUT_MS},
+        {"Ready to fill?", SAFETY_CONFIRM_BUTTON, SAFETY_SCOPE_BATCH, 0, SAFETY_CHECK_TIMEOUT_MS},
+    },
+};
+
+void safety_get_checklist(safety_checklist_t *checklist)
+{
+    *checklist = s_checklist;
+}
+
+esp_err_t safety_set_checklist(const safety_checklist_t *checklist)
+{
+    if (checklist->count == 0 || checklist->count > SAFETY_MAX_STEPS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_checklist = *checklist;
+    return ESP_OK;
+}
+
+bool safety_ready(void)
+{
+    return true;
+}
+
+const char *safety_confirm_name(safety_confirm_t confirm)
+{
+    return (confirm == SAFETY_CONFIRM_BUTTON) ? "button" : "itv";
+}
+
+const char *safety_scope_name(safety_scope_t scope)
+{
+    return (scope == SAFETY_SCOPE_DRUM) ? "drum" : "batch";
+}
+
+/* No LCD on the host */
+void display_get_stats(display_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* E-stop latch without the input pin or DAC (estop.c needs the GPIO ISR) */
+static estop_stats_t s_estop = {0};
+
+void estop_trigger(estop_source_t source)
+{
+    s_estop.trips[source]++;
+    if (!s_estop.latched) {
+        s_estop.source = source;
+    }
+    s_estop.latched = true;
+}
+
+bool estop_active(void)
+{
+    return s_estop.latched;
+}
+
+esp_err_t estop_reset(void)
+{
+    s_estop.latched = false;
+    return ESP_OK;
+}
+
+esp_err_t estop_self_test(void)
+{
+    return (g_system_state.state == STATE_IDLE) ? ESP_ERR_NOT_SUPPORTED : ESP_ERR_INVALID_STATE;
+}
+
+void estop_get_stats(estop_stats_t *stats)
+{
+    *stats = s_estop;
+}
+
+const char *estop_source_name(estop_source_t source)
+{
+    static const char *const names[ESTOP_SOURCE_COUNT] = {"input", "api", "mqtt"};
+    return (source < ESTOP_SOURCE_COUNT) ? names[source] : "unknown";
+}
+
+/* The simulated plant has no ITV feedback switch (pressure_controller.c needs the DAC) */
+void pressure_controller_get_itv_stats(itv_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* Batch mode needs real drums on the scale; the simulated plant refuses jobs */
+esp_err_t batch_start(uint16_t drums, float target_lbs)
+{
+    (void)drums;
+    (void)target_lbs;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void batch_stop(void)
+{
+}
+
+bool batch_active(void)
+{
+    return false;
+}
+
+void batch_get_status(batch_status_t *status)
+{
+    memset(status, 0, sizeof(*status));
+}
+
+const char *batch_phase_to_string(batch_phase_t phase)
+{
+    return (phase == BATCH_OFF) ? "OFF" : "UNKNOWN";
+}
+
+void plant_sim_start(bool auto_cycle, float time_scale)
+{
+    s_auto_cycle = auto_cycle;
+    s_time_scale = (time_scale > 0.0f) ? time_scale : 1.0f;
+    g_system_events = xEventGroupCreate();
+    flightrec_init();
+
+    // The simulated plant stands in for the whole control-critical path
+    startup_stage_done(EVENT_SCALE_READY, ESP_OK);
+    startup_stage_done(EVENT_CONTROL_READY, ESP_OK);
+    startup_stage_done(EVENT_DISPLAY_READY, ESP_OK);
+
+    xTaskCreate(plant_sim_task, "plant_sim", 4096, NULL, 5, NULL);
+}
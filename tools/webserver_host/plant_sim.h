@@ -0,0 +1,18 @@
+/**
+ * @file plant_sim.h
+ * @brief Fill plant simulator driving g_system_state (host build only)
+ */
+
+#ifndef PLANT_SIM_H
+#define PLANT_SIM_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Start the simulator task
+ * @param auto_cycle Start a new fill automatically whenever idle
+ * @param time_scale Simulated seconds per wall-clock second (1.0 = real time)
+ */
+void plant_sim_start(bool auto_cycle, float time_scale);
+
+#endif // PLANT_SIM_H
@@ -0,0 +1,12 @@
+/**
+ * @file esp_attr.h
+ * @brief Host shim of ESP-IDF section attributes (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_ATTR_H
+#define HOST_SHIM_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif // HOST_SHIM_ESP_ATTR_H
@@ -0,0 +1,22 @@
+/**
+ * @file esp_cpu.h
+ * @brief Host shim of the CPU cycle counter (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_CPU_H
+#define HOST_SHIM_ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Pseudo cycle counter: nanoseconds (see esp_rom_get_cpu_ticks_per_us)
+ */
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+#endif // HOST_SHIM_ESP_CPU_H
@@ -0,0 +1,34 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief Host shim of heap capability queries (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_HEAP_CAPS_H
+#define HOST_SHIM_ESP_HEAP_CAPS_H
+
+#include <malloc.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+/* glibc arena statistics stand in for the ESP32 internal heap */
+static inline size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    return mallinfo2().fordblks;
+}
+
+static inline size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    (void)caps;
+    return mallinfo2().fordblks;
+}
+
+#endif // HOST_SHIM_ESP_HEAP_CAPS_H
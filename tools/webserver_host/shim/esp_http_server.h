@@ -0,0 +1,96 @@
+/**
+ * @file esp_http_server.h
+ * @brief Host shim of the esp_http_server API (webserver host build only)
+ *
+ * Implements the subset of the ESP-IDF HTTP server used by webserver.c on
+ * top of POSIX sockets. Like httpd, a single server thread accepts and
+ * parses requests; handlers that call httpd_req_async_handler_begin() keep
+ * the socket open until httpd_req_async_handler_complete(). Responses are
+ * sent with Connection: close (no keep-alive).
+ */
+
+#ifndef HOST_SHIM_ESP_HTTP_SERVER_H
+#define HOST_SHIM_ESP_HTTP_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+typedef void *httpd_handle_t;
+
+typedef enum {
+    HTTP_GET = 1,
+    HTTP_POST = 3,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_405_METHOD_NOT_ALLOWED,
+    HTTPD_408_REQ_TIMEOUT,
+    HTTPD_500_INTERNAL_SERVER_ERROR,
+} httpd_err_code_t;
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+#define HTTPD_SOCK_ERR_FAIL     -1
+#define HTTPD_SOCK_ERR_INVALID  -2
+#define HTTPD_SOCK_ERR_TIMEOUT  -3
+
+#define HTTPD_MAX_URI_LEN 512
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    const char uri[HTTPD_MAX_URI_LEN + 1];
+    size_t content_len;
+    void *aux;
+    void *user_ctx;
+    void *sess_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *r);
+    void *user_ctx;
+} httpd_uri_t;
+
+typedef struct httpd_config {
+    uint16_t server_port;
+    uint16_t max_open_sockets;
+    uint16_t max_uri_handlers;
+    uint16_t recv_wait_timeout;
+    uint16_t send_wait_timeout;
+    bool lru_purge_enable;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {        \
+        .server_port = 80,              \
+        .max_open_sockets = 7,          \
+        .max_uri_handlers = 8,          \
+        .recv_wait_timeout = 5,         \
+        .send_wait_timeout = 5,         \
+        .lru_purge_enable = false,      \
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler);
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg);
+
+#endif // HOST_SHIM_ESP_HTTP_SERVER_H
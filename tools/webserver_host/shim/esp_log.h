@@ -0,0 +1,17 @@
+/**
+ * @file esp_log.h
+ * @brief Host shim of ESP-IDF logging (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_LOG_H
+#define HOST_SHIM_ESP_LOG_H
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) fprintf(stderr, "I (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { } while (0)
+
+#endif // HOST_SHIM_ESP_LOG_H
@@ -0,0 +1,47 @@
+/**
+ * @file esp_partition.h
+ * @brief Host shim of the partition API (webserver host build only)
+ *
+ * The host build has no flash; no partition is ever found.
+ */
+
+#ifndef HOST_SHIM_ESP_PARTITION_H
+#define HOST_SHIM_ESP_PARTITION_H
+
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct esp_partition esp_partition_t;
+
+#define ESP_PARTITION_TYPE_DATA 0x01
+#define ESP_PARTITION_SUBTYPE_ANY 0xff
+
+static inline const esp_partition_t *esp_partition_find_first(int type, int subtype,
+                                                              const char *label)
+{
+    (void)type; (void)subtype; (void)label;
+    return NULL;
+}
+
+static inline esp_err_t esp_partition_read(const esp_partition_t *p, size_t offset,
+                                           void *dst, size_t size)
+{
+    (void)p; (void)offset; (void)dst; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_partition_write(const esp_partition_t *p, size_t offset,
+                                            const void *src, size_t size)
+{
+    (void)p; (void)offset; (void)src; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset,
+                                                  size_t size)
+{
+    (void)p; (void)offset; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // HOST_SHIM_ESP_PARTITION_H
@@ -0,0 +1,17 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief Host shim of ROM system helpers (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_ROM_SYS_H
+#define HOST_SHIM_ESP_ROM_SYS_H
+
+#include <stdint.h>
+
+/* The host cycle counter ticks in nanoseconds */
+static inline uint32_t esp_rom_get_cpu_ticks_per_us(void)
+{
+    return 1000;
+}
+
+#endif // HOST_SHIM_ESP_ROM_SYS_H
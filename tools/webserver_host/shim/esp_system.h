@@ -0,0 +1,26 @@
+/**
+ * @file esp_system.h
+ * @brief Host shim of esp_reset_reason() (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_SYSTEM_H
+#define HOST_SHIM_ESP_SYSTEM_H
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+} esp_reset_reason_t;
+
+/* Every host run is a cold start */
+static inline esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+#endif // HOST_SHIM_ESP_SYSTEM_H
@@ -0,0 +1,16 @@
+/**
+ * @file esp_timer.h
+ * @brief Host shim of esp_timer (webserver host build only)
+ */
+
+#ifndef HOST_SHIM_ESP_TIMER_H
+#define HOST_SHIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Microseconds since process start (CLOCK_MONOTONIC)
+ */
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_SHIM_ESP_TIMER_H
@@ -0,0 +1,58 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host shim of the FreeRTOS subset used by the webserver component
+ *
+ * Tasks map to pthreads, queues to a mutex/condvar ring buffer.
+ * One tick is one millisecond.
+ */
+
+#ifndef HOST_SHIM_FREERTOS_H
+#define HOST_SHIM_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct host_task *TaskHandle_t;
+typedef struct host_queue *QueueHandle_t;
+typedef struct host_event_group *EventGroupHandle_t;
+
+/* Static allocation: the buffers are accepted but the shim allocates on the heap */
+typedef uint8_t StackType_t;
+typedef struct { int unused; } StaticTask_t;
+typedef struct { int unused; } StaticQueue_t;
+typedef struct { int unused; } StaticEventGroup_t;
+
+#define pdTRUE  ((BaseType_t)1)
+#define pdFALSE ((BaseType_t)0)
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define portNUM_PROCESSORS 1
+
+/* Critical sections map to one process-wide mutex (must not nest) */
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void host_enter_critical(void);
+void host_exit_critical(void);
+
+#define portENTER_CRITICAL(mux) do { (void)(mux); host_enter_critical(); } while (0)
+#define portEXIT_CRITICAL(mux)  do { (void)(mux); host_exit_critical(); } while (0)
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)  portEXIT_CRITICAL(mux)
+
+#endif // HOST_SHIM_FREERTOS_H
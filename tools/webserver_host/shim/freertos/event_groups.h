@@ -0,0 +1,19 @@
+/**
+ * @file event_groups.h
+ * @brief Host shim of FreeRTOS event group API
+ */
+
+#ifndef HOST_SHIM_FREERTOS_EVENT_GROUPS_H
+#define HOST_SHIM_FREERTOS_EVENT_GROUPS_H
+
+#include "freertos/FreeRTOS.h"
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *group_buf);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait);
+
+#endif // HOST_SHIM_FREERTOS_EVENT_GROUPS_H
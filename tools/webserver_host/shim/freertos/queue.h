@@ -0,0 +1,19 @@
+/**
+ * @file queue.h
+ * @brief Host shim of FreeRTOS queue API
+ */
+
+#ifndef HOST_SHIM_FREERTOS_QUEUE_H
+#define HOST_SHIM_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage,
+                                 StaticQueue_t *queue_buf);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+
+#endif // HOST_SHIM_FREERTOS_QUEUE_H
@@ -0,0 +1,55 @@
+/**
+ * @file task.h
+ * @brief Host shim of FreeRTOS task API
+ */
+
+#ifndef HOST_SHIM_FREERTOS_TASK_H
+#define HOST_SHIM_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#define tskNO_AFFINITY ((BaseType_t)0x7FFFFFFF)
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+/* Run-time counter is the thread's CPU time in microseconds */
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    uint8_t *pxStackBase;
+    uint32_t usStackHighWaterMark;    // Host threads report their full stack size
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *param, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *handle);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                           void *param, UBaseType_t priority, StackType_t *stack,
+                                           StaticTask_t *tcb, BaseType_t core_id);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                               void *param, UBaseType_t priority, StackType_t *stack,
+                               StaticTask_t *tcb);
+void vTaskDelete(TaskHandle_t handle);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t handle);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, UBaseType_t max, uint32_t *total_runtime);
+
+#endif // HOST_SHIM_FREERTOS_TASK_H